@@ -0,0 +1,94 @@
+/**
+ * @file bench_integer_costs.cpp
+ * @brief Open-list comparison on long queries
+ *
+ * Runs a seeded set of long cross-map queries through GraphPlanner with the
+ * comparison-based open lists (sorted vector, binary heap) on float costs,
+ * and with the binary heap and radix heap on integer costs.
+ */
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+#include "../src/route_model.h"
+#include "../src/route_graph.h"
+#include "../src/graph_planner.h"
+
+static std::optional<std::vector<std::byte>> ReadFile(const std::string &path)
+{
+    std::ifstream is{path, std::ios::binary | std::ios::ate};
+    if( !is )
+        return std::nullopt;
+
+    auto size = is.tellg();
+    std::vector<std::byte> contents(size);
+
+    is.seekg(0);
+    is.read((char*)contents.data(), size);
+
+    if( contents.empty() )
+        return std::nullopt;
+    return std::move(contents);
+}
+
+template <typename Planner>
+static void Run(const char *name, const RouteGraph &graph, const std::vector<std::pair<int, int>> &queries, int repetitions)
+{
+    Planner planner{graph};
+    double total_distance = 0.;
+    std::size_t expansions = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for( int r = 0; r < repetitions; ++r )
+        for( auto [source, target]: queries ) {
+            total_distance += planner.Search(source, target).distance;
+            expansions += planner.Expansions();
+        }
+    auto end = std::chrono::steady_clock::now();
+    const auto runs = static_cast<double>(queries.size()) * repetitions;
+    std::cout << std::left << std::setw(32) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << std::chrono::duration<double, std::micro>(end - begin).count() / runs << " us"
+              << std::setw(10) << expansions / runs << " expansions"
+              << std::setw(12) << total_distance / runs << " m avg" << std::endl;
+}
+
+int main(int argc, const char **argv)
+{
+    std::string osm_data_file = "../map.osm";
+    int num_queries = 100;
+    int repetitions = 20;
+    for( int i = 1; i < argc; ++i ) {
+        if( std::string_view{argv[i]} == "-f" && ++i < argc )
+            osm_data_file = argv[i];
+        else if( std::string_view{argv[i]} == "-n" && ++i < argc )
+            num_queries = std::stoi(argv[i]);
+        else if( std::string_view{argv[i]} == "-r" && ++i < argc )
+            repetitions = std::stoi(argv[i]);
+    }
+
+    auto data = ReadFile(osm_data_file);
+    if( !data ) {
+        std::cout << "Failed to read " << osm_data_file << std::endl;
+        return 1;
+    }
+    Model model{*data};
+    const auto graph = RouteGraph::Build(model);
+
+    // Long queries: from one corner region of the map to the opposite one.
+    std::mt19937 rng{42};
+    std::uniform_real_distribution<float> low{0.f, 0.2f}, high{0.8f, 1.f};
+    std::vector<std::pair<int, int>> queries;
+    for( int i = 0; i < num_queries; ++i )
+        queries.emplace_back(graph.ClosestNode(low(rng), low(rng)), graph.ClosestNode(high(rng), high(rng)));
+
+    std::cout << num_queries << " long queries x " << repetitions << " repetitions, per query:" << std::endl;
+    Run<BasicGraphPlanner<EuclideanDistance, SortedVectorQueue>>("float / sorted vector", graph, queries, repetitions);
+    Run<BasicGraphPlanner<EuclideanDistance, BinaryHeapQueue>>("float / binary heap", graph, queries, repetitions);
+    Run<BasicGraphPlanner<EuclideanDistance, BinaryHeapQueue, StopAtGoal, IntegerCosts>>("integer / binary heap", graph, queries, repetitions);
+    Run<RadixGraphPlanner>("integer / radix heap", graph, queries, repetitions);
+    return 0;
+}
@@ -0,0 +1,245 @@
+/**
+ * @file bench_node_layout.cpp
+ * @brief Before/after benchmark of the routing node layout
+ *
+ * Runs the same seeded set of origin-destination queries through two A*
+ * searches that differ only in how nodes are stored, and reports latency,
+ * instructions and cache misses per query:
+ *
+ * - AoS: one record per node laid out like RouteModel::Node (double
+ *   coordinates, parent pointer, g/h values, visited flag and a heap-allocated
+ *   neighbor list per node).
+ * - SoA: GraphPlanner over RouteGraph's CSR arrays and SearchSpace.
+ *
+ * Both use BinaryHeapQueue, stop when the goal is expanded, take the edge
+ * weights from the same RouteGraph and start from endpoints snapped with
+ * RouteGraph::ClosestNode() before the timed region. What still differs is
+ * inherent to the layouts: the AoS search resets its nodes with a pass over
+ * the visited ones, where SearchSpace bumps a generation counter, and it
+ * stores h per node instead of recomputing it. RoutePlanner itself isn't
+ * timed; its lazy FindNeighbors() and mark-on-push search are different
+ * algorithms, not a different layout.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+#include "perf_counters.h"
+#include "../src/route_model.h"
+#include "../src/route_graph.h"
+#include "../src/graph_planner.h"
+
+static std::optional<std::vector<std::byte>> ReadFile(const std::string &path)
+{
+    std::ifstream is{path, std::ios::binary | std::ios::ate};
+    if( !is )
+        return std::nullopt;
+
+    auto size = is.tellg();
+    std::vector<std::byte> contents(size);
+
+    is.seekg(0);
+    is.read((char*)contents.data(), size);
+
+    if( contents.empty() )
+        return std::nullopt;
+    return std::move(contents);
+}
+
+struct Query { int source, target; };
+
+/**
+ * @class AosPlanner
+ * @brief GraphPlanner's search over array-of-structs node records
+ */
+class AosPlanner {
+  public:
+    explicit AosPlanner(const RouteGraph &graph) : m_Nodes(graph.NumNodes()) {
+        for( int v = 0; v < graph.NumNodes(); ++v ) {
+            auto &node = m_Nodes[v];
+            node.x = graph.X(v);
+            node.y = graph.Y(v);
+            for( auto e = graph.FirstOut(v); e < graph.FirstOut(v + 1); ++e )
+                node.neighbors.push_back({&m_Nodes[graph.Head(e)], graph.Weight(e)});
+        }
+    }
+
+    /**
+     * @brief Returns the path length in normalized units, or -1 if the target is unreachable
+     */
+    float Search(int source, int target) {
+        for( auto *node: m_Touched )
+            *node = Node::Reset(*node);
+        m_Touched.clear();
+        m_Open.clear();
+
+        Node *goal = &m_Nodes[target];
+        Node *start = &m_Nodes[source];
+        Reach(start, 0.f, nullptr, goal);
+        while( !m_Open.empty() ) {
+            Node *v = m_Open.pop().second;
+            if( v->settled )
+                continue;
+            v->settled = true;
+            if( v == goal )
+                return v->g_value;
+            for( const auto &[w, weight]: v->neighbors ) {
+                if( w->settled )
+                    continue;
+                const float g = v->g_value + weight;
+                if( !w->reached || g < w->g_value )
+                    Reach(w, g, v, goal);
+            }
+        }
+        return -1.f;
+    }
+
+  private:
+    struct Node;
+    struct Arc {
+        Node *head;    ///< Neighbor node
+        float weight;  ///< Edge weight in normalized units
+    };
+    struct Node {
+        double x = 0.;              ///< Normalized x-coordinate, as in Model::Node
+        double y = 0.;              ///< Normalized y-coordinate
+        Node *parent = nullptr;     ///< Predecessor on the best known path
+        float h_value = 0.f;        ///< Heuristic distance to the goal
+        float g_value = 0.f;        ///< Tentative distance from the source
+        bool reached = false;       ///< g_value is valid in this query
+        bool settled = false;       ///< g_value is final
+        std::vector<Arc> neighbors; ///< Outgoing edges
+
+        static Node Reset(Node &node) {
+            Node reset;
+            reset.x = node.x;
+            reset.y = node.y;
+            reset.neighbors = std::move(node.neighbors);
+            return reset;
+        }
+    };
+
+    void Reach(Node *w, float g, Node *parent, const Node *goal) {
+        if( !w->reached ) {
+            w->h_value = m_Heuristic(w->x, w->y, goal->x, goal->y);
+            m_Touched.push_back(w);
+        }
+        w->reached = true;
+        w->g_value = g;
+        w->parent = parent;
+        m_Open.push(w, g + w->h_value);
+    }
+
+    struct Heuristic {
+        float operator()(double x1, double y1, double x2, double y2) const {
+            return std::sqrt(std::pow((x1 - x2), 2) + std::pow((y1 - y2), 2));
+        }
+    } m_Heuristic;                           ///< Same metric as EuclideanDistance
+    std::vector<Node> m_Nodes;               ///< Node records, indexed by graph node id
+    std::vector<Node *> m_Touched;           ///< Nodes reached by the last query
+    BinaryHeapQueue<Node *, float> m_Open;   ///< Open list keyed by f = g + h
+};
+
+struct Totals {
+    double nanoseconds = 0.;
+    std::uint64_t events[PerfCounters::NumEvents] = {0, 0, 0};
+};
+
+template <typename F>
+static void Measure(PerfCounters &counters, Totals &totals, F &&query)
+{
+    counters.Start();
+    auto begin = std::chrono::steady_clock::now();
+    query();
+    auto end = std::chrono::steady_clock::now();
+    counters.Stop();
+    totals.nanoseconds += std::chrono::duration<double, std::nano>(end - begin).count();
+    for( int i = 0; i < PerfCounters::NumEvents; ++i )
+        totals.events[i] += counters.Value(static_cast<PerfCounters::Event>(i));
+}
+
+static void Report(const char *name, const Totals &totals, int queries, const PerfCounters &counters)
+{
+    auto per_query = [&](double v) { return v / queries; };
+    std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << per_query(totals.nanoseconds) / 1000. << " us";
+    const char *labels[PerfCounters::NumEvents] = {"instr", "cache refs", "cache misses"};
+    for( int i = 0; i < PerfCounters::NumEvents; ++i ) {
+        std::cout << std::setw(14);
+        if( counters.Available(static_cast<PerfCounters::Event>(i)) )
+            std::cout << per_query(static_cast<double>(totals.events[i]));
+        else
+            std::cout << "n/a";
+        std::cout << ' ' << labels[i];
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, const char **argv)
+{
+    std::string osm_data_file = "../map.osm";
+    int num_queries = 200;
+    for( int i = 1; i < argc; ++i ) {
+        if( std::string_view{argv[i]} == "-f" && ++i < argc )
+            osm_data_file = argv[i];
+        else if( std::string_view{argv[i]} == "-n" && ++i < argc )
+            num_queries = std::stoi(argv[i]);
+    }
+
+    auto data = ReadFile(osm_data_file);
+    if( !data ) {
+        std::cout << "Failed to read " << osm_data_file << std::endl;
+        return 1;
+    }
+    RouteModel model{*data};
+    const auto graph = RouteGraph::Build(model);
+
+    // Snap once up front; only the searches are timed.
+    std::mt19937 rng{42};
+    std::uniform_real_distribution<float> coordinate{0.f, 1.f};
+    std::vector<Query> queries(num_queries);
+    for( auto &q: queries ) {
+        q.source = graph.ClosestNode(coordinate(rng), coordinate(rng));
+        q.target = graph.ClosestNode(coordinate(rng), coordinate(rng));
+    }
+
+    PerfCounters counters;
+    if( !counters.Available() )
+        std::cout << "Hardware counters unavailable, reporting latency only." << std::endl;
+
+    Totals before, after;
+    AosPlanner aos{graph};
+    std::vector<float> aos_lengths(num_queries);
+    for( int i = 0; i < num_queries; ++i )
+        Measure(counters, before, [&]{ aos_lengths[i] = aos.Search(queries[i].source, queries[i].target); });
+
+    GraphPlanner planner{graph};
+    std::vector<GraphPath> paths(num_queries);
+    for( int i = 0; i < num_queries; ++i )
+        Measure(counters, after, [&]{ paths[i] = planner.Search(queries[i].source, queries[i].target); });
+
+    // Both searches must agree, or the comparison is meaningless.
+    int mismatches = 0;
+    for( int i = 0; i < num_queries; ++i ) {
+        const float aos_meters = aos_lengths[i] < 0.f ? -1.f : aos_lengths[i] * static_cast<float>(graph.MetricScale());
+        const float soa_meters = paths[i].found ? paths[i].distance : -1.f;
+        if( std::abs(aos_meters - soa_meters) > 1e-3f * std::max(1.f, std::abs(soa_meters)) )
+            ++mismatches;
+    }
+
+    std::cout << num_queries << " queries, " << graph.NumNodes() << " routable nodes, per query:" << std::endl;
+    Report("Graph search (AoS)", before, num_queries, counters);
+    Report("GraphPlanner (SoA)", after, num_queries, counters);
+    if( mismatches ) {
+        std::cout << mismatches << " queries gave different distances." << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,211 @@
+/**
+ * @file bench_routing.cpp
+ * @brief Google Benchmark suite for end-to-end routing queries
+ *
+ * Loads the map once, then measures snapping, short / medium / long queries
+ * from a fixed seeded set of origin-destination pairs, and path
+ * reconstruction. Unless --benchmark_out is given, results are also written
+ * as JSON to benchmark.json so runs can be compared across commits, e.g.
+ * with Google Benchmark's tools/compare.py.
+ *
+ * Usage: benchmark [-f map.osm] [--benchmark_* options]
+ */
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../src/route_model.h"
+#include "../src/route_planner.h"
+#include "../src/route_graph.h"
+#include "../src/graph_planner.h"
+#include "../src/segment_index.h"
+
+static std::optional<std::vector<std::byte>> ReadFile(const std::string &path)
+{
+    std::ifstream is{path, std::ios::binary | std::ios::ate};
+    if( !is )
+        return std::nullopt;
+
+    auto size = is.tellg();
+    std::vector<std::byte> contents(size);
+
+    is.seekg(0);
+    is.read((char*)contents.data(), size);
+
+    if( contents.empty() )
+        return std::nullopt;
+    return std::move(contents);
+}
+
+enum class Range { Short, Medium, Long };
+
+// Everything loaded once and shared by all benchmarks.
+struct Fixture {
+    explicit Fixture(const std::vector<std::byte> &data) : model{data}, graph{RouteGraph::Build(model)}, index{graph} {}
+
+    RouteModel model;
+    RouteGraph graph;
+    SegmentIndex index;
+    std::vector<std::pair<float, float>> points;        // Seeded snapping positions
+    std::vector<std::pair<int, int>> pairs[3];           // Connected OD pairs per Range
+};
+
+static void BuildQueries(Fixture &f, int per_range)
+{
+    std::mt19937 rng{42};
+    std::uniform_real_distribution<float> coordinate{0.f, 1.f};
+    for( int i = 0; i < 256; ++i )
+        f.points.emplace_back(coordinate(rng), coordinate(rng));
+
+    // Classify seeded pairs by straight-line distance; keep only connected ones.
+    GraphPlanner planner{f.graph};
+    std::uniform_int_distribution<int> node{0, f.graph.NumNodes() - 1};
+    for( int attempts = 0; attempts < 100000; ++attempts ) {
+        const int s = node(rng), t = node(rng);
+        const float d = std::hypot(f.graph.X(s) - f.graph.X(t), f.graph.Y(s) - f.graph.Y(t));
+        const auto range = d < 0.25f ? Range::Short : d < 0.6f ? Range::Medium : Range::Long;
+        auto &bucket = f.pairs[static_cast<int>(range)];
+        if( static_cast<int>(bucket.size()) < per_range && planner.Search(s, t).found )
+            bucket.emplace_back(s, t);
+        if( f.pairs[0].size() + f.pairs[1].size() + f.pairs[2].size() == 3u * per_range )
+            break;
+    }
+}
+
+static void BM_SnapClosestNode(benchmark::State &state, Fixture &f)
+{
+    std::size_t i = 0;
+    for( auto _: state ) {
+        const auto &p = f.points[i++ % f.points.size()];
+        benchmark::DoNotOptimize(&f.model.FindClosestNode(p.first, p.second));
+    }
+}
+
+static void BM_SnapGraphNode(benchmark::State &state, Fixture &f)
+{
+    std::size_t i = 0;
+    for( auto _: state ) {
+        const auto &p = f.points[i++ % f.points.size()];
+        benchmark::DoNotOptimize(f.graph.ClosestNode(p.first, p.second));
+    }
+}
+
+static void BM_SnapSegment(benchmark::State &state, Fixture &f)
+{
+    std::size_t i = 0;
+    for( auto _: state ) {
+        const auto &p = f.points[i++ % f.points.size()];
+        benchmark::DoNotOptimize(f.index.Snap(p.first, p.second));
+    }
+}
+
+static void BM_RoutePlanner(benchmark::State &state, Fixture &f, Range range)
+{
+    const auto &pairs = f.pairs[static_cast<int>(range)];
+    RoutePlanner::Context context{f.model};
+    std::size_t i = 0;
+    for( auto _: state ) {
+        state.PauseTiming();
+        f.model.ResetSearch();
+        const auto [s, t] = pairs[i++ % pairs.size()];
+        state.ResumeTiming();
+        RoutePlanner planner{f.model, context, f.graph.X(s) * 100.f, f.graph.Y(s) * 100.f, f.graph.X(t) * 100.f, f.graph.Y(t) * 100.f};
+        planner.AStarSearch();
+        benchmark::DoNotOptimize(planner.GetDistance());
+    }
+    f.model.ResetSearch();
+}
+
+template <typename Planner>
+static void BM_GraphPlanner(benchmark::State &state, Fixture &f, Range range)
+{
+    const auto &pairs = f.pairs[static_cast<int>(range)];
+    Planner planner{f.graph};
+    std::size_t i = 0, expansions = 0;
+    for( auto _: state ) {
+        const auto [s, t] = pairs[i++ % pairs.size()];
+        benchmark::DoNotOptimize(planner.Search(s, t));
+        expansions += planner.Expansions();
+    }
+    state.counters["expansions"] = benchmark::Counter(static_cast<double>(expansions), benchmark::Counter::kAvgIterations);
+}
+
+static void BM_ConstructFinalPath(benchmark::State &state, Fixture &f)
+{
+    // Search once, then rebuild the path from the parent pointers repeatedly,
+    // into a reused buffer like AStarSearch() does.
+    f.model.ResetSearch();
+    const auto [s, t] = f.pairs[static_cast<int>(Range::Long)].front();
+    const float sx = f.graph.X(s) * 100.f, sy = f.graph.Y(s) * 100.f;
+    const float tx = f.graph.X(t) * 100.f, ty = f.graph.Y(t) * 100.f;
+    RoutePlanner planner{f.model, sx, sy, tx, ty};
+    planner.AStarSearch();
+    if( f.model.path.empty() ) {
+        state.SkipWithError("RoutePlanner found no path for the reconstruction query");
+        return;
+    }
+    auto *end = &f.model.FindClosestNode(tx * 0.01f, ty * 0.01f);
+    std::vector<RouteModel::Node> path;
+    for( auto _: state ) {
+        planner.ConstructFinalPath(end, path);
+        benchmark::DoNotOptimize(path.data());
+        benchmark::ClobberMemory();
+    }
+    state.counters["nodes"] = static_cast<double>(path.size());
+    f.model.ResetSearch();
+}
+
+int main(int argc, char **argv)
+{
+    // Default to a JSON results file next to the console report.
+    std::vector<char *> args(argv, argv + argc);
+    std::string out_flag = "--benchmark_out=benchmark.json", format_flag = "--benchmark_out_format=json";
+    bool has_out = false;
+    for( int i = 1; i < argc; ++i )
+        has_out |= std::string_view{argv[i]}.rfind("--benchmark_out=", 0) == 0;
+    if( !has_out ) {
+        args.push_back(out_flag.data());
+        args.push_back(format_flag.data());
+    }
+    int args_count = static_cast<int>(args.size());
+    benchmark::Initialize(&args_count, args.data());
+
+    std::string osm_data_file = "../map.osm";
+    for( int i = 1; i < args_count; ++i )
+        if( std::string_view{args[i]} == "-f" && i + 1 < args_count )
+            osm_data_file = args[++i];
+
+    auto data = ReadFile(osm_data_file);
+    if( !data ) {
+        std::cerr << "Failed to read " << osm_data_file << std::endl;
+        return 1;
+    }
+    Fixture fixture{*data};
+    BuildQueries(fixture, 32);
+
+    benchmark::RegisterBenchmark("Snap/RouteModel::FindClosestNode", BM_SnapClosestNode, std::ref(fixture));
+    benchmark::RegisterBenchmark("Snap/RouteGraph::ClosestNode", BM_SnapGraphNode, std::ref(fixture));
+    benchmark::RegisterBenchmark("Snap/SegmentIndex::Snap", BM_SnapSegment, std::ref(fixture));
+    const std::pair<const char *, Range> ranges[] = {{"short", Range::Short}, {"medium", Range::Medium}, {"long", Range::Long}};
+    for( const auto &[name, range]: ranges ) {
+        if( fixture.pairs[static_cast<int>(range)].empty() )
+            continue;
+        const std::string suffix = std::string{"/"} + name;
+        benchmark::RegisterBenchmark(("Query/RoutePlanner" + suffix).c_str(), BM_RoutePlanner, std::ref(fixture), range);
+        benchmark::RegisterBenchmark(("Query/GraphPlanner" + suffix).c_str(), BM_GraphPlanner<GraphPlanner>, std::ref(fixture), range);
+        benchmark::RegisterBenchmark(("Query/RadixGraphPlanner" + suffix).c_str(), BM_GraphPlanner<RadixGraphPlanner>, std::ref(fixture), range);
+    }
+    if( !fixture.pairs[static_cast<int>(Range::Long)].empty() )
+        benchmark::RegisterBenchmark("Reconstruct/RoutePlanner::ConstructFinalPath", BM_ConstructFinalPath, std::ref(fixture));
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
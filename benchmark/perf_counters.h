@@ -0,0 +1,106 @@
+/**
+ * @file perf_counters.h
+ * @brief Minimal hardware performance counter reader for benchmarks
+ *
+ * Wraps the Linux perf_event_open interface to count retired instructions,
+ * cache references and cache misses around a region of code. On other
+ * platforms, or when the kernel denies access, the counters report as
+ * unavailable and callers fall back to wall-clock time.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @class PerfCounters
+ * @brief Counts instructions and cache misses of the calling thread
+ */
+class PerfCounters
+{
+public:
+    /**
+     * @enum Event
+     * @brief The hardware events that are counted
+     */
+    enum Event { Instructions, CacheReferences, CacheMisses, NumEvents };
+
+    PerfCounters() {
+#if defined(__linux__)
+        const std::uint64_t configs[NumEvents] = {PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES};
+        for( int i = 0; i < NumEvents; ++i ) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[i];
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            m_Fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+#endif
+    }
+
+    ~PerfCounters() {
+#if defined(__linux__)
+        for( auto fd: m_Fds )
+            if( fd >= 0 )
+                close(fd);
+#endif
+    }
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    /**
+     * @brief Returns true if the given event could be opened
+     */
+    bool Available(Event event = Instructions) const noexcept { return m_Fds[event] >= 0; }
+
+    /**
+     * @brief Resets and starts all available counters
+     */
+    void Start() noexcept {
+#if defined(__linux__)
+        for( auto fd: m_Fds )
+            if( fd >= 0 ) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+    }
+
+    /**
+     * @brief Stops all counters and latches their values
+     */
+    void Stop() noexcept {
+#if defined(__linux__)
+        for( int i = 0; i < NumEvents; ++i )
+            if( m_Fds[i] >= 0 ) {
+                ioctl(m_Fds[i], PERF_EVENT_IOC_DISABLE, 0);
+                std::uint64_t value = 0;
+                if( read(m_Fds[i], &value, sizeof(value)) == sizeof(value) )
+                    m_Values[i] = value;
+            }
+#endif
+    }
+
+    /**
+     * @brief Returns the value of an event latched by the last Stop()
+     */
+    std::uint64_t Value(Event event) const noexcept { return m_Values[event]; }
+
+private:
+    int m_Fds[NumEvents] = {-1, -1, -1};          ///< perf event file descriptors
+    std::uint64_t m_Values[NumEvents] = {0, 0, 0};///< Latched counter values
+};
@@ -0,0 +1,385 @@
+/**
+ * @file perf_budget.cpp
+ * @brief Performance-budget regression test
+ *
+ * Runs fixed workloads (model load, a seeded query set through RoutePlanner
+ * and GraphPlanner, and, when built with rendering, a fixed viewport render
+ * and a tiled render on one thread and on every hardware thread)
+ * and compares their metrics against the budgets file. Each budget is a
+ * baseline plus a tolerance; the test fails when a metric exceeds its
+ * baseline by more than the tolerance, and prints a table of every metric.
+ *
+ * Metrics and the tolerances --update gives new entries:
+ *  - work counts (nodes visited, expansions, path nodes, drawn features):
+ *    deterministic for a given map; 2% absorbs floating-point tie breaks
+ *    that differ between compilers.
+ *  - instructions (retired user-space instructions, when perf events are
+ *    available): stable on one build, so 10% catches real regressions.
+ *    Without counters these metrics are not measured and their budgets
+ *    are skipped.
+ *  - seconds (the fastest of several repetitions): depend on the host, so
+ *    their 200% band only catches gross slowdowns.
+ *
+ * Every entry with a baseline is checked. An entry whose tolerance reads
+ * "report" is shown next to its measurement but never fails the test.
+ *
+ * Usage: perf_budget [-f map.osm] [--budgets budgets.txt] [--update]
+ *
+ * --update rewrites the budgets file with the measured values, keeping the
+ * tolerances of existing entries and the entries that weren't measured.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <optional>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "../benchmark/perf_counters.h"
+#include "../src/route_model.h"
+#include "../src/route_planner.h"
+#include "../src/route_graph.h"
+#include "../src/graph_planner.h"
+#if defined(PERF_BUDGET_WITH_RENDER)
+#include "../src/render.h"
+#endif
+
+static std::optional<std::vector<std::byte>> ReadFile(const std::string &path)
+{
+    std::ifstream is{path, std::ios::binary | std::ios::ate};
+    if( !is )
+        return std::nullopt;
+
+    auto size = is.tellg();
+    std::vector<std::byte> contents(size);
+
+    is.seekg(0);
+    is.read((char*)contents.data(), size);
+
+    if( contents.empty() )
+        return std::nullopt;
+    return std::move(contents);
+}
+
+/**
+ * @struct Budget
+ * @brief A stored baseline and the allowed relative increase over it
+ */
+struct Budget {
+    double baseline;
+    double tolerance;  ///< Allowed relative increase; ignored if report_only
+    bool report_only;  ///< Shown for reference, never fails the test
+};
+
+using Metrics = std::map<std::string, double>;
+
+static bool EndsWith(const std::string &metric, std::string_view suffix)
+{
+    return metric.size() >= suffix.size() && metric.compare(metric.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Tolerance given to a metric that has no budget yet.
+static double DefaultTolerance(const std::string &metric)
+{
+    if( EndsWith(metric, ".seconds") )
+        return 2.;
+    if( EndsWith(metric, ".instructions") )
+        return 0.1;
+    return 0.02;
+}
+
+static std::map<std::string, Budget> ReadBudgets(const std::string &path)
+{
+    std::map<std::string, Budget> budgets;
+    std::ifstream is{path};
+    std::string line;
+    while( std::getline(is, line) ) {
+        if( line.empty() || line[0] == '#' )
+            continue;
+        std::istringstream fields{line};
+        std::string metric, tolerance;
+        Budget budget{0., 0., false};
+        if( fields >> metric >> budget.baseline >> tolerance && tolerance == "report" ) {
+            budget.report_only = true;
+            budgets[metric] = budget;
+        }
+        else if( !tolerance.empty() && tolerance.back() == '%' ) {
+            budget.tolerance = std::stod(tolerance) / 100.;
+            budgets[metric] = budget;
+        }
+        else
+            std::cerr << "Ignoring malformed budget line: " << line << std::endl;
+    }
+    return budgets;
+}
+
+static bool WriteBudgets(const std::string &path, const std::map<std::string, Budget> &old, const Metrics &metrics)
+{
+    std::ofstream os{path};
+    os << "# Performance budgets checked by perf_budget: metric, baseline, allowed increase.\n"
+          "# An allowed increase of \"report\" shows the metric without checking it.\n"
+          "# Regenerate with: perf_budget --update\n";
+    std::set<std::string> names;
+    for( const auto &entry: old )
+        names.insert(entry.first);
+    for( const auto &entry: metrics )
+        names.insert(entry.first);
+    for( const auto &metric: names ) {
+        auto measured = metrics.find(metric);
+        auto it = old.find(metric);
+        const double value = measured != metrics.end() ? measured->second : it->second.baseline;
+        os << std::left << std::setw(40) << metric << ' ' << std::setw(14) << std::setprecision(10) << value << ' ';
+        if( it != old.end() && it->second.report_only )
+            os << "report\n";
+        else
+            os << (it != old.end() ? it->second.tolerance : DefaultTolerance(metric)) * 100. << "%\n";
+    }
+    return static_cast<bool>(os);
+}
+
+/**
+ * @brief Runs a workload several times and records its cost
+ * @param body Callable running the workload once and returning its work counts
+ *
+ * Records <workload>.seconds and <workload>.instructions as the minimum over
+ * the repetitions, and the work counts of the last repetition.
+ */
+template <typename Body>
+static void Measure(Metrics &metrics, PerfCounters &counters, const std::string &workload, int repetitions, Body body)
+{
+    double seconds = std::numeric_limits<double>::max();
+    std::uint64_t instructions = std::numeric_limits<std::uint64_t>::max();
+    Metrics counts;
+    for( int i = 0; i < repetitions; ++i ) {
+        const auto start = std::chrono::steady_clock::now();
+        counters.Start();
+        counts = body();
+        counters.Stop();
+        seconds = std::min(seconds, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        instructions = std::min(instructions, counters.Value(PerfCounters::Instructions));
+    }
+    metrics[workload + ".seconds"] = seconds;
+    if( counters.Available() )
+        metrics[workload + ".instructions"] = static_cast<double>(instructions);
+    for( const auto &[name, value]: counts )
+        metrics[workload + "." + name] = value;
+}
+
+/**
+ * @brief Returns the fastest of several runs of a workload in seconds
+ *
+ * For workloads running on several threads, whose instructions the
+ * counters of the calling thread can't capture.
+ */
+template <typename Body>
+static double FastestSeconds(int repetitions, Body body)
+{
+    double seconds = std::numeric_limits<double>::max();
+    for( int i = 0; i < repetitions; ++i ) {
+        const auto start = std::chrono::steady_clock::now();
+        body();
+        seconds = std::min(seconds, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return seconds;
+}
+
+// Seeded, connected origin-destination pairs spread over the map.
+static std::vector<std::pair<int, int>> QuerySet(const RouteGraph &graph, std::size_t count)
+{
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<int> node{0, graph.NumNodes() - 1};
+    GraphPlanner planner{graph};
+    std::vector<std::pair<int, int>> pairs;
+    for( int attempts = 0; attempts < 10000 && pairs.size() < count; ++attempts ) {
+        const int s = node(rng), t = node(rng);
+        if( planner.Search(s, t).found )
+            pairs.emplace_back(s, t);
+    }
+    return pairs;
+}
+
+static std::string Format(double value)
+{
+    std::ostringstream os;
+    if( value != 0. && (std::abs(value) < 1e-2 || std::abs(value) >= 1e7) )
+        os << std::scientific << std::setprecision(3) << value;
+    else
+        os << std::fixed << std::setprecision(value == std::floor(value) ? 0 : 4) << value;
+    return os.str();
+}
+
+// Prints one row per metric and returns the number of exceeded budgets.
+static int Compare(const std::map<std::string, Budget> &budgets, const Metrics &metrics)
+{
+    std::set<std::string> names;
+    for( const auto &entry: budgets )
+        names.insert(entry.first);
+    for( const auto &entry: metrics )
+        names.insert(entry.first);
+
+    int exceeded = 0;
+    std::cout << std::left << std::setw(40) << "metric" << std::right << std::setw(14) << "baseline"
+              << std::setw(14) << "measured" << std::setw(10) << "change" << std::setw(10) << "budget" << "  status\n";
+    for( const auto &name: names ) {
+        auto budget = budgets.find(name);
+        auto measured = metrics.find(name);
+        std::cout << std::left << std::setw(40) << name << std::right;
+        std::cout << std::setw(14) << (budget != budgets.end() ? Format(budget->second.baseline) : "-");
+        std::cout << std::setw(14) << (measured != metrics.end() ? Format(measured->second) : "-");
+        if( budget == budgets.end() ) {
+            std::cout << std::setw(20) << "" << "  new, not budgeted\n";
+            continue;
+        }
+        if( measured == metrics.end() ) {
+            std::cout << std::setw(20) << "" << "  skipped, not measured\n";
+            continue;
+        }
+        const auto [baseline, tolerance, report_only] = budget->second;
+        const double change = baseline != 0. ? (measured->second - baseline) / baseline : (measured->second > 0. ? 1. : 0.);
+        std::ostringstream change_text, budget_text;
+        change_text << std::showpos << std::fixed << std::setprecision(1) << change * 100. << '%';
+        if( report_only )
+            budget_text << "report";
+        else
+            budget_text << '+' << std::fixed << std::setprecision(1) << tolerance * 100. << '%';
+        std::cout << std::setw(10) << change_text.str() << std::setw(10) << budget_text.str();
+        if( report_only )
+            std::cout << "  ok, not checked\n";
+        else if( measured->second > baseline * (1. + tolerance) + 1e-9 ) {
+            std::cout << "  OVER BUDGET\n";
+            ++exceeded;
+        }
+        else if( tolerance > 0. && measured->second < baseline * (1. - tolerance) )
+            std::cout << "  improved, consider --update\n";
+        else
+            std::cout << "  ok\n";
+    }
+    return exceeded;
+}
+
+int main(int argc, const char **argv)
+{
+    std::string osm_data_file = "../map.osm";
+    std::string budgets_file = "../perf/budgets.txt";
+    bool update = false;
+    for( int i = 1; i < argc; ++i ) {
+        const std::string_view arg{argv[i]};
+        if( arg == "-f" && i + 1 < argc )
+            osm_data_file = argv[++i];
+        else if( arg == "--budgets" && i + 1 < argc )
+            budgets_file = argv[++i];
+        else if( arg == "--update" )
+            update = true;
+        else {
+            std::cerr << "Usage: perf_budget [-f map.osm] [--budgets budgets.txt] [--update]" << std::endl;
+            return 2;
+        }
+    }
+
+    auto data = ReadFile(osm_data_file);
+    if( !data ) {
+        std::cerr << "Failed to read " << osm_data_file << std::endl;
+        return 1;
+    }
+
+    PerfCounters counters;
+    if( !counters.Available() )
+        std::cout << "Hardware counters unavailable, instruction budgets are skipped." << std::endl;
+    Metrics metrics;
+
+    Measure(metrics, counters, "model_load", 5, [&] {
+        RouteModel model{*data};
+        return Metrics{};
+    });
+
+    RouteModel model{*data};
+    const auto graph = RouteGraph::Build(model);
+    const auto pairs = QuerySet(graph, 32);
+    RoutePlanner::Context context{model};
+
+    Measure(metrics, counters, "route_planner_queries", 5, [&] {
+        double visited = 0., path_nodes = 0.;
+        for( const auto &[s, t]: pairs ) {
+            model.ResetSearch();
+            RoutePlanner planner{model, context, graph.X(s) * 100.f, graph.Y(s) * 100.f, graph.X(t) * 100.f, graph.Y(t) * 100.f};
+            planner.AStarSearch();
+            visited += std::count_if(model.SNodes().begin(), model.SNodes().end(), [](auto &node) { return node.visited; });
+            path_nodes += model.path.size();
+        }
+        model.ResetSearch();
+        return Metrics{{"visited_nodes", visited}, {"path_nodes", path_nodes}};
+    });
+
+    Measure(metrics, counters, "graph_planner_queries", 5, [&] {
+        GraphPlanner planner{graph};
+        double expansions = 0., path_nodes = 0.;
+        for( const auto &[s, t]: pairs ) {
+            path_nodes += planner.Search(s, t).nodes.size();
+            expansions += planner.Expansions();
+        }
+        return Metrics{{"expansions", expansions}, {"path_nodes", path_nodes}};
+    });
+
+#if defined(PERF_BUDGET_WITH_RENDER)
+    {
+        RoutePlanner planner{model, 10.f, 10.f, 90.f, 90.f};
+        planner.AStarSearch();
+        Render render{model};
+        const auto viewport = Viewport::Fit(400, 400);
+        // Uncached, so every repetition builds and draws the whole frame.
+        Measure(metrics, counters, "render_viewport", 3, [&] {
+            auto surface = io2d::image_surface{io2d::format::argb32, viewport.width, viewport.height};
+            render.DisplayUncached(surface, viewport);
+            return Metrics{{"visible_features", static_cast<double>(render.CountVisibleFeatures(viewport))}};
+        });
+
+        // Tiled rendering should scale with the cores; the speedup is printed for comparison.
+        const auto tiled_viewport = Viewport::Fit(1024, 1024);
+        const unsigned hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+        auto tiled = [&](unsigned threads) {
+            return FastestSeconds(3, [&] {
+                auto surface = io2d::image_surface{io2d::format::argb32, tiled_viewport.width, tiled_viewport.height};
+                render.DisplayTiled(surface, tiled_viewport, 256, threads);
+            });
+        };
+        metrics["render_tiled_serial.seconds"] = tiled(1);
+        metrics["render_tiled_parallel.seconds"] = tiled(hardware_threads);
+        std::cout << "Tiled render on " << hardware_threads << " threads: " << std::fixed << std::setprecision(2)
+                  << metrics["render_tiled_serial.seconds"] / metrics["render_tiled_parallel.seconds"] << "x speedup"
+                  << std::defaultfloat << std::endl;
+        model.ResetSearch();
+    }
+#endif
+
+    const auto budgets = ReadBudgets(budgets_file);
+    if( update ) {
+        if( !WriteBudgets(budgets_file, budgets, metrics) ) {
+            std::cerr << "Failed to write " << budgets_file << std::endl;
+            return 1;
+        }
+        std::cout << "Updated " << budgets_file << std::endl;
+        return 0;
+    }
+    if( budgets.empty() ) {
+        std::cerr << "No budgets in " << budgets_file << "; run with --update to create them." << std::endl;
+        return 1;
+    }
+
+    const int exceeded = Compare(budgets, metrics);
+    if( exceeded > 0 ) {
+        std::cout << exceeded << " metric(s) over budget. If the change is intended, rerun with --update." << std::endl;
+        return 1;
+    }
+    std::cout << "All metrics within budget." << std::endl;
+    return 0;
+}
@@ -0,0 +1,266 @@
+#include "artifact_store.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ARTIFACT_STORE_HAS_MMAP 1
+#endif
+
+namespace {
+
+constexpr char kMagic[8] = {'O', 'S', 'M', 'R', 'A', 'R', 'T', '\0'};
+constexpr std::uint32_t kEndianTag = 0x01020304u;
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t endian_tag;
+    std::uint64_t fingerprint;
+    std::uint64_t file_size;
+    std::uint32_t section_count;
+    std::uint32_t reserved;
+    std::uint64_t table_checksum;
+};
+static_assert(sizeof(FileHeader) == 48, "unexpected artifact header layout");
+static_assert(sizeof(ArtifactFile::SectionEntry) == 56, "unexpected artifact section table layout");
+
+std::uint64_t AlignUp(std::uint64_t offset)
+{
+    const auto a = static_cast<std::uint64_t>(ArtifactFile::kSectionAlignment);
+    return (offset + a - 1) / a * a;
+}
+
+// Creates an empty file with a unique name next to path, so concurrent writers
+// of one artifact never share a temporary file. Returns its name, or "" on failure.
+std::string CreateTempFile(const std::string &path)
+{
+#if defined(ARTIFACT_STORE_HAS_MMAP)
+    std::string temp_path = path + ".XXXXXX";
+    const int fd = mkstemp(temp_path.data());
+    if (fd < 0)
+        return {};
+    // mkstemp creates the file as 0600; artifacts are readable by everyone, like before.
+    fchmod(fd, 0644);
+    close(fd);
+    return temp_path;
+#else
+    static std::atomic<unsigned> counter{0};
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        auto temp_path = path + ".tmp" + std::to_string(counter++);
+        // "x" fails if the file exists, so a name is never shared.
+        if (auto *file = std::fopen(temp_path.c_str(), "wbx")) {
+            std::fclose(file);
+            return temp_path;
+        }
+    }
+    return {};
+#endif
+}
+
+}  // namespace
+
+std::uint64_t Fnv1a64(const void *data, std::size_t size, std::uint64_t seed) noexcept
+{
+    auto bytes = static_cast<const unsigned char *>(data);
+    auto hash = seed;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+std::uint64_t ModelFingerprint(const Model &model)
+{
+    auto hash = Fnv1a64(nullptr, 0);
+    const auto scale = model.MetricScale();
+    hash = Fnv1a64(&scale, sizeof(scale), hash);
+    for (const auto &node : model.Nodes()) {
+        hash = Fnv1a64(&node.x, sizeof(node.x), hash);
+        hash = Fnv1a64(&node.y, sizeof(node.y), hash);
+    }
+    for (const auto &way : model.Ways()) {
+        const auto count = static_cast<std::uint64_t>(way.nodes.size());
+        hash = Fnv1a64(&count, sizeof(count), hash);
+        hash = Fnv1a64(way.nodes.data(), way.nodes.size() * sizeof(int), hash);
+    }
+    for (const auto &road : model.Roads()) {
+        const std::int32_t fields[2] = {road.way, static_cast<std::int32_t>(road.type)};
+        hash = Fnv1a64(fields, sizeof(fields), hash);
+    }
+    return hash;
+}
+
+std::uint64_t CombineFingerprint(std::uint64_t fingerprint, std::string_view parameters) noexcept
+{
+    return Fnv1a64(parameters.data(), parameters.size(), fingerprint);
+}
+
+void ArtifactWriter::AddSection(std::string_view name, const void *data, std::size_t bytes, std::uint32_t element_size)
+{
+    if (name.empty() || name.size() > ArtifactFile::kMaxSectionName)
+        throw std::invalid_argument("invalid artifact section name");
+    auto &section = m_Sections.emplace_back();
+    section.name = std::string{name};
+    section.bytes.resize(bytes);
+    if (bytes)
+        std::memcpy(section.bytes.data(), data, bytes);
+    section.element_size = element_size;
+}
+
+bool ArtifactWriter::Write(const std::string &path, std::uint64_t fingerprint) const
+{
+    std::vector<ArtifactFile::SectionEntry> table(m_Sections.size());
+    auto offset = AlignUp(sizeof(FileHeader) + table.size() * sizeof(ArtifactFile::SectionEntry));
+    for (std::size_t i = 0; i < m_Sections.size(); ++i) {
+        auto &entry = table[i];
+        std::memset(&entry, 0, sizeof(entry));
+        std::memcpy(entry.name, m_Sections[i].name.data(), m_Sections[i].name.size());
+        entry.offset = offset;
+        entry.size = m_Sections[i].bytes.size();
+        entry.checksum = Fnv1a64(m_Sections[i].bytes.data(), m_Sections[i].bytes.size());
+        entry.element_size = m_Sections[i].element_size;
+        offset = AlignUp(offset + entry.size);
+    }
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = ArtifactFile::kFormatVersion;
+    header.endian_tag = kEndianTag;
+    header.fingerprint = fingerprint;
+    header.file_size = offset;
+    header.section_count = static_cast<std::uint32_t>(table.size());
+    header.table_checksum = Fnv1a64(table.data(), table.size() * sizeof(ArtifactFile::SectionEntry));
+
+    // Write next to the destination and rename, so readers never see a partial file.
+    const auto temp_path = CreateTempFile(path);
+    if (temp_path.empty())
+        return false;
+    {
+        std::ofstream os{temp_path, std::ios::binary | std::ios::trunc};
+        if (!os) {
+            std::remove(temp_path.c_str());
+            return false;
+        }
+        const char zeros[ArtifactFile::kSectionAlignment] = {};
+        os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        os.write(reinterpret_cast<const char *>(table.data()), table.size() * sizeof(ArtifactFile::SectionEntry));
+        std::uint64_t written = sizeof(header) + table.size() * sizeof(ArtifactFile::SectionEntry);
+        for (std::size_t i = 0; i < m_Sections.size(); ++i) {
+            os.write(zeros, table[i].offset - written);
+            os.write(reinterpret_cast<const char *>(m_Sections[i].bytes.data()), m_Sections[i].bytes.size());
+            written = table[i].offset + table[i].size;
+        }
+        os.write(zeros, header.file_size - written);
+        os.close();
+        if (!os) {
+            std::remove(temp_path.c_str());
+            return false;
+        }
+    }
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+ArtifactMapping::~ArtifactMapping()
+{
+#if defined(ARTIFACT_STORE_HAS_MMAP)
+    if (mapped) {
+        munmap(const_cast<std::byte *>(data), size);
+        return;
+    }
+#endif
+    if (data)
+        ::operator delete(const_cast<std::byte *>(data), std::align_val_t{ArtifactFile::kSectionAlignment});
+}
+
+static std::shared_ptr<ArtifactMapping> MapFile(const std::string &path)
+{
+    auto mapping = std::make_shared<ArtifactMapping>();
+#if defined(ARTIFACT_STORE_HAS_MMAP)
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+        close(fd);
+        return nullptr;
+    }
+    void *address = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED)
+        return nullptr;
+    mapping->data = static_cast<const std::byte *>(address);
+    mapping->size = static_cast<std::size_t>(st.st_size);
+    mapping->mapped = true;
+#else
+    std::ifstream is{path, std::ios::binary | std::ios::ate};
+    if (!is)
+        return nullptr;
+    const auto size = static_cast<std::size_t>(is.tellg());
+    if (size < sizeof(FileHeader))
+        return nullptr;
+    auto buffer = static_cast<std::byte *>(::operator new(size, std::align_val_t{ArtifactFile::kSectionAlignment}));
+    mapping->data = buffer;
+    mapping->size = size;
+    is.seekg(0);
+    if (!is.read(reinterpret_cast<char *>(buffer), size))
+        return nullptr;
+#endif
+    return mapping;
+}
+
+std::optional<ArtifactFile> ArtifactFile::Open(const std::string &path, std::uint64_t fingerprint, bool verify_checksums)
+{
+    auto mapping = MapFile(path);
+    if (!mapping)
+        return std::nullopt;
+
+    FileHeader header;
+    std::memcpy(&header, mapping->data, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kFormatVersion ||
+        header.endian_tag != kEndianTag || header.fingerprint != fingerprint || header.file_size != mapping->size)
+        return std::nullopt;
+
+    const auto table_bytes = static_cast<std::uint64_t>(header.section_count) * sizeof(SectionEntry);
+    if (table_bytes > mapping->size - sizeof(FileHeader))
+        return std::nullopt;
+
+    ArtifactFile file;
+    file.m_Sections.resize(header.section_count);
+    std::memcpy(file.m_Sections.data(), mapping->data + sizeof(FileHeader), table_bytes);
+    if (Fnv1a64(file.m_Sections.data(), table_bytes) != header.table_checksum)
+        return std::nullopt;
+
+    for (auto &section : file.m_Sections) {
+        section.name[kMaxSectionName] = '\0';
+        if (section.offset % kSectionAlignment != 0 || section.offset > mapping->size ||
+            section.size > mapping->size - section.offset || section.element_size == 0)
+            return std::nullopt;
+        if (verify_checksums && Fnv1a64(mapping->data + section.offset, section.size) != section.checksum)
+            return std::nullopt;
+    }
+    file.m_Mapping = std::move(mapping);
+    return file;
+}
+
+const ArtifactFile::SectionEntry *ArtifactFile::Find(std::string_view name) const noexcept
+{
+    auto it = std::find_if(m_Sections.begin(), m_Sections.end(), [&](const SectionEntry &section) {
+        return name == section.name;
+    });
+    return it != m_Sections.end() ? &*it : nullptr;
+}
@@ -0,0 +1,244 @@
+/**
+ * @file artifact_store.h
+ * @brief Versioned on-disk container for derived routing data
+ *
+ * This file contains the artifact file format used to persist preprocessing
+ * results (road graphs, pruning bounds, spatial indices) between runs. A file
+ * holds named sections of flat arrays, each aligned to kSectionAlignment so
+ * it can be used in place after mmap. The header carries a fingerprint of the
+ * source Model and build parameters; a file whose fingerprint, version or
+ * checksums don't match is treated as stale and rebuilt.
+ */
+
+#ifndef ARTIFACT_STORE_H
+#define ARTIFACT_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "model.h"
+
+/**
+ * @class MappedArray
+ * @brief Read-only array that either owns its elements or borrows mapped memory
+ * @tparam T A trivially copyable element type
+ *
+ * Indexing goes through a raw pointer in both cases, so owned and mapped
+ * arrays are equally fast. A borrowed array keeps its backing file alive.
+ */
+template <typename T>
+class MappedArray {
+    static_assert(std::is_trivially_copyable<T>::value, "MappedArray needs trivially copyable elements");
+
+  public:
+    MappedArray() = default;
+
+    /**
+     * @brief Takes ownership of a vector
+     */
+    MappedArray(std::vector<T> owned) : m_Owned(std::move(owned)), m_Data(m_Owned.data()), m_Size(m_Owned.size()) {}
+
+    /**
+     * @brief Borrows elements that live in memory kept alive by keepalive
+     */
+    MappedArray(const T *data, std::size_t size, std::shared_ptr<const void> keepalive)
+        : m_Keepalive(std::move(keepalive)), m_Data(data), m_Size(size) {}
+
+    MappedArray(const MappedArray &other) { *this = other; }
+    MappedArray(MappedArray &&other) noexcept { *this = std::move(other); }
+
+    MappedArray &operator=(const MappedArray &other) {
+        if (this != &other) {
+            m_Owned = other.m_Owned;
+            m_Keepalive = other.m_Keepalive;
+            m_Data = m_Keepalive ? other.m_Data : m_Owned.data();
+            m_Size = other.m_Size;
+        }
+        return *this;
+    }
+
+    MappedArray &operator=(MappedArray &&other) noexcept {
+        if (this != &other) {
+            m_Owned = std::move(other.m_Owned);
+            m_Keepalive = std::move(other.m_Keepalive);
+            m_Data = m_Keepalive ? other.m_Data : m_Owned.data();
+            m_Size = other.m_Size;
+            other.m_Data = nullptr;
+            other.m_Size = 0;
+        }
+        return *this;
+    }
+
+    const T &operator[](std::size_t i) const noexcept { return m_Data[i]; }
+    const T *data() const noexcept { return m_Data; }
+    std::size_t size() const noexcept { return m_Size; }
+    bool empty() const noexcept { return m_Size == 0; }
+    const T *begin() const noexcept { return m_Data; }
+    const T *end() const noexcept { return m_Data + m_Size; }
+
+    /**
+     * @brief Returns true if the elements live in a mapped file
+     */
+    bool IsMapped() const noexcept { return m_Keepalive != nullptr; }
+
+  private:
+    std::vector<T> m_Owned;                   ///< Owned elements, empty when borrowed
+    std::shared_ptr<const void> m_Keepalive;  ///< Backing file of borrowed elements
+    const T *m_Data = nullptr;                ///< First element
+    std::size_t m_Size = 0;                   ///< Number of elements
+};
+
+/**
+ * @brief Computes the 64-bit FNV-1a hash of a byte range
+ */
+std::uint64_t Fnv1a64(const void *data, std::size_t size, std::uint64_t seed = 0xcbf29ce484222325ull) noexcept;
+
+/**
+ * @brief Fingerprints the routing-relevant content of a model
+ *
+ * Covers node coordinates, ways, roads and the metric scale; two models with
+ * the same fingerprint produce the same road graph.
+ */
+std::uint64_t ModelFingerprint(const Model &model);
+
+/**
+ * @brief Mixes build parameters (metric, units, format of a section) into a fingerprint
+ */
+std::uint64_t CombineFingerprint(std::uint64_t fingerprint, std::string_view parameters) noexcept;
+
+/**
+ * @class ArtifactWriter
+ * @brief Collects named sections and writes them as one artifact file
+ */
+class ArtifactWriter {
+  public:
+    /**
+     * @brief Adds a section holding a copy of an array
+     * @param name Section name, at most kMaxSectionName characters
+     */
+    template <typename T>
+    void AddArray(std::string_view name, const T *data, std::size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "sections hold trivially copyable elements");
+        AddSection(name, data, count * sizeof(T), sizeof(T));
+    }
+
+    template <typename T>
+    void AddArray(std::string_view name, const std::vector<T> &values) { AddArray(name, values.data(), values.size()); }
+
+    template <typename T>
+    void AddArray(std::string_view name, const MappedArray<T> &values) { AddArray(name, values.data(), values.size()); }
+
+    /**
+     * @brief Adds a section holding a single value
+     */
+    template <typename T>
+    void AddValue(std::string_view name, const T &value) { AddArray(name, &value, 1); }
+
+    /**
+     * @brief Writes all sections to a file
+     * @param path Destination; written to a temporary file and renamed into place
+     * @param fingerprint Fingerprint identifying the source data and parameters
+     * @return True on success
+     */
+    bool Write(const std::string &path, std::uint64_t fingerprint) const;
+
+  private:
+    void AddSection(std::string_view name, const void *data, std::size_t bytes, std::uint32_t element_size);
+
+    struct Section {
+        std::string name;
+        std::vector<std::byte> bytes;
+        std::uint32_t element_size;
+    };
+    std::vector<Section> m_Sections;  ///< Sections in insertion order
+};
+
+/**
+ * @struct ArtifactMapping
+ * @brief Owner of the mapped (or, without mmap, read) contents of an artifact file
+ */
+struct ArtifactMapping {
+    const std::byte *data = nullptr;  ///< Start of the file contents
+    std::size_t size = 0;             ///< File size in bytes
+    bool mapped = false;              ///< True if data comes from mmap
+    ~ArtifactMapping();
+};
+
+/**
+ * @class ArtifactFile
+ * @brief A validated, memory-mapped artifact file
+ *
+ * Sections are exposed as MappedArray views into the mapping; the mapping
+ * stays alive as long as the file object or any view does.
+ */
+class ArtifactFile {
+  public:
+    /**
+     * @brief Opens and validates an artifact file
+     * @param path The file to open
+     * @param fingerprint The fingerprint the file must carry
+     * @param verify_checksums Also hash every section (reads the whole file)
+     * @return The file, or nullopt if it is missing, corrupt, of another version or stale
+     */
+    static std::optional<ArtifactFile> Open(const std::string &path, std::uint64_t fingerprint, bool verify_checksums = true);
+
+    /**
+     * @brief Returns true if the file has a section with this name
+     */
+    bool Has(std::string_view name) const noexcept { return Find(name) != nullptr; }
+
+    /**
+     * @brief Returns a zero-copy view of an array section
+     * @return The view, or nullopt if the section is missing or has another element size
+     */
+    template <typename T>
+    std::optional<MappedArray<T>> Array(std::string_view name) const {
+        const auto *section = Find(name);
+        if (!section || section->element_size != sizeof(T) || section->size % sizeof(T) != 0)
+            return std::nullopt;
+        return MappedArray<T>(reinterpret_cast<const T *>(m_Mapping->data + section->offset),
+                              section->size / sizeof(T), m_Mapping);
+    }
+
+    /**
+     * @brief Returns the value of a single-value section
+     */
+    template <typename T>
+    std::optional<T> Value(std::string_view name) const {
+        auto array = Array<T>(name);
+        if (!array || array->size() != 1)
+            return std::nullopt;
+        return (*array)[0];
+    }
+
+    static constexpr std::uint32_t kFormatVersion = 1;       ///< Bumped on incompatible format changes
+    static constexpr std::size_t kSectionAlignment = 64;     ///< Alignment of every section
+    static constexpr std::size_t kMaxSectionName = 23;       ///< Longest section name
+
+    /**
+     * @struct SectionEntry
+     * @brief One entry of the on-disk section table
+     */
+    struct SectionEntry {
+        char name[kMaxSectionName + 1];  ///< NUL-terminated section name
+        std::uint64_t offset;            ///< Byte offset from the start of the file
+        std::uint64_t size;              ///< Size in bytes
+        std::uint64_t checksum;          ///< FNV-1a 64 of the section bytes
+        std::uint32_t element_size;      ///< Size of one element in bytes
+        std::uint32_t reserved;          ///< Zero
+    };
+
+  private:
+    const SectionEntry *Find(std::string_view name) const noexcept;
+
+    std::shared_ptr<const ArtifactMapping> m_Mapping;  ///< File contents
+    std::vector<SectionEntry> m_Sections;              ///< Validated section table
+};
+
+#endif
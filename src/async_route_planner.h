@@ -0,0 +1,320 @@
+/**
+ * @file async_route_planner.h
+ * @brief Awaitable, cancellable route queries built on C++20 coroutines
+ *
+ * This file contains a minimal coroutine toolkit (Task, Schedule, Spawn,
+ * SyncWait, ThreadPoolExecutor, CancellationToken) and RouteAsync, which runs
+ * a graph search on an executor in slices of a fixed number of expansions.
+ * Between slices the query goes back to the end of the executor queue, so
+ * long queries don't starve short ones, and a cancelled query releases its
+ * search context at the next slice boundary.
+ *
+ * Requires C++20; only include it from targets built with coroutine support.
+ */
+
+#ifndef ASYNC_ROUTE_PLANNER_H
+#define ASYNC_ROUTE_PLANNER_H
+
+#if !defined(__cpp_impl_coroutine)
+#error "async_route_planner.h requires C++20 coroutines"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "graph_planner.h"
+
+/**
+ * @class CancellationToken
+ * @brief Shared flag used to abandon an asynchronous query
+ *
+ * Copies of a token share the same flag, so the caller keeps one copy and
+ * passes another to the query.
+ */
+class CancellationToken {
+  public:
+    CancellationToken() : m_Flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+    /**
+     * @brief Requests cancellation of every query holding this token
+     */
+    void Cancel() noexcept { m_Flag->store(true, std::memory_order_relaxed); }
+
+    /**
+     * @brief Returns true once Cancel() has been called on any copy
+     */
+    bool IsCancelled() const noexcept { return m_Flag->load(std::memory_order_relaxed); }
+
+  private:
+    std::shared_ptr<std::atomic<bool>> m_Flag;  ///< Flag shared by all copies
+};
+
+/**
+ * @class Task
+ * @brief Lazily started coroutine producing a value of type T
+ * @tparam T The result type
+ *
+ * The coroutine starts when the task is awaited and resumes its awaiter
+ * when it finishes. Exceptions are rethrown to the awaiter.
+ */
+template <typename T>
+class Task {
+  public:
+    struct promise_type {
+        std::optional<T> value;                ///< Result, set by co_return
+        std::exception_ptr error;              ///< Exception escaping the coroutine
+        std::coroutine_handle<> continuation;  ///< Coroutine awaiting this task
+
+        Task get_return_object() noexcept {
+            return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                auto continuation = handle.promise().continuation;
+                return continuation ? continuation : std::noop_coroutine();
+            }
+            void await_resume() const noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void return_value(T result) { value.emplace(std::move(result)); }
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+    };
+
+    Task(Task &&other) noexcept : m_Handle(std::exchange(other.m_Handle, {})) {}
+    Task &operator=(Task &&other) noexcept {
+        if (this != &other) {
+            if (m_Handle)
+                m_Handle.destroy();
+            m_Handle = std::exchange(other.m_Handle, {});
+        }
+        return *this;
+    }
+    ~Task() {
+        if (m_Handle)
+            m_Handle.destroy();
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        m_Handle.promise().continuation = awaiting;
+        return m_Handle;
+    }
+    T await_resume() {
+        if (m_Handle.promise().error)
+            std::rethrow_exception(m_Handle.promise().error);
+        return std::move(*m_Handle.promise().value);
+    }
+
+  private:
+    explicit Task(std::coroutine_handle<promise_type> handle) noexcept : m_Handle(handle) {}
+
+    std::coroutine_handle<promise_type> m_Handle;  ///< Owned coroutine frame
+};
+
+/**
+ * @brief Returns an awaitable that resumes the awaiting coroutine on an executor
+ * @tparam Executor Any type with a Post(std::function<void()>) member
+ */
+template <typename Executor>
+auto Schedule(Executor &executor) {
+    struct Awaiter {
+        Executor &executor;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { executor.Post([handle] { handle.resume(); }); }
+        void await_resume() const noexcept {}
+    };
+    return Awaiter{executor};
+}
+
+namespace detail {
+
+/**
+ * @struct DetachedTask
+ * @brief Eagerly started coroutine that destroys itself when it finishes
+ */
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+template <typename T, typename Callback>
+DetachedTask RunDetached(Task<T> task, Callback callback) {
+    callback(co_await task);
+}
+
+}  // namespace detail
+
+/**
+ * @brief Starts a task without awaiting it and passes its result to a callback
+ * @param task The task to run
+ * @param callback Invoked with the result on whichever thread finishes the task
+ */
+template <typename T, typename Callback>
+void Spawn(Task<T> task, Callback callback) {
+    detail::RunDetached(std::move(task), std::move(callback));
+}
+
+/**
+ * @brief Runs a task and blocks the calling thread until it produces its result
+ *
+ * The task must make progress on another thread (e.g. a ThreadPoolExecutor).
+ */
+template <typename T>
+T SyncWait(Task<T> task) {
+    std::mutex mutex;
+    std::condition_variable done;
+    std::optional<T> result;
+    Spawn(std::move(task), [&](T value) {
+        std::lock_guard<std::mutex> lock{mutex};
+        result.emplace(std::move(value));
+        done.notify_one();
+    });
+    std::unique_lock<std::mutex> lock{mutex};
+    done.wait(lock, [&] { return result.has_value(); });
+    return std::move(*result);
+}
+
+/**
+ * @class ThreadPoolExecutor
+ * @brief Fixed-size pool of worker threads running posted jobs in FIFO order
+ */
+class ThreadPoolExecutor {
+  public:
+    /**
+     * @brief Starts the worker threads
+     * @param threads Number of workers; 0 selects the hardware concurrency
+     */
+    explicit ThreadPoolExecutor(unsigned threads = 0) {
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 0; i < threads; ++i)
+            m_Workers.emplace_back([this] { Run(); });
+    }
+
+    /**
+     * @brief Runs the remaining jobs and joins the workers
+     */
+    ~ThreadPoolExecutor() {
+        {
+            std::lock_guard<std::mutex> lock{m_Mutex};
+            m_Stopping = true;
+        }
+        m_Ready.notify_all();
+        for (auto &worker : m_Workers)
+            worker.join();
+    }
+
+    ThreadPoolExecutor(const ThreadPoolExecutor &) = delete;
+    ThreadPoolExecutor &operator=(const ThreadPoolExecutor &) = delete;
+
+    /**
+     * @brief Queues a job for execution on a worker thread
+     */
+    void Post(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock{m_Mutex};
+            m_Jobs.push_back(std::move(job));
+        }
+        m_Ready.notify_one();
+    }
+
+  private:
+    void Run() {
+        for (;;) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock{m_Mutex};
+                m_Ready.wait(lock, [this] { return m_Stopping || !m_Jobs.empty(); });
+                if (m_Jobs.empty())
+                    return;
+                job = std::move(m_Jobs.front());
+                m_Jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+    std::mutex m_Mutex;                        ///< Guards m_Jobs and m_Stopping
+    std::condition_variable m_Ready;           ///< Signals new jobs or shutdown
+    std::deque<std::function<void()>> m_Jobs;  ///< Pending jobs
+    bool m_Stopping = false;                   ///< Set by the destructor
+    std::vector<std::thread> m_Workers;        ///< Worker threads
+};
+
+/**
+ * @enum RouteStatus
+ * @brief Outcome of an asynchronous route query
+ */
+enum class RouteStatus { Found, Unreachable, Cancelled };
+
+/**
+ * @struct RouteResult
+ * @brief Result of an asynchronous route query
+ */
+struct RouteResult {
+    RouteStatus status = RouteStatus::Cancelled;  ///< How the query ended
+    GraphPath path;                               ///< The path if status is Found
+    std::size_t expansions = 0;                   ///< Nodes expanded before the query ended
+};
+
+constexpr std::size_t kDefaultYieldInterval = 256;  ///< Expansions between cooperative yields
+
+/**
+ * @brief Plans a route on an executor, yielding every few expansions
+ * @tparam Planner A graph planner with Start()/Step()/Result()
+ * @param executor Executor running the search; must outlive the query
+ * @param graph Graph to search; must outlive the query
+ * @param source The start node id
+ * @param target The goal node id
+ * @param token Cancellation token checked before every slice
+ * @param yield_every Number of expansions per slice
+ * @return A task producing the route, or RouteStatus::Cancelled
+ *
+ * The planner (and with it the whole search context) is created on the
+ * executor and destroyed as soon as the query finishes or notices it was
+ * cancelled, so an abandoned query holds memory for at most one slice.
+ */
+template <typename Planner = GraphPlanner, typename Executor>
+Task<RouteResult> RouteAsync(Executor &executor, const RouteGraph &graph, int source, int target,
+                             CancellationToken token = {}, std::size_t yield_every = kDefaultYieldInterval) {
+    co_await Schedule(executor);
+    RouteResult result;
+    if (token.IsCancelled())
+        co_return result;
+
+    auto planner = std::make_unique<Planner>(graph);
+    planner->Start(source, target);
+    for (;;) {
+        const auto status = planner->Step(yield_every);
+        result.expansions = planner->Expansions();
+        if (status != SearchStatus::Running) {
+            result.status = status == SearchStatus::Found ? RouteStatus::Found : RouteStatus::Unreachable;
+            result.path = planner->Result();
+            co_return result;
+        }
+        co_await Schedule(executor);
+        if (token.IsCancelled())
+            co_return result;
+    }
+}
+
+#endif
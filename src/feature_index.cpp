@@ -0,0 +1,173 @@
+#include "feature_index.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace {
+
+constexpr float kEmpty = std::numeric_limits<float>::max();
+
+/**
+ * @brief Accumulates the bounding box of node sequences
+ */
+class BoxBuilder {
+  public:
+    explicit BoxBuilder(const Model &model) : m_Nodes(model.Nodes().data()), m_Ways(model.Ways().data()) {}
+
+    void Add(const Model::Way &way) {
+        for (auto n : way.nodes) {
+            const auto x = static_cast<float>(m_Nodes[n].x), y = static_cast<float>(m_Nodes[n].y);
+            m_Box.min_x = std::min(m_Box.min_x, x);
+            m_Box.min_y = std::min(m_Box.min_y, y);
+            m_Box.max_x = std::max(m_Box.max_x, x);
+            m_Box.max_y = std::max(m_Box.max_y, y);
+        }
+    }
+
+    void Add(const Model::Multipolygon &mp) {
+        for (auto w : mp.outer)
+            Add(m_Ways[w]);
+        for (auto w : mp.inner)
+            Add(m_Ways[w]);
+    }
+
+    BoundingBox Take() noexcept { return std::exchange(m_Box, BoundingBox{kEmpty, kEmpty, -kEmpty, -kEmpty}); }
+
+  private:
+    const Model::Node *m_Nodes;
+    const Model::Way *m_Ways;
+    BoundingBox m_Box{kEmpty, kEmpty, -kEmpty, -kEmpty};
+};
+
+bool IsEmpty(const BoundingBox &box) noexcept { return box.min_x > box.max_x; }
+
+}  // namespace
+
+FeatureIndex::FeatureIndex(const Model &model, int cells_per_side)
+{
+    BoxBuilder builder{model};
+    const auto ways = model.Ways().data();
+    auto add_areas = [&](FeatureLayer layer, const auto &areas) {
+        auto &boxes = m_Layers[static_cast<int>(layer)].boxes;
+        boxes.reserve(areas.size());
+        for (const auto &area : areas) {
+            builder.Add(area);
+            boxes.push_back(builder.Take());
+        }
+    };
+    auto add_lines = [&](FeatureLayer layer, const auto &lines) {
+        auto &boxes = m_Layers[static_cast<int>(layer)].boxes;
+        boxes.reserve(lines.size());
+        for (const auto &line : lines) {
+            builder.Add(ways[line.way]);
+            boxes.push_back(builder.Take());
+        }
+    };
+    add_areas(FeatureLayer::Landuse, model.Landuses());
+    add_areas(FeatureLayer::Leisure, model.Leisures());
+    add_areas(FeatureLayer::Water, model.Waters());
+    add_lines(FeatureLayer::Railway, model.Railways());
+    add_lines(FeatureLayer::Road, model.Roads());
+    add_areas(FeatureLayer::Building, model.Buildings());
+
+    std::size_t features = 0;
+    m_Extent = {kEmpty, kEmpty, -kEmpty, -kEmpty};
+    for (const auto &layer : m_Layers)
+        for (const auto &box : layer.boxes)
+            if (!IsEmpty(box)) {
+                ++features;
+                m_Extent.min_x = std::min(m_Extent.min_x, box.min_x);
+                m_Extent.min_y = std::min(m_Extent.min_y, box.min_y);
+                m_Extent.max_x = std::max(m_Extent.max_x, box.max_x);
+                m_Extent.max_y = std::max(m_Extent.max_y, box.max_y);
+            }
+    if (features == 0)
+        m_Extent = {};
+
+    if (cells_per_side <= 0)
+        cells_per_side = std::min(1024, static_cast<int>(std::ceil(std::sqrt(features / 2.))));
+    m_Cells = std::max(1, cells_per_side);
+    m_CellWidth = std::max((m_Extent.max_x - m_Extent.min_x) / m_Cells, std::numeric_limits<float>::epsilon());
+    m_CellHeight = std::max((m_Extent.max_y - m_Extent.min_y) / m_Cells, std::numeric_limits<float>::epsilon());
+    for (auto &layer : m_Layers)
+        BuildCells(layer);
+}
+
+void FeatureIndex::BuildCells(Layer &layer)
+{
+    // Counting pass, then fill pass, over the cells each feature's bounding box covers.
+    auto for_each_cell = [&](const BoundingBox &box, auto &&visit) {
+        const int x0 = CellX(box.min_x), x1 = CellX(box.max_x);
+        const int y0 = CellY(box.min_y), y1 = CellY(box.max_y);
+        for (int cy = y0; cy <= y1; ++cy)
+            for (int cx = x0; cx <= x1; ++cx)
+                visit(cy * m_Cells + cx);
+    };
+    layer.cell_start.assign(static_cast<std::size_t>(m_Cells) * m_Cells + 1, 0);
+    for (const auto &box : layer.boxes)
+        if (!IsEmpty(box))
+            for_each_cell(box, [&](int cell) { ++layer.cell_start[cell + 1]; });
+    for (std::size_t c = 1; c < layer.cell_start.size(); ++c)
+        layer.cell_start[c] += layer.cell_start[c - 1];
+    layer.cell_items.resize(layer.cell_start.back());
+    auto fill = layer.cell_start;
+    for (std::uint32_t f = 0; f < layer.boxes.size(); ++f)
+        if (!IsEmpty(layer.boxes[f]))
+            for_each_cell(layer.boxes[f], [&](int cell) { layer.cell_items[fill[cell]++] = f; });
+}
+
+void FeatureIndex::Query(FeatureLayer layer, const BoundingBox &box, std::vector<int> &features) const
+{
+    features.clear();
+    const auto &data = m_Layers[static_cast<int>(layer)];
+    if (IsEmpty(box) || !box.Intersects(m_Extent))
+        return;
+
+    // A view of the whole map tests every box once, which is cheaper than collecting and sorting cells.
+    if (box.Contains(m_Extent)) {
+        for (int f = 0; f < static_cast<int>(data.boxes.size()); ++f)
+            if (!IsEmpty(data.boxes[f]))
+                features.push_back(f);
+        return;
+    }
+
+    const int x0 = CellX(box.min_x), x1 = CellX(box.max_x);
+    const int y0 = CellY(box.min_y), y1 = CellY(box.max_y);
+    for (int cy = y0; cy <= y1; ++cy)
+        for (int cx = x0; cx <= x1; ++cx) {
+            const auto cell = cy * m_Cells + cx;
+            for (auto i = data.cell_start[cell]; i < data.cell_start[cell + 1]; ++i)
+                if (data.boxes[data.cell_items[i]].Intersects(box))
+                    features.push_back(static_cast<int>(data.cell_items[i]));
+        }
+    std::sort(features.begin(), features.end());
+    features.erase(std::unique(features.begin(), features.end()), features.end());
+}
+
+void FeatureIndex::QueryVisible(FeatureLayer layer, const BoundingBox &view, double scale, double metric_scale,
+                                float widest_stroke, float min_pixels, std::vector<int> &features) const
+{
+    // Strokes reach half their width beyond a feature's box; one extra pixel covers antialiasing.
+    const auto pixel = static_cast<float>(1. / scale);
+    const auto pixels_in_meter = static_cast<float>(scale / metric_scale);
+    const auto margin = std::max(widest_stroke * pixels_in_meter, 1.f) / 2.f * pixel + pixel;
+    Query(layer, view.Expanded(margin), features);
+
+    // Skip features that would cover less than the minimum size.
+    const auto min_size = min_pixels * pixel;
+    features.erase(std::remove_if(features.begin(), features.end(), [&](int i) {
+        auto &bounds = Bounds(layer, i);
+        return bounds.max_x - bounds.min_x < min_size && bounds.max_y - bounds.min_y < min_size;
+    }), features.end());
+}
+
+int FeatureIndex::CellX(float x) const noexcept
+{
+    return static_cast<int>(std::clamp((x - m_Extent.min_x) / m_CellWidth, 0.f, m_Cells - 1.f));
+}
+
+int FeatureIndex::CellY(float y) const noexcept
+{
+    return static_cast<int>(std::clamp((y - m_Extent.min_y) / m_CellHeight, 0.f, m_Cells - 1.f));
+}
@@ -0,0 +1,114 @@
+/**
+ * @file feature_index.h
+ * @brief Spatial index over the bounding boxes of the map's drawable features
+ *
+ * This file contains FeatureIndex, a uniform grid over the roads, railways,
+ * buildings and areas of a Model. Render queries it with the viewport's
+ * bounds so that a zoomed-in view only builds and draws the features that
+ * can be visible.
+ */
+
+#ifndef FEATURE_INDEX_H
+#define FEATURE_INDEX_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "model.h"
+#include "viewport.h"
+
+/**
+ * @enum FeatureLayer
+ * @brief Feature collections of a Model, in Render's drawing order
+ */
+enum class FeatureLayer { Landuse, Leisure, Water, Railway, Road, Building };
+
+/// Number of FeatureLayer values
+constexpr int kFeatureLayers = 6;
+
+/**
+ * @class FeatureIndex
+ * @brief Uniform grid of feature bounding boxes supporting box queries
+ *
+ * Features are identified by their index in the Model's collection of the
+ * layer. Every feature is listed in each grid cell its bounding box
+ * overlaps; a query collects the candidates of the covered cells and keeps
+ * those whose box intersects the query box.
+ */
+class FeatureIndex {
+  public:
+    /**
+     * @brief Builds the index for a model
+     * @param model The model whose features are indexed
+     * @param cells_per_side Grid resolution; 0 picks about one cell per two features
+     */
+    explicit FeatureIndex(const Model &model, int cells_per_side = 0);
+
+    /**
+     * @brief Finds the features of a layer whose bounding box intersects a box
+     * @param layer The layer to search
+     * @param box The query box in normalized coordinates
+     * @param features Receives the feature indices in ascending order, i.e. drawing order
+     */
+    void Query(FeatureLayer layer, const BoundingBox &box, std::vector<int> &features) const;
+
+    /**
+     * @brief Finds the features of a layer that can show up in a view drawn at a scale
+     * @param layer The layer to search
+     * @param view The visible box in normalized coordinates
+     * @param scale Pixels per normalized unit
+     * @param metric_scale Meters per normalized unit
+     * @param widest_stroke Widest line drawn for the layer's features in meters
+     * @param min_pixels Features whose box is smaller than this in both directions are skipped
+     * @param features Receives the feature indices in ascending order, i.e. drawing order
+     *
+     * The view is widened by half the widest stroke and one pixel for
+     * antialiasing, so features just outside it whose strokes reach in are kept.
+     */
+    void QueryVisible(FeatureLayer layer, const BoundingBox &view, double scale, double metric_scale,
+                      float widest_stroke, float min_pixels, std::vector<int> &features) const;
+
+    /**
+     * @brief Returns the bounding box of a feature
+     *
+     * Features without geometry have an empty box that intersects nothing.
+     */
+    const BoundingBox &Bounds(FeatureLayer layer, int feature) const noexcept {
+        return m_Layers[static_cast<int>(layer)].boxes[feature];
+    }
+
+    /**
+     * @brief Returns the number of features in a layer
+     */
+    int Size(FeatureLayer layer) const noexcept {
+        return static_cast<int>(m_Layers[static_cast<int>(layer)].boxes.size());
+    }
+
+    /**
+     * @brief Returns the box enclosing all indexed features
+     */
+    const BoundingBox &Extent() const noexcept { return m_Extent; }
+
+  private:
+    /**
+     * @struct Layer
+     * @brief Boxes and grid cells of one layer
+     */
+    struct Layer {
+        std::vector<BoundingBox> boxes;          ///< Bounding box per feature
+        std::vector<std::uint32_t> cell_start;   ///< CSR offsets into cell_items, row-major
+        std::vector<std::uint32_t> cell_items;   ///< Feature indices per cell
+    };
+
+    void BuildCells(Layer &layer);
+    int CellX(float x) const noexcept;
+    int CellY(float y) const noexcept;
+
+    std::array<Layer, kFeatureLayers> m_Layers;  ///< Per-layer data, indexed by FeatureLayer
+    BoundingBox m_Extent;                        ///< Box enclosing all features
+    int m_Cells = 1;                             ///< Cells per side
+    float m_CellWidth = 1.f;                     ///< Cell width in normalized units
+    float m_CellHeight = 1.f;                    ///< Cell height in normalized units
+};
+
+#endif
@@ -0,0 +1,168 @@
+#include "geometry_lod.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+/**
+ * @brief Distance from a point to a segment
+ */
+double SegmentDistance(const Model::Node &p, const Model::Node &a, const Model::Node &b) noexcept
+{
+    const double dx = b.x - a.x, dy = b.y - a.y;
+    const double length2 = dx * dx + dy * dy;
+    const double t = length2 > 0. ? std::clamp(((p.x - a.x) * dx + (p.y - a.y) * dy) / length2, 0., 1.) : 0.;
+    return std::hypot(a.x + t * dx - p.x, a.y + t * dy - p.y);
+}
+
+}  // namespace
+
+GeometryLod::GeometryLod(const Model &model, int bands, double base_tolerance) :
+    m_Model(model),
+    m_BaseTolerance(base_tolerance)
+{
+    const auto &ways = model.Ways();
+
+    // Endpoints and nodes used by more than one way must survive every band.
+    std::vector<std::uint8_t> uses(model.Nodes().size(), 0);
+    std::vector<bool> shared(model.Nodes().size(), false);
+    for (const auto &way : ways) {
+        if (way.nodes.empty())
+            continue;
+        const bool closed = way.nodes.size() > 1 && way.nodes.front() == way.nodes.back();
+        for (std::size_t i = 0; i + (closed ? 1 : 0) < way.nodes.size(); ++i)
+            if (uses[way.nodes[i]] < 2)
+                ++uses[way.nodes[i]];
+        shared[way.nodes.front()] = shared[way.nodes.back()] = true;
+    }
+    for (std::size_t n = 0; n < uses.size(); ++n)
+        if (uses[n] > 1)
+            shared[n] = true;
+
+    std::vector<int> kept;
+    for (int band = 1; band < std::max(bands, 1); ++band) {
+        Level level;
+        level.offsets.reserve(ways.size() + 1);
+        level.inherited.reserve(ways.size());
+        for (int w = 0; w < static_cast<int>(ways.size()); ++w) {
+            const auto &nodes = ways[w].nodes;
+            level.offsets.push_back(static_cast<std::uint32_t>(level.nodes.size()));
+            Simplify({nodes.data(), nodes.data() + nodes.size()}, Tolerance(band), shared, kept);
+            // Douglas-Peucker keeps a subset of a lower tolerance's nodes, so equal sizes mean equal lists.
+            const bool inherited = kept.size() == Nodes(band - 1, w).size();
+            level.inherited.push_back(inherited);
+            if (!inherited)
+                level.nodes.insert(level.nodes.end(), kept.begin(), kept.end());
+        }
+        level.offsets.push_back(static_cast<std::uint32_t>(level.nodes.size()));
+        level.nodes.shrink_to_fit();
+        m_Levels.push_back(std::move(level));
+    }
+}
+
+double GeometryLod::Tolerance(int band) const noexcept
+{
+    return band <= 0 ? 0. : m_BaseTolerance * std::pow(4., band - 1);
+}
+
+int GeometryLod::Band(double tolerance) const noexcept
+{
+    int band = 0;
+    while (band + 1 < Bands() && Tolerance(band + 1) <= tolerance)
+        ++band;
+    return band;
+}
+
+GeometryLod::NodeRange GeometryLod::Nodes(int band, int way) const noexcept
+{
+    band = std::min(band, Bands() - 1);
+    while (band > 0 && m_Levels[band - 1].inherited[way])
+        --band;
+    if (band <= 0) {
+        const auto &nodes = m_Model.Ways()[way].nodes;
+        return {nodes.data(), nodes.data() + nodes.size()};
+    }
+    const auto &level = m_Levels[band - 1];
+    return {level.nodes.data() + level.offsets[way], level.nodes.data() + level.offsets[way + 1]};
+}
+
+std::size_t GeometryLod::StoredNodes() const noexcept
+{
+    std::size_t total = 0;
+    for (const auto &level : m_Levels)
+        total += level.nodes.size();
+    return total;
+}
+
+void GeometryLod::Simplify(NodeRange nodes, double tolerance, const std::vector<bool> &shared, std::vector<int> &out) const
+{
+    out.clear();
+    const auto n = nodes.size();
+    if (n <= 2) {
+        out.assign(nodes.begin(), nodes.end());
+        return;
+    }
+    const auto *coords = m_Model.Nodes().data();
+    const auto *ids = nodes.begin();
+    auto at = [&](std::size_t i) -> const Model::Node & { return coords[ids[i]]; };
+
+    std::vector<bool> keep(n, false);
+    keep[0] = keep[n - 1] = true;
+    for (std::size_t i = 1; i + 1 < n; ++i)
+        keep[i] = shared[ids[i]];
+
+    // A closed ring keeps the node farthest from its start and the one farthest from that chord,
+    // so it never collapses below a triangle.
+    if (n >= 4 && nodes.front() == nodes.back()) {
+        std::size_t far = 1;
+        for (std::size_t i = 2; i + 1 < n; ++i)
+            if (SegmentDistance(at(i), at(0), at(0)) > SegmentDistance(at(far), at(0), at(0)))
+                far = i;
+        std::size_t apex = far == 1 ? 2 : 1;
+        for (std::size_t i = 1; i + 1 < n; ++i)
+            if (i != far && SegmentDistance(at(i), at(0), at(far)) > SegmentDistance(at(apex), at(0), at(far)))
+                apex = i;
+        keep[far] = keep[apex] = true;
+    }
+
+    // Douglas-Peucker between consecutive kept nodes.
+    std::vector<std::pair<std::size_t, std::size_t>> stack;
+    for (std::size_t a = 0, b = 1; b < n; ++b)
+        if (keep[b]) {
+            stack.emplace_back(a, b);
+            a = b;
+        }
+    while (!stack.empty()) {
+        const auto [a, b] = stack.back();
+        stack.pop_back();
+        std::size_t farthest = a;
+        double max_distance = tolerance;
+        for (std::size_t i = a + 1; i < b; ++i)
+            if (const auto d = SegmentDistance(at(i), at(a), at(b)); d > max_distance) {
+                max_distance = d;
+                farthest = i;
+            }
+        if (farthest != a) {
+            keep[farthest] = true;
+            stack.emplace_back(a, farthest);
+            stack.emplace_back(farthest, b);
+        }
+    }
+
+    for (std::size_t i = 0; i < n; ++i)
+        if (keep[i])
+            out.push_back(ids[i]);
+}
+
+bool GeometryLod::IsCounterclockwise(NodeRange ring) const noexcept
+{
+    // Shoelace formula: twice the signed area, positive for counterclockwise rings.
+    const auto nodes = m_Model.Nodes().data();
+    double area = 0.;
+    for (auto it = ring.begin(); it != ring.end(); ++it) {
+        auto &a = nodes[*it], &b = nodes[it + 1 != ring.end() ? it[1] : ring.front()];
+        area += a.x * b.y - b.x * a.y;
+    }
+    return area >= 0.;
+}
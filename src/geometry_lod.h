@@ -0,0 +1,144 @@
+/**
+ * @file geometry_lod.h
+ * @brief Precomputed simplified way geometry per zoom band
+ *
+ * This file contains GeometryLod, which simplifies every way of a Model with
+ * Douglas-Peucker at a series of tolerances. Render picks the coarsest band
+ * whose tolerance stays below half a pixel, so a city-wide view no longer
+ * feeds dozens of vertices per pixel to the rasterizer.
+ */
+
+#ifndef GEOMETRY_LOD_H
+#define GEOMETRY_LOD_H
+
+#include <cstdint>
+#include <vector>
+#include "model.h"
+
+/**
+ * @class GeometryLod
+ * @brief Simplified node lists of all ways, one set per zoom band
+ *
+ * Band 0 is the original geometry; band b > 0 is simplified with tolerance
+ * Tolerance(1) * 4^(b-1) in normalized units. Simplification is
+ * topology-safe in the sense the renderer needs: way endpoints and nodes
+ * shared by several ways (junctions, ring seams) are always kept, so roads
+ * stay connected, and closed rings keep at least four nodes.
+ *
+ * Each band is stored as one CSR array of node indices; a way whose node list
+ * does not shrink in a band reuses the previous band's nodes instead of
+ * storing a copy.
+ */
+class GeometryLod {
+  public:
+    /**
+     * @struct NodeRange
+     * @brief A way's node indices in one band
+     */
+    struct NodeRange {
+        const int *first = nullptr;  ///< First node index
+        const int *last = nullptr;   ///< One past the last node index
+
+        const int *begin() const noexcept { return first; }
+        const int *end() const noexcept { return last; }
+        std::size_t size() const noexcept { return static_cast<std::size_t>(last - first); }
+        bool empty() const noexcept { return first == last; }
+        int front() const noexcept { return *first; }
+        int back() const noexcept { return *(last - 1); }
+    };
+
+    /**
+     * @brief Simplifies every way of a model
+     * @param model The model whose ways are simplified; must outlive this object
+     * @param bands Number of bands including the original geometry
+     * @param base_tolerance Tolerance of band 1 in normalized units
+     */
+    explicit GeometryLod(const Model &model, int bands = 6, double base_tolerance = 1e-4);
+
+    /**
+     * @brief Returns the number of bands including band 0
+     */
+    int Bands() const noexcept { return static_cast<int>(m_Levels.size()) + 1; }
+
+    /**
+     * @brief Returns the simplification tolerance of a band in normalized units
+     */
+    double Tolerance(int band) const noexcept;
+
+    /**
+     * @brief Returns the coarsest band whose tolerance does not exceed a limit
+     * @param tolerance Largest acceptable deviation in normalized units
+     */
+    int Band(double tolerance) const noexcept;
+
+    /**
+     * @brief Returns the nodes of a way in a band
+     * @param band The band, 0 for the original geometry
+     * @param way Index of the way in Model::Ways()
+     */
+    NodeRange Nodes(int band, int way) const noexcept;
+
+    /**
+     * @brief Returns true if a ring runs counterclockwise in normalized coordinates
+     *
+     * Rings with zero area count as counterclockwise.
+     */
+    bool IsCounterclockwise(NodeRange ring) const noexcept;
+
+    /**
+     * @brief Visits the nodes of a closed way in a band in a given orientation
+     * @param band The band, 0 for the original geometry
+     * @param way Index of the way in Model::Ways()
+     * @param counterclockwise The orientation to visit the ring in
+     * @param visit Called with each node index of the way, first to last or last to first
+     *
+     * Renderers fill merged polygons with the nonzero rule; visiting outer
+     * rings counterclockwise and holes clockwise makes that fill their union
+     * regardless of how the data orients them.
+     */
+    template <typename Visit>
+    void VisitRing(int band, int way, bool counterclockwise, Visit visit) const {
+        const auto ring = Nodes(band, way);
+        if (ring.empty())
+            return;
+        if (IsCounterclockwise(ring) == counterclockwise)
+            for (auto n : ring)
+                visit(n);
+        else
+            for (auto it = ring.end(); it != ring.begin();)
+                visit(*--it);
+    }
+
+    /**
+     * @brief Returns the number of node indices stored for all bands above 0
+     */
+    std::size_t StoredNodes() const noexcept;
+
+  private:
+    /**
+     * @struct Level
+     * @brief Simplified ways of one band in CSR form
+     *
+     * Ways that did not shrink point into the previous band's storage.
+     */
+    struct Level {
+        std::vector<std::uint32_t> offsets;  ///< Start of each way's nodes, plus one past the end
+        std::vector<std::uint8_t> inherited; ///< 1 if the way's nodes are those of the previous band
+        std::vector<int> nodes;              ///< Node indices of the ways that shrank
+    };
+
+    /**
+     * @brief Simplifies one way
+     * @param nodes The way's original nodes
+     * @param tolerance Largest allowed deviation
+     * @param shared Per model node, true if the node is an endpoint or used by several ways
+     * @param out Receives the kept node indices
+     */
+    void Simplify(NodeRange nodes, double tolerance, const std::vector<bool> &shared, std::vector<int> &out) const;
+
+    const Model &m_Model;        ///< Source geometry
+    double m_BaseTolerance;      ///< Tolerance of band 1
+    std::vector<Level> m_Levels; ///< Bands 1 and above
+};
+
+#endif
@@ -0,0 +1,418 @@
+/**
+ * @file graph_planner.h
+ * @brief A* search over the structure-of-arrays RouteGraph
+ *
+ * This file contains BasicSearchSpace, the per-node search state kept in parallel
+ * arrays, and BasicGraphPlanner, a policy-based A* planner that runs on a
+ * RouteGraph. Unlike RoutePlanner it never mutates the model, so one graph can
+ * serve any number of planners and queries.
+ */
+
+#ifndef GRAPH_PLANNER_H
+#define GRAPH_PLANNER_H
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include "route_graph.h"
+#include "planner_policies.h"
+#include "search_stats.h"
+#include "search_trace.h"
+#include "segment_index.h"
+
+/**
+ * @struct GraphPath
+ * @brief Result of a graph search
+ */
+struct GraphPath {
+    std::vector<int> nodes;   ///< Graph node ids from source to target, empty if unreachable
+    float distance = 0.f;     ///< Path length in meters
+    bool found = false;       ///< True if a path exists; a snapped route within one segment has no nodes
+};
+
+/**
+ * @enum SearchStatus
+ * @brief State of a resumable graph search
+ */
+enum class SearchStatus { Running, Found, Unreachable };
+
+/**
+ * @class BasicSearchSpace
+ * @brief Per-query node state as parallel arrays (g[], parent[], stamp[])
+ * @tparam Value The distance type stored in g[]
+ *
+ * Each array is indexed by graph node id. Instead of clearing the arrays
+ * between queries, every query gets a new generation number and a node's g and
+ * parent are only valid while its stamp belongs to the current generation.
+ */
+template <typename Value>
+class BasicSearchSpace {
+  public:
+    /**
+     * @brief Sizes the arrays for a graph with n nodes
+     */
+    void Resize(int n) {
+        m_G.assign(n, Value{});
+        m_Parent.assign(n, -1);
+        m_Stamp.assign(n, 0);
+        m_Generation = 0;
+    }
+
+    /**
+     * @brief Invalidates the state of the previous query in O(1)
+     */
+    void NewQuery() {
+        if (++m_Generation >= kMaxGeneration) {
+            std::fill(m_Stamp.begin(), m_Stamp.end(), 0);
+            m_Generation = 1;
+        }
+    }
+
+    /**
+     * @brief Returns true if the node has a g value in this query
+     */
+    bool Reached(int v) const noexcept { return m_Stamp[v] >= 2 * m_Generation; }
+
+    /**
+     * @brief Returns true if the node has been expanded in this query
+     */
+    bool Settled(int v) const noexcept { return m_Stamp[v] == 2 * m_Generation + 1; }
+
+    /**
+     * @brief Records a (better) tentative distance and parent for a node
+     */
+    void Reach(int v, Value g, int parent) noexcept {
+        m_G[v] = g;
+        m_Parent[v] = parent;
+        m_Stamp[v] = 2 * m_Generation;
+    }
+
+    /**
+     * @brief Marks a node as expanded; its g value is final
+     */
+    void Settle(int v) noexcept { m_Stamp[v] = 2 * m_Generation + 1; }
+
+    Value G(int v) const noexcept { return m_G[v]; }
+    int Parent(int v) const noexcept { return m_Parent[v]; }
+
+  private:
+    static constexpr std::uint32_t kMaxGeneration = std::numeric_limits<std::uint32_t>::max() / 2 - 1;
+
+    std::vector<Value> m_G;              ///< Tentative distance from the source
+    std::vector<int> m_Parent;           ///< Predecessor on the best known path
+    std::vector<std::uint32_t> m_Stamp;  ///< 2 * generation (reached) or 2 * generation + 1 (settled)
+    std::uint32_t m_Generation = 0;      ///< Current query number
+};
+
+using SearchSpace = BasicSearchSpace<float>;
+
+/**
+ * @class BasicGraphPlanner
+ * @brief A* planner over a RouteGraph
+ * @tparam Heuristic Distance metric used as the h value; must match the metric the graph was built with
+ * @tparam Queue Open-list template, instantiated as Queue<int, Costs::Value>
+ * @tparam Termination Predicate deciding when the search loop ends
+ * @tparam Costs Cost representation, FloatCosts or IntegerCosts
+ * @tparam Pruning Rule skipping nodes that cannot lie on the shortest path
+ *
+ * The planner owns its SearchSpace and open list and reuses them across
+ * queries, so one planner should be kept per thread.
+ */
+template <typename Heuristic = EuclideanDistance,
+          template <typename, typename> class Queue = BinaryHeapQueue,
+          typename Termination = StopAtGoal,
+          typename Costs = FloatCosts,
+          typename Pruning = NoPruning>
+class BasicGraphPlanner {
+    using Value = typename Costs::Value;
+
+  public:
+    /**
+     * @brief Constructs a planner for the given graph
+     * @param graph The graph to search; must outlive the planner
+     * @param pruning The pruning rule, e.g. a ReachPruning over precomputed bounds
+     */
+    explicit BasicGraphPlanner(const RouteGraph &graph, Pruning pruning = Pruning{})
+        : m_Graph(graph), m_Heuristic(graph.Source()), m_Prune(std::move(pruning)) {
+        // One extra slot for the virtual target of snapped searches.
+        m_Space.Resize(graph.NumNodes() + 1);
+    }
+
+    /**
+     * @brief Finds the shortest path between two graph nodes
+     * @param source The start node id
+     * @param target The goal node id
+     * @return The path, with empty nodes if the target is unreachable
+     */
+    GraphPath Search(int source, int target) {
+        Start(source, target);
+        while (Step() == SearchStatus::Running) {}
+        return std::move(m_Result);
+    }
+
+    /**
+     * @brief Prepares a resumable search between two graph nodes
+     * @param source The start node id
+     * @param target The goal node id
+     *
+     * Call Step() until it stops returning SearchStatus::Running, then read
+     * the path with Result().
+     */
+    void Start(int source, int target) {
+        Reset(target);
+        if (source < 0 || target < 0)
+            return;
+
+        m_TargetX = m_Graph.X(target);
+        m_TargetY = m_Graph.Y(target);
+        m_Space.Reach(source, Value{}, -1);
+        m_Open.push(source, Bound(source));
+        m_Stats.Push(m_Open.size());
+    }
+
+    /**
+     * @brief Prepares a resumable search between two positions snapped onto road segments
+     * @param from The start position, e.g. from SegmentIndex::Snap()
+     * @param to The goal position
+     *
+     * The search starts from a virtual node at the projected start point,
+     * connected to both segment ends by the partial edge costs, and ends at
+     * a virtual node at the projected goal point. Result() lists the graph
+     * nodes between the two points; its distance includes both partial edges.
+     */
+    void Start(const EdgeSnap &from, const EdgeSnap &to) {
+        Reset(m_Graph.NumNodes());
+        if (from.u < 0 || to.u < 0)
+            return;
+
+        m_TargetX = to.x;
+        m_TargetY = to.y;
+        m_ToU = to.u;
+        m_ToV = to.v;
+        m_ToCostU = Costs::Partial(m_Graph, to.edge, to.t);
+        m_ToCostV = Costs::Partial(m_Graph, to.edge, 1.f - to.t);
+        // Pruning reasons about paths between graph nodes; the partial edges are not part of them.
+        m_PruneFromSlack = Costs::Meters(m_Graph, Costs::Partial(m_Graph, from.edge, std::max(from.t, 1.f - from.t)));
+        m_PruneToSlack = Costs::Meters(m_Graph, std::max(m_ToCostU, m_ToCostV));
+        Seed(from.u, Costs::Partial(m_Graph, from.edge, from.t));
+        Seed(from.v, Costs::Partial(m_Graph, from.edge, 1.f - from.t));
+
+        // Both points on the same segment: the direct stretch is a candidate too.
+        const bool same = from.u == to.u && from.v == to.v;
+        const bool reversed = from.u == to.v && from.v == to.u;
+        if (same || reversed) {
+            const float to_t = same ? to.t : 1.f - to.t;
+            const Value direct = Costs::Partial(m_Graph, from.edge, std::abs(from.t - to_t));
+            m_Space.Reach(m_Target, direct, -1);
+            m_Open.push(m_Target, direct);
+            m_Stats.Push(m_Open.size());
+        }
+    }
+
+    /**
+     * @brief Continues the search started by Start()
+     * @param max_expansions Maximum number of nodes to expand in this call
+     * @return Running if the budget ran out first, otherwise the final status
+     */
+    SearchStatus Step(std::size_t max_expansions = std::numeric_limits<std::size_t>::max()) {
+        StatsTimer timer{m_Stats.search_seconds};
+        for (std::size_t budget = 0; !m_Open.empty(); ) {
+            if (budget == max_expansions)
+                return SearchStatus::Running;
+            const int v = m_Open.pop().second;
+            m_Stats.Pop();
+            if (m_Space.Settled(v))
+                continue;
+            m_Space.Settle(v);
+            m_Stats.Expand();
+            if (m_Trace && v < m_Graph.NumNodes())
+                m_Trace->Record(v, m_Graph.X(v), m_Graph.Y(v));
+            ++budget;
+            if (m_Terminate(v, m_Target, ++m_Expansions)) {
+                if (v != m_Target)
+                    break;
+                timer.Stop();
+                ConstructPath(v);
+                return SearchStatus::Found;
+            }
+
+            const Value g_v = m_Space.G(v);
+            m_Stats.Scan(m_Graph.FirstOut(v + 1) - m_Graph.FirstOut(v));
+            for (auto e = m_Graph.FirstOut(v), end = m_Graph.FirstOut(v + 1); e < end; ++e) {
+                const int w = m_Graph.Head(e);
+                if (m_Space.Settled(w))
+                    continue;
+                const Value g_w = g_v + Costs::Weight(m_Graph, e);
+                if (!m_Space.Reached(w) || g_w < m_Space.G(w)) {
+                    // v is settled, so g_w is exact whenever v precedes w on a shortest path.
+                    const Value h_w = Bound(w);
+                    if (m_Prune(w, Costs::Meters(m_Graph, g_w) - m_PruneFromSlack,
+                                Costs::Meters(m_Graph, h_w) - m_PruneToSlack))
+                        continue;
+                    m_Space.Reach(w, g_w, v);
+                    m_Open.push(w, g_w + h_w);
+                    m_Stats.Push(m_Open.size());
+                }
+            }
+            if (v == m_ToU || v == m_ToV)
+                RelaxTarget(v, g_v + (v == m_ToU ? m_ToCostU : m_ToCostV));
+        }
+        m_Open.clear();
+        return SearchStatus::Unreachable;
+    }
+
+    /**
+     * @brief Returns the path found by a search driven with Start() and Step()
+     */
+    const GraphPath &Result() const noexcept { return m_Result; }
+
+    /**
+     * @brief Finds the shortest path between the nodes closest to two positions
+     * @param start_x Starting x-coordinate (normalized longitude)
+     * @param start_y Starting y-coordinate (normalized latitude)
+     * @param end_x Ending x-coordinate (normalized longitude)
+     * @param end_y Ending y-coordinate (normalized latitude)
+     */
+    GraphPath Search(float start_x, float start_y, float end_x, float end_y) {
+        double snap_seconds = 0.;
+        StatsTimer timer{snap_seconds};
+        const int source = m_Graph.ClosestNode(start_x, start_y);
+        const int target = m_Graph.ClosestNode(end_x, end_y);
+        timer.Stop();
+        auto path = Search(source, target);
+        m_Stats.snap_seconds = snap_seconds;
+        return path;
+    }
+
+    /**
+     * @brief Finds the shortest path between two positions snapped onto road segments
+     * @param from The start position
+     * @param to The goal position
+     */
+    GraphPath Search(const EdgeSnap &from, const EdgeSnap &to) {
+        Start(from, to);
+        while (Step() == SearchStatus::Running) {}
+        return std::move(m_Result);
+    }
+
+    /**
+     * @brief Returns the number of nodes expanded by the last query
+     */
+    std::size_t Expansions() const noexcept { return m_Expansions; }
+
+    /**
+     * @brief Returns the search state of the last query
+     */
+    const BasicSearchSpace<Value> &Space() const noexcept { return m_Space; }
+
+    /**
+     * @brief Returns the statistics of the last query (zero unless ROUTE_PLANNER_ENABLE_STATS)
+     */
+    const SearchStats &Stats() const noexcept { return m_Stats; }
+
+    /**
+     * @brief Records the nodes expanded by later queries
+     * @param trace Cleared by every Start() and filled by Step(); nullptr stops recording.
+     *              Must outlive the planner or be detached first.
+     *
+     * The virtual goal of a snapped search is not recorded.
+     */
+    void SetTrace(SearchTrace *trace) noexcept { m_Trace = trace; }
+
+  private:
+    /**
+     * @brief Clears the state of the previous query
+     */
+    void Reset(int target) {
+        // Keep the node buffer's capacity; Search() moves it out, Result() readers don't.
+        m_Result.nodes.clear();
+        m_Result.distance = 0.f;
+        m_Result.found = false;
+        m_Space.NewQuery();
+        m_Open.clear();
+        m_Expansions = 0;
+        m_Stats = SearchStats{};
+        if (m_Trace)
+            m_Trace->Clear();
+        m_Target = target;
+        m_ToU = m_ToV = -1;
+        m_PruneFromSlack = m_PruneToSlack = 0.;
+    }
+
+    /**
+     * @brief Reaches a start node of a snapped search through its partial edge
+     */
+    void Seed(int v, Value g) {
+        if (!m_Space.Reached(v) || g < m_Space.G(v)) {
+            m_Space.Reach(v, g, -1);
+            m_Open.push(v, g + Bound(v));
+            m_Stats.Push(m_Open.size());
+        }
+    }
+
+    /**
+     * @brief Relaxes the partial edge from a goal segment end to the virtual target
+     */
+    void RelaxTarget(int v, Value g) {
+        if (!m_Space.Reached(m_Target) || g < m_Space.G(m_Target)) {
+            m_Space.Reach(m_Target, g, v);
+            m_Open.push(m_Target, g);
+            m_Stats.Push(m_Open.size());
+        }
+    }
+
+    /**
+     * @brief Returns the heuristic value of a node in the cost representation
+     */
+    Value Bound(int v) const {
+        return Costs::Bound(m_Graph, m_Heuristic(m_Graph.X(v), m_Graph.Y(v), m_TargetX, m_TargetY));
+    }
+
+    /**
+     * @brief Follows the parent array back from the target
+     */
+    void ConstructPath(int target) {
+        StatsTimer timer{m_Stats.reconstruction_seconds};
+        for (int v = target; v != -1; v = m_Space.Parent(v))
+            if (v < m_Graph.NumNodes())
+                m_Result.nodes.push_back(v);
+        std::reverse(m_Result.nodes.begin(), m_Result.nodes.end());
+        m_Result.distance = static_cast<float>(Costs::Meters(m_Graph, m_Space.G(target)));
+        m_Result.found = true;
+    }
+
+    const RouteGraph &m_Graph;        ///< Graph being searched
+    Heuristic m_Heuristic;            ///< Heuristic metric policy
+    Termination m_Terminate;          ///< Termination policy
+    Pruning m_Prune;                  ///< Pruning policy
+    BasicSearchSpace<Value> m_Space;  ///< Per-node search state
+    Queue<int, Value> m_Open;         ///< Open list of node ids keyed by f = g + h
+    std::size_t m_Expansions = 0;     ///< Nodes expanded by the last query
+    int m_Target = -1;                ///< Goal node of the current query
+    float m_TargetX = 0.f;            ///< Goal x-coordinate
+    float m_TargetY = 0.f;            ///< Goal y-coordinate
+    int m_ToU = -1;                   ///< Goal segment start of a snapped search, else -1
+    int m_ToV = -1;                   ///< Goal segment end of a snapped search, else -1
+    Value m_ToCostU{};                ///< Partial cost from m_ToU to the goal point
+    Value m_ToCostV{};                ///< Partial cost from m_ToV to the goal point
+    double m_PruneFromSlack = 0.;     ///< Longest start partial edge of a snapped search in meters, else 0
+    double m_PruneToSlack = 0.;       ///< Longest goal partial edge of a snapped search in meters, else 0
+    GraphPath m_Result;               ///< Path of the last completed query
+    SearchStats m_Stats;              ///< Statistics of the last query
+    SearchTrace *m_Trace = nullptr;   ///< Receives the expanded nodes, if set
+};
+
+/**
+ * @brief The default graph planner: Euclidean heuristic, binary-heap open list
+ */
+using GraphPlanner = BasicGraphPlanner<>;
+
+/**
+ * @brief Graph planner on integer costs with a radix-heap open list
+ */
+using RadixGraphPlanner = BasicGraphPlanner<EuclideanDistance, RadixHeapQueue, StopAtGoal, IntegerCosts>;
+
+#endif
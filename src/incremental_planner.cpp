@@ -0,0 +1,196 @@
+#include "incremental_planner.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+struct Greater {
+    template <typename Entry>
+    bool operator()(const Entry &a, const Entry &b) const { return b.first < a.first; }
+};
+
+float Distance(const RouteGraph &graph, int a, int b)
+{
+    const auto dx = graph.X(a) - graph.X(b);
+    const auto dy = graph.Y(a) - graph.Y(b);
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+}  // namespace
+
+IncrementalPlanner::IncrementalPlanner(const RouteGraph &graph) : m_Graph(graph)
+{
+    const int n = graph.NumNodes();
+    m_Cost.resize(graph.NumEdges());
+    m_Twin.resize(graph.NumEdges());
+    for (int u = 0; u < n; ++u)
+        for (auto e = graph.FirstOut(u); e < graph.FirstOut(u + 1); ++e) {
+            m_Cost[e] = graph.Weight(e);
+            // Every edge is stored in both directions, so the twin always exists.
+            const int w = graph.Head(e);
+            for (auto f = graph.FirstOut(w); f < graph.FirstOut(w + 1); ++f)
+                if (graph.Head(f) == u) {
+                    m_Twin[e] = f;
+                    break;
+                }
+        }
+    m_G.resize(n);
+    m_Rhs.resize(n);
+    m_QueuedKey.resize(n);
+    m_InQueue.resize(n);
+}
+
+void IncrementalPlanner::Start(int source, int target)
+{
+    std::fill(m_G.begin(), m_G.end(), kInfinity);
+    std::fill(m_Rhs.begin(), m_Rhs.end(), kInfinity);
+    std::fill(m_InQueue.begin(), m_InQueue.end(), 0);
+    m_Open.clear();
+    m_Source = m_LastSource = source;
+    m_Target = target;
+    m_Km = 0.f;
+    m_Expansions = 0;
+    if (source < 0 || target < 0)
+        return;
+
+    m_Rhs[target] = 0.f;
+    Push(target);
+}
+
+void IncrementalPlanner::MoveStart(int source)
+{
+    if (m_Target < 0 || source < 0)
+        return;
+    // Keys already queued were computed from the old start; raising km by the
+    // distance moved keeps them valid lower bounds instead of reordering the heap.
+    m_Km += Distance(m_Graph, m_LastSource, source);
+    m_Source = m_LastSource = source;
+}
+
+void IncrementalPlanner::SetEdgeCost(std::uint32_t e, float cost)
+{
+    if (m_Cost[e] == cost)
+        return;
+    m_Cost[e] = cost;
+    if (m_Target >= 0)
+        UpdateVertex(m_Graph.Head(m_Twin[e]));
+}
+
+std::int64_t IncrementalPlanner::FindEdge(int u, int v) const noexcept
+{
+    for (auto e = m_Graph.FirstOut(u); e < m_Graph.FirstOut(u + 1); ++e)
+        if (m_Graph.Head(e) == v)
+            return e;
+    return -1;
+}
+
+GraphPath IncrementalPlanner::Plan()
+{
+    m_Expansions = 0;
+    if (m_Source < 0 || m_Target < 0)
+        return GraphPath{};
+    ComputeShortestPath();
+    return ExtractPath();
+}
+
+IncrementalPlanner::Key IncrementalPlanner::CalculateKey(int v) const
+{
+    const auto k = std::min(m_G[v], m_Rhs[v]);
+    return Key{k + Heuristic(v) + m_Km, k};
+}
+
+float IncrementalPlanner::Heuristic(int v) const
+{
+    return Distance(m_Graph, m_Source, v);
+}
+
+void IncrementalPlanner::Push(int v)
+{
+    m_QueuedKey[v] = CalculateKey(v);
+    m_InQueue[v] = 1;
+    m_Open.emplace_back(m_QueuedKey[v], v);
+    std::push_heap(m_Open.begin(), m_Open.end(), Greater{});
+}
+
+void IncrementalPlanner::UpdateVertex(int v)
+{
+    if (v != m_Target) {
+        auto rhs = kInfinity;
+        for (auto e = m_Graph.FirstOut(v); e < m_Graph.FirstOut(v + 1); ++e)
+            rhs = std::min(rhs, m_Cost[e] + m_G[m_Graph.Head(e)]);
+        m_Rhs[v] = rhs;
+    }
+    if (m_G[v] != m_Rhs[v])
+        Push(v);
+    else
+        m_InQueue[v] = 0;
+}
+
+void IncrementalPlanner::ComputeShortestPath()
+{
+    for (;;) {
+        // Drop entries of nodes that were removed or re-keyed since they were pushed.
+        while (!m_Open.empty() && (!m_InQueue[m_Open.front().second] ||
+                                   !(m_QueuedKey[m_Open.front().second] == m_Open.front().first))) {
+            std::pop_heap(m_Open.begin(), m_Open.end(), Greater{});
+            m_Open.pop_back();
+        }
+        if (m_Open.empty())
+            return;
+        const auto [old_key, u] = m_Open.front();
+        if (!(old_key < CalculateKey(m_Source)) && m_Rhs[m_Source] <= m_G[m_Source])
+            return;
+
+        std::pop_heap(m_Open.begin(), m_Open.end(), Greater{});
+        m_Open.pop_back();
+        m_InQueue[u] = 0;
+        ++m_Expansions;
+
+        if (old_key < CalculateKey(u)) {
+            Push(u);
+        } else if (m_G[u] > m_Rhs[u]) {
+            m_G[u] = m_Rhs[u];
+            for (auto e = m_Graph.FirstOut(u); e < m_Graph.FirstOut(u + 1); ++e)
+                UpdateVertex(m_Graph.Head(e));
+        } else {
+            m_G[u] = kInfinity;
+            UpdateVertex(u);
+            for (auto e = m_Graph.FirstOut(u); e < m_Graph.FirstOut(u + 1); ++e)
+                UpdateVertex(m_Graph.Head(e));
+        }
+    }
+}
+
+GraphPath IncrementalPlanner::ExtractPath() const
+{
+    GraphPath path;
+    // The search may stop with the start itself still queued; its rhs is final.
+    if (m_Rhs[m_Source] == kInfinity)
+        return path;
+
+    // Walk down the g gradient; the bound guards against ties forming a cycle.
+    double distance = 0.;
+    int v = m_Source;
+    path.nodes.push_back(v);
+    for (int steps = 0; v != m_Target; ++steps) {
+        if (steps == m_Graph.NumNodes())
+            return GraphPath{};
+        auto best = kInfinity;
+        std::uint32_t best_edge = 0;
+        for (auto e = m_Graph.FirstOut(v); e < m_Graph.FirstOut(v + 1); ++e) {
+            const auto through = m_Cost[e] + m_G[m_Graph.Head(e)];
+            if (through < best) {
+                best = through;
+                best_edge = e;
+            }
+        }
+        if (best == kInfinity)
+            return GraphPath{};
+        distance += m_Cost[best_edge];
+        v = m_Graph.Head(best_edge);
+        path.nodes.push_back(v);
+    }
+    path.distance = static_cast<float>(distance * m_Graph.MetricScale());
+    path.found = true;
+    return path;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file incremental_planner.h
+ * @brief Incremental re-routing with D* Lite
+ *
+ * This file contains the IncrementalPlanner class, which keeps its search
+ * state between queries on the same goal. When edge costs change (a road
+ * closes, traffic slows a segment) or the start moves along the route, only
+ * the part of the search tree affected by the change is repaired.
+ */
+
+#ifndef INCREMENTAL_PLANNER_H
+#define INCREMENTAL_PLANNER_H
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "graph_planner.h"
+#include "route_graph.h"
+
+/**
+ * @class IncrementalPlanner
+ * @brief D* Lite planner over a RouteGraph with mutable edge costs
+ *
+ * The search runs backwards from the goal, so g(v) is the distance from v to
+ * the goal and the start can move without invalidating the tree. The planner
+ * keeps its own copy of the edge costs; the graph itself is never modified.
+ * Costs must not drop below the Euclidean length of the edge, otherwise the
+ * heuristic is no longer admissible.
+ *
+ * Typical use: Start(), Plan(), then any number of SetEdgeCost() /
+ * MoveStart() calls each followed by Plan().
+ */
+class IncrementalPlanner {
+  public:
+    static constexpr float kInfinity = std::numeric_limits<float>::infinity();  ///< Cost of a closed edge
+
+    /**
+     * @brief Constructs a planner for the given graph
+     * @param graph The graph to search; must outlive the planner
+     */
+    explicit IncrementalPlanner(const RouteGraph &graph);
+
+    /**
+     * @brief Starts a new query, discarding the previous search tree
+     * @param source The start node id
+     * @param target The goal node id
+     *
+     * Edge costs set earlier are kept.
+     */
+    void Start(int source, int target);
+
+    /**
+     * @brief Moves the start of the current query, e.g. as the vehicle advances
+     * @param source The new start node id
+     */
+    void MoveStart(int source);
+
+    /**
+     * @brief Changes the cost of a directed edge
+     * @param e The edge id
+     * @param cost The new cost in normalized map units, or kInfinity to close the edge
+     */
+    void SetEdgeCost(std::uint32_t e, float cost);
+
+    /**
+     * @brief Returns the current cost of a directed edge
+     */
+    float EdgeCost(std::uint32_t e) const noexcept { return m_Cost[e]; }
+
+    /**
+     * @brief Returns the edge from u to v, or -1 if the nodes are not adjacent
+     */
+    std::int64_t FindEdge(int u, int v) const noexcept;
+
+    /**
+     * @brief Repairs the search tree and returns the shortest path from the start
+     * @return The path, with empty nodes if the goal is unreachable
+     */
+    GraphPath Plan();
+
+    /**
+     * @brief Returns the number of nodes expanded by the last Plan()
+     */
+    std::size_t Expansions() const noexcept { return m_Expansions; }
+
+  private:
+    /**
+     * @struct Key
+     * @brief D* Lite priority: [min(g, rhs) + h + km, min(g, rhs)], compared lexicographically
+     */
+    struct Key {
+        float primary;
+        float secondary;
+        bool operator<(const Key &other) const noexcept {
+            return primary < other.primary || (primary == other.primary && secondary < other.secondary);
+        }
+        bool operator==(const Key &other) const noexcept {
+            return primary == other.primary && secondary == other.secondary;
+        }
+    };
+
+    Key CalculateKey(int v) const;
+    float Heuristic(int v) const;
+    void UpdateVertex(int v);
+    void Push(int v);
+    void ComputeShortestPath();
+    GraphPath ExtractPath() const;
+
+    const RouteGraph &m_Graph;            ///< Graph being searched
+    std::vector<float> m_Cost;            ///< Current edge costs
+    std::vector<std::uint32_t> m_Twin;    ///< Reverse edge of every edge
+    std::vector<float> m_G;               ///< Distance to the goal
+    std::vector<float> m_Rhs;             ///< One-step lookahead distance to the goal
+    std::vector<Key> m_QueuedKey;         ///< Key of a node's live queue entry
+    std::vector<char> m_InQueue;          ///< 1 if the node has a live queue entry
+    std::vector<std::pair<Key, int>> m_Open;  ///< Binary min-heap with lazily removed entries
+    int m_Source = -1;                    ///< Current start node
+    int m_LastSource = -1;                ///< Start node when km was last updated
+    int m_Target = -1;                    ///< Goal node
+    float m_Km = 0.f;                     ///< Accumulated heuristic offset from start moves
+    std::size_t m_Expansions = 0;         ///< Nodes expanded by the last Plan()
+};
+
+#endif
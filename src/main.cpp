@@ -3,11 +3,15 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <utility>
 #include <cairo/cairo.h>
 #include "io2d.h"
 #include "route_model.h"
+#include "png_writer.h"
+#include "query_server.h"
 #include "render.h"
 #include "route_planner.h"
+#include "svg_writer.h"
 
 using namespace std::experimental;
 
@@ -31,24 +35,51 @@ static std::optional<std::vector<std::byte>> ReadFile(const std::string &path)
 int main(int argc, const char **argv)
 {    
     std::string osm_data_file = "";
+    std::optional<std::pair<double, double>> center;
+    double zoom = 1.;
+    bool tiled = false;
+    std::string svg_file;
+    bool trace_search = false;
+    bool serve_stdio = false;
+    std::string socket_path;
     if( argc > 1 ) {
         for( int i = 1; i < argc; ++i )
             if( std::string_view{argv[i]} == "-f" && ++i < argc )
                 osm_data_file = argv[i];
+            else if( std::string_view{argv[i]} == "--zoom" && ++i < argc )
+                zoom = std::stod(argv[i]);
+            else if( std::string_view{argv[i]} == "--tiled" )
+                tiled = true;
+            else if( std::string_view{argv[i]} == "--svg" && ++i < argc )
+                svg_file = argv[i];
+            else if( std::string_view{argv[i]} == "--trace" )
+                trace_search = true;
+            else if( std::string_view{argv[i]} == "--server" )
+                serve_stdio = true;
+            else if( std::string_view{argv[i]} == "--server-socket" && ++i < argc )
+                socket_path = argv[i];
+            else if( std::string_view{argv[i]} == "--center" && i + 2 < argc ) {
+                center = {std::stod(argv[i + 1]), std::stod(argv[i + 2])};
+                i += 2;
+            }
     }
     else {
         std::cout << "To specify a map file use the following format: " << std::endl;
-        std::cout << "Usage: [executable] [-f filename.osm]" << std::endl;
+        std::cout << "Usage: [executable] [-f filename.osm] [--zoom Z] [--center X Y] [--tiled] [--svg file.svg] [--trace] [--server | --server-socket PATH]" << std::endl;
         osm_data_file = "../map.osm";
     }
     
+    // In server mode stdout carries responses only.
+    const bool server_mode = serve_stdio || !socket_path.empty();
+    std::ostream &log = server_mode ? std::cerr : std::cout;
+
     std::vector<std::byte> osm_data;
  
     if( osm_data.empty() && !osm_data_file.empty() ) {
-        std::cout << "Reading OpenStreetMap data from the following file: " <<  osm_data_file << std::endl;
+        log << "Reading OpenStreetMap data from the following file: " <<  osm_data_file << std::endl;
         auto data = ReadFile(osm_data_file);
         if( !data )
-            std::cout << "Failed to read." << std::endl;
+            log << "Failed to read." << std::endl;
         else
             osm_data = std::move(*data);
     }
@@ -62,6 +93,21 @@ int main(int argc, const char **argv)
     // For testing:
     // RouteModel model{osm_data, 10, 10, 90, 90};
 
+    // Serve queries against the loaded model instead of planning one route.
+    if( server_mode ) {
+        QueryServer server{model};
+        if( !socket_path.empty() ) {
+            log << "Listening on " << socket_path << std::endl;
+            if( !server.ServeSocket(socket_path) ) {
+                log << "Failed to listen on " << socket_path << " (an existing file that isn't a socket is never replaced)" << std::endl;
+                return 1;
+            }
+        }
+        else
+            log << "Answered " << server.Serve(std::cin, std::cout) << " requests." << std::endl;
+        return 0;
+    }
+
    float start_x, start_y, end_x, end_y;
 
     // Step 2: Get user input for these values
@@ -71,22 +117,52 @@ int main(int argc, const char **argv)
     std::cout << "Enter end coordinates (x y): ";
     std::cin >> end_x >> end_y; // Read end coordinates
    RoutePlanner route_planner{model, start_x, start_y, end_x, end_y};
+    SearchTrace trace;
+    if( trace_search )
+        route_planner.SetTrace(&trace);
     route_planner.AStarSearch();
     std::cout << "Distance: " << route_planner.GetDistance() << " meters. \n";
     
-    // Create render object
+    // Create render object, showing where the search went if asked to
     Render render{model};
+    if( trace_search ) {
+        std::cout << "Expanded " << trace.Size() << " nodes." << std::endl;
+        render.ShowSearchTrace(&trace);
+    }
 
     // Create an image surface
     auto surface = io2d::image_surface{io2d::format::argb32, 400, 400};
     
-    // Render to the surface
-    render.Display(surface);
+    // Render to the surface, optionally zoomed in on a map position in [0, 1]
+    auto viewport = Viewport::Fit(surface.dimensions().x(), surface.dimensions().y());
+    if( center ) {
+        viewport.center_x = center->first;
+        viewport.center_y = center->second;
+    }
+    viewport.zoom = zoom;
+    if( tiled )
+        render.DisplayTiled(surface, viewport);
+    else
+        render.Display(surface, viewport);
 
-    // Save the surface to a PNG file
-    surface.save("map_routed.png", io2d::image_file_format::png);
-    
-    std::cout << "Route has been rendered to map_routed.png" << std::endl;
+    // Compress and save the PNG in the background while the SVG is written
+    AsyncPngWriter png_writer;
+    png_writer.Submit("map_routed.png", Render::ReadPixels(surface));
+
+    // Optionally write the same view as a vector map
+    if( !svg_file.empty() ) {
+        std::ofstream os{svg_file};
+        if( SvgWriter{model}.Write(os, viewport) )
+            std::cout << "Route has been rendered to " << svg_file << std::endl;
+        else
+            std::cout << "Failed to write " << svg_file << std::endl;
+    }
+
+    png_writer.Close();
+    if( png_writer.Written() == 1 )
+        std::cout << "Route has been rendered to map_routed.png" << std::endl;
+    else
+        std::cout << "Failed to write map_routed.png" << std::endl;
     
     return 0;
 }
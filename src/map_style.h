@@ -0,0 +1,137 @@
+/**
+ * @file map_style.h
+ * @brief Colors and line widths of the map layers
+ *
+ * This file contains the map's visual style without any graphics library
+ * types, so that Render (io2d) and SvgWriter (SVG text) draw the same map.
+ * Widths given in meters scale with the zoom; widths given in pixels don't.
+ */
+
+#ifndef MAP_STYLE_H
+#define MAP_STYLE_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "model.h"
+
+/**
+ * @struct MapColor
+ * @brief An opaque 8-bit RGB color
+ */
+struct MapColor {
+    std::uint8_t r = 0;  ///< Red component
+    std::uint8_t g = 0;  ///< Green component
+    std::uint8_t b = 0;  ///< Blue component
+};
+
+constexpr MapColor kBackgroundColor{238, 235, 227};       ///< Background fill
+
+constexpr MapColor kBuildingFillColor{208, 197, 190};     ///< Building fill
+constexpr MapColor kBuildingOutlineColor{181, 167, 154};  ///< Building outline
+constexpr float kBuildingOutlineWidth = 1.f;              ///< Building outline width in pixels
+
+constexpr MapColor kLeisureFillColor{189, 252, 193};      ///< Leisure area fill
+constexpr MapColor kLeisureOutlineColor{160, 248, 162};   ///< Leisure area outline
+constexpr float kLeisureOutlineWidth = 1.f;               ///< Leisure area outline width in pixels
+
+constexpr MapColor kWaterFillColor{155, 201, 215};        ///< Water body fill
+
+constexpr MapColor kRailwayStrokeColor{93, 93, 93};       ///< Railway outer line
+constexpr MapColor kRailwayDashColor{255, 255, 255};      ///< Railway dashes
+constexpr float kRailwayOuterWidth = 3.f;                 ///< Railway outer line width in meters
+constexpr float kRailwayInnerWidth = 2.f;                 ///< Railway dash width in meters
+constexpr float kRailwayDash = 3.f;                       ///< Length of railway dashes and gaps in pixels
+
+constexpr MapColor kRouteColor{255, 165, 0};              ///< Calculated route
+constexpr float kRouteWidth = 5.f;                        ///< Route width in pixels
+constexpr MapColor kStartColor{0, 128, 0};                ///< Start position marker
+constexpr MapColor kEndColor{255, 0, 0};                  ///< End position marker
+constexpr float kMarkerSize = 0.01f;                      ///< Marker edge length in normalized units
+
+/// Search heatmap colors from the first to the last expanded nodes
+constexpr std::array<MapColor, 8> kHeatmapColors{{
+    {49, 54, 149}, {69, 117, 180}, {116, 173, 209}, {171, 217, 233},
+    {254, 224, 144}, {253, 174, 97}, {244, 109, 67}, {215, 48, 39}}};
+constexpr float kHeatmapDotSize = 3.f;                    ///< Edge length of an expanded node's dot in pixels
+
+/**
+ * @brief Returns the width of a road type in meters; 0 draws a one-pixel line
+ */
+inline float RoadMetricWidth(Model::Road::Type type)
+{
+    switch( type ) {
+        case Model::Road::Motorway:     return 6.f;
+        case Model::Road::Trunk:        return 6.f;
+        case Model::Road::Primary:      return 5.f;
+        case Model::Road::Secondary:    return 5.f;
+        case Model::Road::Tertiary:     return 4.f;
+        case Model::Road::Residential:  return 2.5f;
+        case Model::Road::Unclassified: return 2.5f;
+        case Model::Road::Service:      return 1.f;
+        case Model::Road::Footway:      return 0.f;
+        default:                        return 1.f;
+    }
+}
+
+/**
+ * @brief Returns the widest road or railway line in meters
+ *
+ * Strokes reach half this width beyond a feature's bounding box, so culling
+ * widens the visible area by it.
+ */
+inline float WidestMetricWidth()
+{
+    float widest = kRailwayOuterWidth;
+    for( auto type = Model::Road::Unclassified; type <= Model::Road::Footway; type = Model::Road::Type(type + 1) )
+        widest = std::max(widest, RoadMetricWidth(type));
+    return widest;
+}
+
+/**
+ * @brief Returns the color of a road type
+ */
+inline MapColor RoadColor(Model::Road::Type type)
+{
+    switch( type) {
+        case Model::Road::Motorway:     return {226, 122, 143};
+        case Model::Road::Trunk:        return {245, 161, 136};
+        case Model::Road::Primary:      return {249, 207, 144};
+        case Model::Road::Secondary:    return {244, 251, 173};
+        case Model::Road::Tertiary:     return {244, 251, 173};
+        case Model::Road::Residential:  return {254, 254, 254};
+        case Model::Road::Service:      return {254, 254, 254};
+        case Model::Road::Footway:      return {241, 106, 96};
+        case Model::Road::Unclassified: return {254, 254, 254};
+        default:                        return {128, 128, 128};
+    }
+}
+
+/**
+ * @brief Returns the alternating dash and gap lengths of a road type in pixels, empty for a solid line
+ */
+inline std::vector<float> RoadDashes(Model::Road::Type type)
+{
+    return type == Model::Road::Footway ? std::vector<float>{1.f, 2.f} : std::vector<float>{};
+}
+
+/**
+ * @brief Returns the fill color of a land use type, or nullopt if the type isn't drawn
+ */
+inline std::optional<MapColor> LanduseColor(Model::Landuse::Type type)
+{
+    switch( type ) {
+        case Model::Landuse::Commercial:   return MapColor{233, 195, 196};
+        case Model::Landuse::Construction: return MapColor{187, 188, 165};
+        case Model::Landuse::Grass:        return MapColor{197, 236, 148};
+        case Model::Landuse::Forest:       return MapColor{158, 201, 141};
+        case Model::Landuse::Industrial:   return MapColor{223, 197, 220};
+        case Model::Landuse::Railway:      return MapColor{223, 197, 220};
+        case Model::Landuse::Residential:  return MapColor{209, 209, 209};
+        default:                           return std::nullopt;
+    }
+}
+
+#endif
@@ -193,6 +193,24 @@ void Model::AdjustCoordinates()
     }
 }
 
+double Model::Latitude(double y) const noexcept
+{
+    const auto pi = 3.14159265358979323846264338327950288;
+    const auto earth_radius = 6378137.;
+    const auto min_y = log(tan(m_MinLat * pi / 360. + pi/4)) / 2 * earth_radius;
+    const auto ym = y * m_MetricScale + min_y;
+    return (2. * atan(exp(2. * ym / earth_radius)) - pi/2) * 180. / pi;
+}
+
+double Model::Longitude(double x) const noexcept
+{
+    const auto pi = 3.14159265358979323846264338327950288;
+    const auto earth_radius = 6378137.;
+    const auto min_x = m_MinLon * pi / 360. * earth_radius;
+    const auto xm = x * m_MetricScale + min_x;
+    return 2. * xm / earth_radius * 180. / pi;
+}
+
 static bool TrackRec(const std::vector<int> &open_ways,
                      const Model::Way *ways,
                      std::vector<bool> &used,
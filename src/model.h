@@ -133,6 +133,20 @@ public:
      */
     auto MetricScale() const noexcept { return m_MetricScale; }    
     
+    /**
+     * @brief Converts a normalized y-coordinate back to latitude
+     * @param y The normalized y-coordinate
+     * @return The latitude in degrees
+     */
+    double Latitude(double y) const noexcept;
+    
+    /**
+     * @brief Converts a normalized x-coordinate back to longitude
+     * @param x The normalized x-coordinate
+     * @return The longitude in degrees
+     */
+    double Longitude(double x) const noexcept;
+    
     /**
      * @brief Returns all nodes in the model
      * @return Const reference to the vector of nodes
@@ -0,0 +1,398 @@
+/**
+ * @file planner_policies.h
+ * @brief Compile-time policies for the templated route planners
+ *
+ * This file contains the heuristic / edge-cost metrics, open-list queues,
+ * cost representations, termination criteria and pruning rules that parameterize
+ * BasicRoutePlanner and BasicGraphPlanner. Every policy is a
+ * plain value type with inline members, so a planner instantiation is fully
+ * resolved at compile time and no virtual call happens in the search loop.
+ */
+
+#ifndef PLANNER_POLICIES_H
+#define PLANNER_POLICIES_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "model.h"
+
+//--------------------------------//
+//   Distance metrics.
+//--------------------------------//
+
+/**
+ * @struct EuclideanDistance
+ * @brief Straight-line distance in normalized map units
+ *
+ * This is the metric the planner has always used: both the heuristic and the
+ * edge costs are Euclidean distances between normalized coordinates, and the
+ * final distance is converted to meters with Model::MetricScale().
+ */
+struct EuclideanDistance {
+    static constexpr std::string_view kName = "euclidean";  ///< Stable name keying cached artifacts
+
+    /**
+     * @brief Constructs the metric for the given model
+     */
+    explicit EuclideanDistance(const Model &) {}
+
+    /**
+     * @brief Returns the distance between two normalized positions
+     */
+    float operator()(double x1, double y1, double x2, double y2) const {
+        return std::sqrt(std::pow((x1 - x2), 2) + std::pow((y1 - y2), 2));
+    }
+};
+
+/**
+ * @struct EquirectangularDistance
+ * @brief Ground distance using the equirectangular approximation
+ *
+ * Converts both positions back to latitude/longitude and applies the
+ * equirectangular projection at their mean latitude. The result is expressed
+ * in normalized units (meters divided by Model::MetricScale()) so it can be
+ * mixed with the rest of the planner bookkeeping.
+ */
+struct EquirectangularDistance {
+    static constexpr std::string_view kName = "equirectangular";  ///< Stable name keying cached artifacts
+
+    /**
+     * @brief Constructs the metric for the given model
+     */
+    explicit EquirectangularDistance(const Model &model) : m_Model(&model), m_InvScale(1. / model.MetricScale()) {}
+
+    /**
+     * @brief Returns the distance between two normalized positions
+     */
+    float operator()(double x1, double y1, double x2, double y2) const {
+        const auto lat1 = m_Model->Latitude(y1) * kDegToRad;
+        const auto lat2 = m_Model->Latitude(y2) * kDegToRad;
+        const auto dlon = (m_Model->Longitude(x2) - m_Model->Longitude(x1)) * kDegToRad;
+        const auto px = dlon * std::cos((lat1 + lat2) / 2);
+        const auto py = lat2 - lat1;
+        return static_cast<float>(std::sqrt(px * px + py * py) * kEarthRadius * m_InvScale);
+    }
+
+  private:
+    static constexpr double kDegToRad = 3.14159265358979323846264338327950288 / 180.;
+    static constexpr double kEarthRadius = 6378137.;
+    const Model *m_Model;   ///< Model providing the inverse projection
+    double m_InvScale;      ///< Meters to normalized units
+};
+
+/**
+ * @struct HaversineDistance
+ * @brief Great-circle ground distance
+ *
+ * Same conventions as EquirectangularDistance, but exact on the sphere. It is
+ * a true metric, so using it both as heuristic and edge cost keeps A*
+ * consistent.
+ */
+struct HaversineDistance {
+    static constexpr std::string_view kName = "haversine";  ///< Stable name keying cached artifacts
+
+    /**
+     * @brief Constructs the metric for the given model
+     */
+    explicit HaversineDistance(const Model &model) : m_Model(&model), m_InvScale(1. / model.MetricScale()) {}
+
+    /**
+     * @brief Returns the distance between two normalized positions
+     */
+    float operator()(double x1, double y1, double x2, double y2) const {
+        const auto lat1 = m_Model->Latitude(y1) * kDegToRad;
+        const auto lat2 = m_Model->Latitude(y2) * kDegToRad;
+        const auto dlon = (m_Model->Longitude(x2) - m_Model->Longitude(x1)) * kDegToRad;
+        const auto s_lat = std::sin((lat2 - lat1) / 2);
+        const auto s_lon = std::sin(dlon / 2);
+        const auto a = s_lat * s_lat + std::cos(lat1) * std::cos(lat2) * s_lon * s_lon;
+        return static_cast<float>(2. * std::asin(std::min(1., std::sqrt(a))) * kEarthRadius * m_InvScale);
+    }
+
+  private:
+    static constexpr double kDegToRad = 3.14159265358979323846264338327950288 / 180.;
+    static constexpr double kEarthRadius = 6378137.;
+    const Model *m_Model;   ///< Model providing the inverse projection
+    double m_InvScale;      ///< Meters to normalized units
+};
+
+/**
+ * @struct ZeroDistance
+ * @brief Null heuristic, turns A* into Dijkstra's algorithm
+ */
+struct ZeroDistance {
+    explicit ZeroDistance(const Model &) {}
+    float operator()(double, double, double, double) const { return 0.f; }
+};
+
+//--------------------------------//
+//   Open-list queues.
+//--------------------------------//
+
+/**
+ * @class SortedVectorQueue
+ * @brief Open list kept as a vector that is sorted on every pop
+ * @tparam Item The queued element type
+ * @tparam Key The priority type (lower pops first)
+ *
+ * Reproduces the original RoutePlanner open list exactly, including its
+ * tie-breaking, and is therefore the default queue of RoutePlanner.
+ */
+template <typename Item, typename Key = float>
+class SortedVectorQueue {
+  public:
+    void push(Item item, Key key) { m_Entries.emplace_back(key, item); }
+
+    /**
+     * @brief Removes and returns the entry with the lowest key
+     */
+    std::pair<Key, Item> pop() {
+        std::sort(m_Entries.begin(), m_Entries.end(), [](const auto &a, const auto &b) {
+            return a.first < b.first;
+        });
+        auto top = m_Entries.front();
+        m_Entries.erase(m_Entries.begin());
+        return top;
+    }
+
+    bool empty() const noexcept { return m_Entries.empty(); }
+    std::size_t size() const noexcept { return m_Entries.size(); }
+    void clear() noexcept { m_Entries.clear(); }
+    void reserve(std::size_t n) { m_Entries.reserve(n); }
+
+  private:
+    std::vector<std::pair<Key, Item>> m_Entries;  ///< Unordered (key, item) entries
+};
+
+/**
+ * @class BinaryHeapQueue
+ * @brief Open list kept as a binary min-heap
+ * @tparam Item The queued element type
+ * @tparam Key The priority type (lower pops first)
+ *
+ * Push and pop are O(log n). Ties are broken arbitrarily, so paths of equal
+ * cost may differ from the ones SortedVectorQueue produces.
+ */
+template <typename Item, typename Key = float>
+class BinaryHeapQueue {
+  public:
+    void push(Item item, Key key) {
+        m_Heap.emplace_back(key, item);
+        std::push_heap(m_Heap.begin(), m_Heap.end(), Greater{});
+    }
+
+    /**
+     * @brief Removes and returns the entry with the lowest key
+     */
+    std::pair<Key, Item> pop() {
+        std::pop_heap(m_Heap.begin(), m_Heap.end(), Greater{});
+        auto top = m_Heap.back();
+        m_Heap.pop_back();
+        return top;
+    }
+
+    bool empty() const noexcept { return m_Heap.empty(); }
+    std::size_t size() const noexcept { return m_Heap.size(); }
+    void clear() noexcept { m_Heap.clear(); }
+    void reserve(std::size_t n) { m_Heap.reserve(n); }
+
+  private:
+    struct Greater {
+        bool operator()(const std::pair<Key, Item> &a, const std::pair<Key, Item> &b) const {
+            return a.first > b.first;
+        }
+    };
+    std::vector<std::pair<Key, Item>> m_Heap;  ///< Heap-ordered (key, item) entries
+};
+
+/**
+ * @class RadixHeapQueue
+ * @brief Monotone radix heap for integer keys
+ * @tparam Item The queued element type
+ * @tparam Key An unsigned integer priority type (lower pops first)
+ *
+ * Entries live in buckets by the highest bit in which their key differs from
+ * the last popped key, so push is O(1) and each entry is moved at most
+ * sizeof(Key) * 8 times over its lifetime. The heap is monotone: keys pushed
+ * below the last popped key are raised to it, which is exact for A* with a
+ * consistent heuristic and only absorbs rounding noise otherwise.
+ */
+template <typename Item, typename Key = std::uint32_t>
+class RadixHeapQueue {
+    static_assert(std::is_unsigned<Key>::value, "RadixHeapQueue needs unsigned integer keys");
+
+  public:
+    void push(Item item, Key key) {
+        key = std::max(key, m_Last);
+        m_Buckets[BucketIndex(key)].emplace_back(key, item);
+        ++m_Size;
+    }
+
+    /**
+     * @brief Removes and returns an entry with the lowest key
+     */
+    std::pair<Key, Item> pop() {
+        if (m_Buckets[0].empty()) {
+            std::size_t i = 1;
+            while (m_Buckets[i].empty())
+                ++i;
+            auto &bucket = m_Buckets[i];
+            m_Last = std::min_element(bucket.begin(), bucket.end(), [](const auto &a, const auto &b) {
+                return a.first < b.first;
+            })->first;
+            for (const auto &entry : bucket)
+                m_Buckets[BucketIndex(entry.first)].push_back(entry);
+            bucket.clear();
+        }
+        auto top = m_Buckets[0].back();
+        m_Buckets[0].pop_back();
+        --m_Size;
+        return top;
+    }
+
+    bool empty() const noexcept { return m_Size == 0; }
+    std::size_t size() const noexcept { return m_Size; }
+
+    void clear() noexcept {
+        for (auto &bucket : m_Buckets)
+            bucket.clear();
+        m_Size = 0;
+        m_Last = 0;
+    }
+
+    void reserve(std::size_t n) { m_Buckets[0].reserve(n); }
+
+  private:
+    static constexpr std::size_t kNumBuckets = sizeof(Key) * 8 + 1;
+
+    /**
+     * @brief Returns the bucket of a key: the bit width of key XOR last popped key
+     */
+    std::size_t BucketIndex(Key key) const noexcept {
+        const auto diff = static_cast<unsigned long long>(key ^ m_Last);
+#if defined(__GNUC__) || defined(__clang__)
+        return diff == 0 ? 0 : 64 - __builtin_clzll(diff);
+#else
+        std::size_t width = 0;
+        for (auto d = diff; d; d >>= 1)
+            ++width;
+        return width;
+#endif
+    }
+
+    std::array<std::vector<std::pair<Key, Item>>, kNumBuckets> m_Buckets;  ///< Entries by differing bit
+    std::size_t m_Size = 0;  ///< Number of queued entries
+    Key m_Last = 0;          ///< Last popped key
+};
+
+//--------------------------------//
+//   Cost representations.
+//--------------------------------//
+
+/**
+ * @struct FloatCosts
+ * @brief Graph search on the float edge weights, in normalized map units
+ */
+struct FloatCosts {
+    using Value = float;
+
+    template <typename Graph>
+    static Value Weight(const Graph &graph, std::uint32_t e) noexcept { return graph.Weight(e); }
+
+    template <typename Graph>
+    static Value Partial(const Graph &graph, std::uint32_t e, float fraction) noexcept { return graph.Weight(e) * fraction; }
+
+    template <typename Graph>
+    static Value Bound(const Graph &, float h) noexcept { return h; }
+
+    template <typename Graph>
+    static double Meters(const Graph &graph, Value g) noexcept { return g * graph.MetricScale(); }
+};
+
+/**
+ * @struct IntegerCosts
+ * @brief Graph search on the integer edge weights, in Graph::CostUnit() units
+ *
+ * Edge weights are rounded up and heuristic values rounded down, which keeps
+ * a consistent float heuristic consistent. Required by RadixHeapQueue.
+ */
+struct IntegerCosts {
+    using Value = std::uint32_t;
+
+    template <typename Graph>
+    static Value Weight(const Graph &graph, std::uint32_t e) noexcept { return graph.IntWeight(e); }
+
+    template <typename Graph>
+    static Value Partial(const Graph &graph, std::uint32_t e, float fraction) noexcept {
+        return static_cast<Value>(std::ceil(graph.IntWeight(e) * static_cast<double>(fraction)));
+    }
+
+    template <typename Graph>
+    static Value Bound(const Graph &graph, float h) noexcept { return graph.IntegerCost(h); }
+
+    template <typename Graph>
+    static double Meters(const Graph &graph, Value g) noexcept { return g * graph.CostUnit(); }
+};
+
+//--------------------------------//
+//   Termination criteria.
+//--------------------------------//
+
+/**
+ * @struct StopAtGoal
+ * @brief Ends the search as soon as the goal is taken from the open list
+ */
+struct StopAtGoal {
+    template <typename NodeRef>
+    bool operator()(const NodeRef &current, const NodeRef &goal, std::size_t /*expansions*/) const {
+        return current == goal;
+    }
+};
+
+/**
+ * @struct StopAtGoalOrBudget
+ * @brief Ends the search at the goal or after a fixed number of expansions
+ * @tparam MaxExpansions Upper bound on the number of expanded nodes
+ *
+ * Used to bound the worst-case latency of a query; the planner reports no
+ * path when the budget runs out first.
+ */
+template <std::size_t MaxExpansions>
+struct StopAtGoalOrBudget {
+    template <typename NodeRef>
+    bool operator()(const NodeRef &current, const NodeRef &goal, std::size_t expansions) const {
+        return current == goal || expansions >= MaxExpansions;
+    }
+};
+
+//--------------------------------//
+//   Pruning rules.
+//--------------------------------//
+
+/**
+ * @struct NoPruning
+ * @brief Keeps every relaxed node; the default of BasicGraphPlanner
+ */
+struct NoPruning {
+    /**
+     * @brief Returns true if node w can be skipped
+     * @param w The node being relaxed
+     * @param g_meters A lower bound of its distance from the source node in meters
+     * @param h_meters A lower bound of its distance to the target node in meters
+     *
+     * For searches between snapped positions, both bounds are reduced by the
+     * longest partial edge at that end, so they refer to the graph nodes the
+     * path enters and leaves the network through.
+     */
+    bool operator()(int /*w*/, double /*g_meters*/, double /*h_meters*/) const noexcept { return false; }
+};
+
+#endif
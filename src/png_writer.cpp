@@ -0,0 +1,160 @@
+#include "png_writer.h"
+#include <algorithm>
+#include <csetjmp>
+#include <exception>
+#include <fstream>
+#include <new>
+#include <system_error>
+#include <png.h>
+
+namespace {
+
+void AppendData(png_structp png, png_bytep data, png_size_t size)
+{
+    auto &out = *static_cast<std::vector<std::uint8_t> *>(png_get_io_ptr(png));
+    bool appended = true;
+    try {
+        out.insert(out.end(), data, data + size);
+    }
+    catch( const std::bad_alloc & ) {
+        appended = false;
+    }
+    // Leave the handler before png_error() jumps back into WritePng.
+    if( !appended )
+        png_error(png, "out of memory");
+}
+
+void FlushData(png_structp) {}
+
+/**
+ * @brief Writes the PNG stream of an image
+ *
+ * libpng reports errors with longjmp, so this frame owns no objects with
+ * destructors.
+ */
+bool WritePng(png_structp png, png_infop info, const RgbaImage &image, int level, png_bytep *rows)
+{
+    if( setjmp(png_jmpbuf(png)) )
+        return false;
+    png_set_IHDR(png, info, image.width, image.height, 8, PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE,
+                 PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_set_compression_level(png, level);
+    // Row filters only help the compressor; skip them when it doesn't run.
+    if( level == 0 )
+        png_set_filter(png, PNG_FILTER_TYPE_BASE, PNG_FILTER_NONE);
+    png_write_info(png, info);
+    png_write_image(png, rows);
+    png_write_end(png, nullptr);
+    return true;
+}
+
+}  // namespace
+
+std::vector<std::uint8_t> EncodePng(const RgbaImage &image, int level)
+{
+    std::vector<std::uint8_t> out;
+    if( image.width <= 0 || image.height <= 0 ||
+        image.pixels.size() != static_cast<std::size_t>(image.width) * image.height * 4 )
+        return out;
+
+    std::vector<png_bytep> rows(image.height);
+    for( int y = 0; y < image.height; ++y )
+        rows[y] = const_cast<png_bytep>(image.pixels.data() + static_cast<std::size_t>(y) * image.width * 4);
+
+    auto png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    if( !png )
+        return out;
+    auto info = png_create_info_struct(png);
+    bool ok = info != nullptr;
+    if( ok ) {
+        png_set_write_fn(png, &out, AppendData, FlushData);
+        ok = WritePng(png, info, image, std::clamp(level, 0, 9), rows.data());
+    }
+    png_destroy_write_struct(&png, &info);
+    if( !ok )
+        out.clear();
+    return out;
+}
+
+AsyncPngWriter::AsyncPngWriter(unsigned threads, std::size_t capacity, int level) :
+    m_Level(std::clamp(level, 0, 9)),
+    m_Capacity(std::max<std::size_t>(capacity, 1))
+{
+    if( threads == 0 )
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    m_Workers.reserve(threads);
+    for( unsigned i = 0; i < threads; ++i ) {
+        try {
+            m_Workers.emplace_back([this] { Run(); });
+        }
+        catch( const std::system_error & ) {
+            // Encode with the workers that started; without any, nothing would ever be written.
+            if( m_Workers.empty() )
+                throw;
+            break;
+        }
+    }
+}
+
+bool AsyncPngWriter::Submit(RgbaImage image, Sink sink)
+{
+    {
+        std::unique_lock<std::mutex> lock{m_Mutex};
+        m_Space.wait(lock, [this] { return m_Closed || m_Jobs.size() < m_Capacity; });
+        if( m_Closed )
+            return false;
+        m_Jobs.push_back({std::move(image), std::move(sink)});
+    }
+    m_Ready.notify_one();
+    return true;
+}
+
+bool AsyncPngWriter::Submit(const std::string &path, RgbaImage image)
+{
+    return Submit(std::move(image), [path](std::vector<std::uint8_t> &&png) {
+        std::ofstream os{path, std::ios::binary | std::ios::trunc};
+        os.write(reinterpret_cast<const char *>(png.data()), static_cast<std::streamsize>(png.size()));
+        os.close();
+        return !os.fail();
+    });
+}
+
+void AsyncPngWriter::Close()
+{
+    {
+        std::lock_guard<std::mutex> lock{m_Mutex};
+        m_Closed = true;
+    }
+    m_Ready.notify_all();
+    m_Space.notify_all();
+    for( auto &worker: m_Workers )
+        worker.join();
+    m_Workers.clear();
+}
+
+void AsyncPngWriter::Run()
+{
+    for( ;; ) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock{m_Mutex};
+            m_Ready.wait(lock, [this] { return m_Closed || !m_Jobs.empty(); });
+            if( m_Jobs.empty() )
+                return;
+            job = std::move(m_Jobs.front());
+            m_Jobs.pop_front();
+        }
+        m_Space.notify_one();
+
+        auto png = EncodePng(job.image, m_Level);
+        // Release the pixels before the sink runs; it may block on I/O.
+        job.image = {};
+        bool stored = false;
+        try {
+            stored = !png.empty() && job.sink(std::move(png));
+        }
+        catch( const std::exception & ) {
+        }
+        ++(stored ? m_Written : m_Failed);
+    }
+}
@@ -0,0 +1,129 @@
+/**
+ * @file png_writer.h
+ * @brief PNG compression of rendered images off the rendering thread
+ *
+ * This file contains EncodePng, which compresses an RGBA buffer in memory
+ * with libpng, and AsyncPngWriter, a bounded queue of encoder threads.
+ * Rendering code copies a finished surface into an RgbaImage, submits it
+ * and moves on to the next image while compression and disk I/O run in the
+ * background. Nothing here depends on io2d; see Render::ReadPixels for the
+ * conversion from a surface.
+ */
+
+#ifndef PNG_WRITER_H
+#define PNG_WRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @struct RgbaImage
+ * @brief 8-bit RGBA pixels with straight alpha, rows top to bottom without padding
+ */
+struct RgbaImage {
+    int width = 0;                     ///< Width in pixels
+    int height = 0;                    ///< Height in pixels
+    std::vector<std::uint8_t> pixels;  ///< width * height * 4 bytes
+};
+
+/**
+ * @brief Compresses an image to PNG in memory
+ * @param image The image to encode
+ * @param level zlib compression level, from 0 (fastest, largest) to 9 (slowest, smallest)
+ * @return The PNG file contents, or an empty vector if the image is malformed or encoding failed
+ */
+std::vector<std::uint8_t> EncodePng(const RgbaImage &image, int level = 6);
+
+/**
+ * @class AsyncPngWriter
+ * @brief Encodes and stores images on background threads
+ *
+ * Submit() queues an image and returns at once unless the queue is full,
+ * in which case it waits for a free slot, so a fast producer can't pile up
+ * unbounded memory. Workers take images in submission order and hand each
+ * PNG to the job's sink, which writes it to a file or any other
+ * destination. With several workers, sinks run concurrently and may finish
+ * out of order.
+ */
+class AsyncPngWriter {
+  public:
+    /**
+     * @brief Receives an encoded PNG on a worker thread
+     * @return True if the PNG was stored
+     */
+    using Sink = std::function<bool(std::vector<std::uint8_t> &&png)>;
+
+    /**
+     * @brief Starts the encoder threads
+     * @param threads Number of workers; 0 selects the hardware concurrency
+     * @param capacity Images that may wait in the queue before Submit() blocks
+     * @param level zlib compression level, see EncodePng
+     *
+     * If only some of the threads can be started, the writer runs with those;
+     * if none can, the std::system_error of the first attempt is thrown.
+     */
+    explicit AsyncPngWriter(unsigned threads = 1, std::size_t capacity = 4, int level = 6);
+
+    /**
+     * @brief Encodes the remaining images and joins the workers
+     */
+    ~AsyncPngWriter() { Close(); }
+
+    AsyncPngWriter(const AsyncPngWriter &) = delete;
+    AsyncPngWriter &operator=(const AsyncPngWriter &) = delete;
+
+    /**
+     * @brief Queues an image whose PNG is passed to a sink
+     * @return False if the writer is closed
+     */
+    bool Submit(RgbaImage image, Sink sink);
+
+    /**
+     * @brief Queues an image to be written to a PNG file
+     * @return False if the writer is closed
+     */
+    bool Submit(const std::string &path, RgbaImage image);
+
+    /**
+     * @brief Encodes the remaining images and joins the workers; later submissions are rejected
+     */
+    void Close();
+
+    /**
+     * @brief Returns the number of images stored so far
+     */
+    std::size_t Written() const noexcept { return m_Written.load(); }
+
+    /**
+     * @brief Returns the number of images that failed to encode or store
+     */
+    std::size_t Failed() const noexcept { return m_Failed.load(); }
+
+  private:
+    struct Job {
+        RgbaImage image;  ///< Image to encode
+        Sink sink;        ///< Destination of the PNG
+    };
+
+    void Run();
+
+    int m_Level;                            ///< Compression level
+    std::size_t m_Capacity;                 ///< Largest number of queued jobs
+    std::mutex m_Mutex;                     ///< Guards m_Jobs and m_Closed
+    std::condition_variable m_Ready;        ///< Signals new jobs or shutdown
+    std::condition_variable m_Space;        ///< Signals a free queue slot
+    std::deque<Job> m_Jobs;                 ///< Pending jobs
+    bool m_Closed = false;                  ///< Set by Close()
+    std::atomic<std::size_t> m_Written{0};  ///< Images stored
+    std::atomic<std::size_t> m_Failed{0};   ///< Images lost
+    std::vector<std::thread> m_Workers;     ///< Encoder threads
+};
+
+#endif
@@ -0,0 +1,732 @@
+#include "query_server.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <iomanip>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <system_error>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define QUERY_SERVER_HAS_SOCKETS 1
+#endif
+
+namespace {
+
+constexpr std::size_t kMaxRequestBytes = 1 << 16;  ///< Longest request line a socket client may send
+constexpr std::size_t kMaxConnections = 64;        ///< Most socket clients served at once
+constexpr std::size_t kMaxUnsentBytes = 1 << 22;   ///< Most response bytes queued for a socket client that isn't reading
+constexpr int kSendTimeoutSeconds = 30;            ///< Longest a socket client may block a send before it's dropped
+constexpr int kMaxJsonDepth = 32;                  ///< Deepest nesting the parser accepts
+
+/**
+ * @struct Json
+ * @brief A parsed JSON value
+ */
+struct Json {
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.;
+    std::string string;
+    std::vector<Json> items;                            ///< Array elements
+    std::vector<std::pair<std::string, Json>> members;  ///< Object members, in source order
+    std::string_view text;                              ///< Source text of the value
+
+    /**
+     * @brief Returns the last member with a key, or nullptr
+     */
+    const Json *Find(std::string_view key) const {
+        for( auto it = members.rbegin(); it != members.rend(); ++it )
+            if( it->first == key )
+                return &it->second;
+        return nullptr;
+    }
+};
+
+/**
+ * @class JsonParser
+ * @brief Minimal recursive-descent parser for one JSON value
+ *
+ * Accepts standard JSON; \u escapes are decoded to UTF-8.
+ */
+class JsonParser {
+  public:
+    explicit JsonParser(std::string_view text) : m_Text(text) {}
+
+    /**
+     * @return The value, or nullopt if the text isn't exactly one JSON value
+     */
+    std::optional<Json> Parse() {
+        Json value;
+        if( !Value(value, 0) )
+            return std::nullopt;
+        SkipSpace();
+        if( m_Pos != m_Text.size() )
+            return std::nullopt;
+        return value;
+    }
+
+  private:
+    void SkipSpace() {
+        while( m_Pos < m_Text.size() && (m_Text[m_Pos] == ' ' || m_Text[m_Pos] == '\t' || m_Text[m_Pos] == '\n' || m_Text[m_Pos] == '\r') )
+            ++m_Pos;
+    }
+
+    bool Consume(char c) {
+        SkipSpace();
+        if( m_Pos < m_Text.size() && m_Text[m_Pos] == c ) {
+            ++m_Pos;
+            return true;
+        }
+        return false;
+    }
+
+    bool Literal(std::string_view word) {
+        if( m_Text.substr(m_Pos, word.size()) != word )
+            return false;
+        m_Pos += word.size();
+        return true;
+    }
+
+    bool Value(Json &out, int depth) {
+        if( depth > kMaxJsonDepth )
+            return false;
+        SkipSpace();
+        if( m_Pos == m_Text.size() )
+            return false;
+        const auto start = m_Pos;
+        bool ok = false;
+        switch( m_Text[m_Pos] ) {
+            case '{': ok = Object(out, depth); break;
+            case '[': ok = Array(out, depth); break;
+            case '"': out.type = Json::Type::String; ok = String(out.string); break;
+            case 't': out.type = Json::Type::Bool; out.boolean = true; ok = Literal("true"); break;
+            case 'f': out.type = Json::Type::Bool; ok = Literal("false"); break;
+            case 'n': ok = Literal("null"); break;
+            default: ok = Number(out); break;
+        }
+        out.text = m_Text.substr(start, m_Pos - start);
+        return ok;
+    }
+
+    bool Object(Json &out, int depth) {
+        out.type = Json::Type::Object;
+        ++m_Pos;
+        if( Consume('}') )
+            return true;
+        do {
+            std::string key;
+            Json value;
+            SkipSpace();
+            if( m_Pos == m_Text.size() || m_Text[m_Pos] != '"' || !String(key) || !Consume(':') || !Value(value, depth + 1) )
+                return false;
+            out.members.emplace_back(std::move(key), std::move(value));
+        } while( Consume(',') );
+        return Consume('}');
+    }
+
+    bool Array(Json &out, int depth) {
+        out.type = Json::Type::Array;
+        ++m_Pos;
+        if( Consume(']') )
+            return true;
+        do {
+            Json value;
+            if( !Value(value, depth + 1) )
+                return false;
+            out.items.push_back(std::move(value));
+        } while( Consume(',') );
+        return Consume(']');
+    }
+
+    bool Number(Json &out) {
+        out.type = Json::Type::Number;
+        const char c = m_Text[m_Pos];
+        if( c != '-' && (c < '0' || c > '9') )
+            return false;
+        const auto first = m_Text.data() + m_Pos, last = m_Text.data() + m_Text.size();
+        const auto [end, error] = std::from_chars(first, last, out.number);
+        if( error != std::errc{} || !std::isfinite(out.number) )
+            return false;
+        m_Pos += end - first;
+        return true;
+    }
+
+    bool Hex4(unsigned &code) {
+        if( m_Pos + 4 > m_Text.size() )
+            return false;
+        code = 0;
+        for( int i = 0; i < 4; ++i ) {
+            const char c = m_Text[m_Pos++];
+            code <<= 4;
+            if( c >= '0' && c <= '9' ) code |= c - '0';
+            else if( c >= 'a' && c <= 'f' ) code |= c - 'a' + 10;
+            else if( c >= 'A' && c <= 'F' ) code |= c - 'A' + 10;
+            else return false;
+        }
+        return true;
+    }
+
+    bool String(std::string &out) {
+        ++m_Pos;
+        while( m_Pos < m_Text.size() ) {
+            const char c = m_Text[m_Pos++];
+            if( c == '"' )
+                return true;
+            if( static_cast<unsigned char>(c) < 0x20 )
+                return false;
+            if( c != '\\' ) {
+                out += c;
+                continue;
+            }
+            if( m_Pos == m_Text.size() )
+                return false;
+            switch( m_Text[m_Pos++] ) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    unsigned code, low;
+                    if( !Hex4(code) )
+                        return false;
+                    if( code >= 0xD800 && code < 0xDC00 ) {
+                        if( !Literal("\\u") || !Hex4(low) || low < 0xDC00 || low >= 0xE000 )
+                            return false;
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    AppendUtf8(out, code);
+                    break;
+                }
+                default: return false;
+            }
+        }
+        return false;
+    }
+
+    static void AppendUtf8(std::string &out, unsigned code) {
+        if( code < 0x80 )
+            out += static_cast<char>(code);
+        else if( code < 0x800 ) {
+            out += static_cast<char>(0xC0 | code >> 6);
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else if( code < 0x10000 ) {
+            out += static_cast<char>(0xE0 | code >> 12);
+            out += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else {
+            out += static_cast<char>(0xF0 | code >> 18);
+            out += static_cast<char>(0x80 | (code >> 12 & 0x3F));
+            out += static_cast<char>(0x80 | (code >> 6 & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    std::string_view m_Text;
+    std::size_t m_Pos = 0;
+};
+
+void WriteJsonString(std::ostream &os, std::string_view text)
+{
+    os << '"';
+    for( const char c: text ) {
+        switch( c ) {
+            case '"': os << "\\\""; break;
+            case '\\': os << "\\\\"; break;
+            case '\n': os << "\\n"; break;
+            case '\r': os << "\\r"; break;
+            case '\t': os << "\\t"; break;
+            default:
+                if( static_cast<unsigned char>(c) < 0x20 )
+                    os << "\\u00" << "0123456789abcdef"[c >> 4] << "0123456789abcdef"[c & 15];
+                else
+                    os << c;
+        }
+    }
+    os << '"';
+}
+
+/**
+ * @brief Reads a position given as [x, y]
+ */
+std::optional<std::pair<float, float>> Position(const Json &request, std::string_view key)
+{
+    const auto *value = request.Find(key);
+    if( !value || value->type != Json::Type::Array || value->items.size() != 2 ||
+        value->items[0].type != Json::Type::Number || value->items[1].type != Json::Type::Number )
+        return std::nullopt;
+    return std::pair{static_cast<float>(value->items[0].number), static_cast<float>(value->items[1].number)};
+}
+
+#if defined(QUERY_SERVER_HAS_SOCKETS)
+#if defined(MSG_NOSIGNAL)
+constexpr int kSendFlags = MSG_NOSIGNAL;  ///< Report a closed client as an error instead of raising SIGPIPE
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+bool SendAll(int fd, std::string_view data)
+{
+    while( !data.empty() ) {
+        const auto sent = ::send(fd, data.data(), data.size(), kSendFlags);
+        if( sent < 0 && errno == EINTR )
+            continue;
+        if( sent <= 0 )
+            return false;
+        data.remove_prefix(static_cast<std::size_t>(sent));
+    }
+    return true;
+}
+#endif
+
+/**
+ * @struct Outstanding
+ * @brief Counts the unanswered requests of one stream or connection
+ */
+struct Outstanding {
+    std::mutex mutex;              ///< Guards pending and the stream's output
+    std::condition_variable done;  ///< Signals that pending dropped to zero
+    std::size_t pending = 0;       ///< Requests submitted but not yet answered
+
+    void Add() {
+        std::lock_guard<std::mutex> lock{mutex};
+        ++pending;
+    }
+
+    /**
+     * @brief Marks a request as answered; the caller holds mutex
+     */
+    void Finish() {
+        if( --pending == 0 )
+            done.notify_all();
+    }
+
+    void Wait() {
+        std::unique_lock<std::mutex> lock{mutex};
+        done.wait(lock, [this] { return pending == 0; });
+    }
+};
+
+/**
+ * @struct ConnectionSlots
+ * @brief Counts the socket connections being served, up to a limit
+ */
+struct ConnectionSlots {
+    std::mutex mutex;                  ///< Guards active
+    std::condition_variable released;  ///< Signals that a connection ended
+    std::size_t active = 0;            ///< Connections being served
+
+    /**
+     * @brief Waits until fewer than limit connections are active and takes a slot
+     */
+    void Acquire(std::size_t limit) {
+        std::unique_lock<std::mutex> lock{mutex};
+        released.wait(lock, [&] { return active < limit; });
+        ++active;
+    }
+
+    void Release() {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            --active;
+        }
+        released.notify_all();
+    }
+
+    void WaitIdle() {
+        std::unique_lock<std::mutex> lock{mutex};
+        released.wait(lock, [this] { return active == 0; });
+    }
+};
+
+}  // namespace
+
+QueryServer::QueryServer(const Model &model, unsigned threads) :
+    m_Graph(RouteGraph::Build(model)),
+    m_Index(m_Graph)
+{
+    if( threads == 0 )
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    m_Capacity = 4 * std::size_t{threads};
+    m_Workers.reserve(threads);
+    for( unsigned i = 0; i < threads; ++i ) {
+        try {
+            m_Workers.emplace_back([this] { Run(); });
+        }
+        catch( const std::system_error & ) {
+            // Serve with the workers that started; without any, no request would be answered.
+            if( m_Workers.empty() )
+                throw;
+            break;
+        }
+    }
+}
+
+QueryServer::~QueryServer()
+{
+    {
+        std::lock_guard<std::mutex> lock{m_Mutex};
+        m_Stopping = true;
+    }
+    m_Ready.notify_all();
+    for( auto &worker: m_Workers )
+        worker.join();
+}
+
+std::string QueryServer::Handle(std::string_view request) const
+{
+    GraphPlanner planner{m_Graph};
+    return Handle(request, planner);
+}
+
+std::string QueryServer::Handle(std::string_view request, GraphPlanner &planner) const
+{
+    std::ostringstream out;
+    out << std::setprecision(9);
+    std::string_view id = "null";
+    auto fail = [&](std::string_view message) {
+        out << "{\"id\":" << id << ",\"ok\":false,\"error\":";
+        WriteJsonString(out, message);
+        out << '}';
+        return out.str();
+    };
+
+    const auto parsed = JsonParser{request}.Parse();
+    if( !parsed || parsed->type != Json::Type::Object )
+        return fail("malformed request");
+    if( const auto *value = parsed->Find("id") ) {
+        if( value->type != Json::Type::Number && value->type != Json::Type::String )
+            return fail("id must be a number or a string");
+        id = value->text;
+    }
+    try {
+        const auto *op = parsed->Find("op");
+        if( !op || op->type != Json::Type::String )
+            return fail("missing op");
+
+        if( op->string == "snap" ) {
+            const auto at = Position(*parsed, "at");
+            if( !at )
+                return fail("snap needs \"at\": [x, y]");
+            const auto snap = m_Index.Snap(at->first, at->second);
+            if( !snap )
+                return fail("the map has no roads");
+            out << "{\"id\":" << id << ",\"ok\":true,\"x\":" << snap->x << ",\"y\":" << snap->y
+                << ",\"offset\":" << snap->distance * m_Graph.MetricScale() << '}';
+            return out.str();
+        }
+
+        if( op->string != "route" && op->string != "distance" )
+            return fail("unknown op");
+        const auto from = Position(*parsed, "from"), to = Position(*parsed, "to");
+        if( !from || !to )
+            return fail(op->string + " needs \"from\": [x, y] and \"to\": [x, y]");
+        const auto from_snap = m_Index.Snap(from->first, from->second);
+        const auto to_snap = m_Index.Snap(to->first, to->second);
+        if( !from_snap || !to_snap )
+            return fail("the map has no roads");
+        const auto path = planner.Search(*from_snap, *to_snap);
+        if( !path.found )
+            return fail("no route");
+
+        out << "{\"id\":" << id << ",\"ok\":true,\"distance\":" << path.distance;
+        if( op->string == "route" ) {
+            out << ",\"path\":[[" << from_snap->x << ',' << from_snap->y << ']';
+            for( const int v: path.nodes )
+                out << ",[" << m_Graph.X(v) << ',' << m_Graph.Y(v) << ']';
+            out << ",[" << to_snap->x << ',' << to_snap->y << "]]";
+        }
+        out << '}';
+        return out.str();
+    }
+    catch( const std::exception & ) {
+        // The id is a view of the request, so the failure still names its request.
+        out.str(std::string{});
+        out.clear();
+        return fail("internal error");
+    }
+}
+
+void QueryServer::Submit(std::string request, Respond respond)
+{
+    {
+        std::unique_lock<std::mutex> lock{m_Mutex};
+        m_Space.wait(lock, [this] { return m_Jobs.size() < m_Capacity; });
+        m_Jobs.push_back({std::move(request), std::move(respond)});
+    }
+    m_Ready.notify_one();
+}
+
+std::size_t QueryServer::Serve(std::istream &in, std::ostream &out)
+{
+    auto outstanding = std::make_shared<Outstanding>();
+    std::size_t requests = 0;
+    for( std::string line; std::getline(in, line); ) {
+        if( !line.empty() && line.back() == '\r' )
+            line.pop_back();
+        if( line.find_first_not_of(" \t") == std::string::npos )
+            continue;
+        outstanding->Add();
+        Submit(std::move(line), [&out, outstanding](std::string response) {
+            std::lock_guard<std::mutex> lock{outstanding->mutex};
+            out << response << '\n' << std::flush;
+            outstanding->Finish();
+        });
+        ++requests;
+    }
+    outstanding->Wait();
+    return requests;
+}
+
+bool QueryServer::ServeSocket(const std::string &path)
+{
+#if defined(QUERY_SERVER_HAS_SOCKETS)
+    sockaddr_un address{};
+    if( path.empty() || path.size() >= sizeof(address.sun_path) )
+        return false;
+    address.sun_family = AF_UNIX;
+    std::copy(path.begin(), path.end(), address.sun_path);
+
+    const int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if( listener < 0 )
+        return false;
+    // Only a stale socket is replaced; any other file at the path is left alone.
+    struct stat existing;
+    if( ::lstat(path.c_str(), &existing) == 0 ) {
+        if( !S_ISSOCK(existing.st_mode) || ::unlink(path.c_str()) != 0 ) {
+            ::close(listener);
+            return false;
+        }
+    }
+    if( ::bind(listener, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 ) {
+        ::close(listener);
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock{m_ListenerMutex};
+        m_Listener = listener;
+    }
+    if( ::listen(listener, SOMAXCONN) != 0 ) {
+        StopServing(listener);
+        return false;
+    }
+
+    // Connection threads are detached and release their slot when they end, so a
+    // long-running server holds no threads for closed connections. Clients beyond
+    // the limit wait in the listen backlog until a slot is free.
+    auto slots = std::make_shared<ConnectionSlots>();
+    for( ;; ) {
+        slots->Acquire(kMaxConnections);
+        int client;
+        do
+            client = ::accept(listener, nullptr, nullptr);
+        while( client < 0 && errno == EINTR );
+        if( client < 0 ) {
+            slots->Release();
+            break;
+        }
+        try {
+            std::thread([this, client, slots] {
+                ServeConnection(client);
+                slots->Release();
+            }).detach();
+        }
+        catch( const std::system_error & ) {
+            ::close(client);
+            slots->Release();
+        }
+    }
+    StopServing(listener);
+    slots->WaitIdle();
+    return true;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+void QueryServer::StopSocket()
+{
+#if defined(QUERY_SERVER_HAS_SOCKETS)
+    // Shutting the listener down wakes the accept() ServeSocket() is blocked in.
+    std::lock_guard<std::mutex> lock{m_ListenerMutex};
+    if( m_Listener >= 0 )
+        ::shutdown(m_Listener, SHUT_RDWR);
+#endif
+}
+
+void QueryServer::StopServing(int listener)
+{
+#if defined(QUERY_SERVER_HAS_SOCKETS)
+    {
+        std::lock_guard<std::mutex> lock{m_ListenerMutex};
+        m_Listener = -1;
+    }
+    ::close(listener);
+#else
+    (void)listener;
+#endif
+}
+
+void QueryServer::ServeConnection(int fd)
+{
+#if defined(QUERY_SERVER_HAS_SOCKETS)
+    // Workers never write to the socket: they queue responses for this
+    // connection's writer thread and return. A client that stops reading only
+    // fills its own queue, and once that exceeds kMaxUnsentBytes the connection
+    // is shut down instead of stalling the workers; so is one whose sends block
+    // longer than kSendTimeoutSeconds. Responses may still be
+    // queued after the reader stopped, so the connection state is shared with them.
+    struct Connection : Outstanding {
+        int fd = -1;
+        std::deque<std::string> unsent;  ///< Responses not yet sent, with newlines
+        std::size_t unsent_bytes = 0;    ///< Total size of unsent
+        std::condition_variable wake;    ///< Signals the writer
+        bool closing = false;            ///< Every request is answered; the writer drains and stops
+        bool broken = false;             ///< Sending failed or fell too far behind; later responses are dropped
+
+        /**
+         * @brief Queues a response for the writer; the caller holds mutex
+         */
+        void Queue(std::string response) {
+            if( broken )
+                return;
+            response += '\n';
+            if( unsent_bytes + response.size() > kMaxUnsentBytes ) {
+                Break();
+                return;
+            }
+            unsent_bytes += response.size();
+            unsent.push_back(std::move(response));
+            wake.notify_one();
+        }
+
+        /**
+         * @brief Drops unsent responses and wakes the reader and writer; the caller holds mutex
+         */
+        void Break() {
+            broken = true;
+            unsent.clear();
+            unsent_bytes = 0;
+            ::shutdown(fd, SHUT_RDWR);
+            wake.notify_one();
+        }
+
+        void Write() {
+            std::unique_lock<std::mutex> lock{mutex};
+            for( ;; ) {
+                wake.wait(lock, [this] { return !unsent.empty() || closing; });
+                if( unsent.empty() )
+                    return;
+                auto response = std::move(unsent.front());
+                unsent.pop_front();
+                unsent_bytes -= response.size();
+                lock.unlock();
+                const bool sent = SendAll(fd, response);
+                lock.lock();
+                if( !sent && !broken )
+                    Break();
+            }
+        }
+    };
+    auto connection = std::make_shared<Connection>();
+    connection->fd = fd;
+    const timeval timeout{kSendTimeoutSeconds, 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    std::thread writer;
+    try {
+        writer = std::thread([connection] { connection->Write(); });
+    }
+    catch( const std::system_error & ) {
+        ::close(fd);
+        return;
+    }
+
+    std::string buffer;
+    char chunk[4096];
+    for( ;; ) {
+        const auto received = ::recv(fd, chunk, sizeof(chunk), 0);
+        if( received < 0 && errno == EINTR )
+            continue;
+        if( received <= 0 )
+            break;
+        buffer.append(chunk, static_cast<std::size_t>(received));
+
+        std::size_t start = 0;
+        for( std::size_t end; (end = buffer.find('\n', start)) != std::string::npos; start = end + 1 ) {
+            auto line = buffer.substr(start, end - start);
+            if( !line.empty() && line.back() == '\r' )
+                line.pop_back();
+            if( line.find_first_not_of(" \t") == std::string::npos )
+                continue;
+            connection->Add();
+            Submit(std::move(line), [connection](std::string response) {
+                std::lock_guard<std::mutex> lock{connection->mutex};
+                connection->Queue(std::move(response));
+                connection->Finish();
+            });
+        }
+        buffer.erase(0, start);
+        if( buffer.size() > kMaxRequestBytes ) {
+            std::lock_guard<std::mutex> lock{connection->mutex};
+            connection->Queue("{\"id\":null,\"ok\":false,\"error\":\"request too long\"}");
+            break;
+        }
+    }
+    connection->Wait();
+    {
+        std::lock_guard<std::mutex> lock{connection->mutex};
+        connection->closing = true;
+    }
+    connection->wake.notify_one();
+    writer.join();
+    ::close(fd);
+#else
+    (void)fd;
+#endif
+}
+
+void QueryServer::Run()
+{
+    GraphPlanner planner{m_Graph};
+    for( ;; ) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock{m_Mutex};
+            m_Ready.wait(lock, [this] { return m_Stopping || !m_Jobs.empty(); });
+            if( m_Jobs.empty() )
+                return;
+            job = std::move(m_Jobs.front());
+            m_Jobs.pop_front();
+        }
+        m_Space.notify_one();
+
+        std::string response;
+        try {
+            response = Handle(job.request, planner);
+        }
+        catch( const std::exception & ) {
+            // Handle() answers its own failures with the request's id; this is
+            // only reached if the request couldn't be parsed or the reply built.
+            response = "{\"id\":null,\"ok\":false,\"error\":\"internal error\"}";
+        }
+        job.respond(std::move(response));
+    }
+}
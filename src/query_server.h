@@ -0,0 +1,164 @@
+/**
+ * @file query_server.h
+ * @brief Long-running route query service with a line-delimited JSON protocol
+ *
+ * This file contains QueryServer, which builds the routing graph of a model
+ * once and then answers requests, one JSON object per line, on a pool of
+ * worker threads. Requests run concurrently, so responses can come back
+ * out of order; each carries the id of its request.
+ *
+ * Requests (positions are normalized map coordinates, as in Viewport):
+ *
+ *     {"id": 1, "op": "route", "from": [x, y], "to": [x, y]}
+ *     {"id": 2, "op": "distance", "from": [x, y], "to": [x, y]}
+ *     {"id": "a", "op": "snap", "at": [x, y]}
+ *
+ * Responses:
+ *
+ *     {"id":1,"ok":true,"distance":812.4,"path":[[x,y],...]}
+ *     {"id":2,"ok":true,"distance":812.4}
+ *     {"id":"a","ok":true,"x":0.41,"y":0.52,"offset":3.2}
+ *     {"id":1,"ok":false,"error":"no route"}
+ *
+ * Endpoints are snapped onto the nearest road segment, distances are in
+ * meters and a route's path runs from the snapped start to the snapped goal.
+ * "offset" is the distance from a snapped position to the road in meters.
+ * The id may be a number or a string and is echoed verbatim; a request
+ * without one is answered with "id":null.
+ */
+
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "graph_planner.h"
+#include "model.h"
+#include "route_graph.h"
+#include "segment_index.h"
+
+/**
+ * @class QueryServer
+ * @brief Answers route, distance and snap requests on worker threads
+ *
+ * The graph and segment index are read-only after construction; every
+ * worker owns a GraphPlanner, so requests don't contend for search state.
+ * The request queue is bounded: Submit() waits while it is full, which
+ * throttles clients that send faster than the workers answer.
+ */
+class QueryServer {
+  public:
+    /**
+     * @brief Receives the response line of a request, without the newline, on a worker thread
+     */
+    using Respond = std::function<void(std::string response)>;
+
+    /**
+     * @brief Builds the routing graph and starts the workers
+     * @param model The map; must outlive the server
+     * @param threads Number of workers; 0 selects the hardware concurrency
+     *
+     * If only some of the threads can be started, the server runs with those;
+     * if none can, the std::system_error of the first attempt is thrown.
+     */
+    explicit QueryServer(const Model &model, unsigned threads = 0);
+
+    /**
+     * @brief Answers the queued requests and joins the workers
+     */
+    ~QueryServer();
+
+    QueryServer(const QueryServer &) = delete;
+    QueryServer &operator=(const QueryServer &) = delete;
+
+    /**
+     * @brief Answers one request on the calling thread
+     * @param request One JSON object
+     * @return The response, without a newline
+     */
+    std::string Handle(std::string_view request) const;
+
+    /**
+     * @brief Queues a request for the workers
+     * @param request One JSON object
+     * @param respond Called with the response once the request is answered
+     */
+    void Submit(std::string request, Respond respond);
+
+    /**
+     * @brief Answers the requests read from a stream, one per line, until it ends
+     * @param in Requests; blank lines are skipped
+     * @param out Responses, one per line, in completion order
+     * @return The number of requests answered
+     */
+    std::size_t Serve(std::istream &in, std::ostream &out);
+
+    /**
+     * @brief Listens on a Unix domain socket and serves every connection like Serve()
+     * @param path Socket file; an existing socket at this path is replaced
+     * @return False if the socket can't be set up or another kind of file exists
+     *         at path; otherwise runs until accepting fails
+     *
+     * At most 64 connections are served at once; further clients wait in the
+     * listen backlog until one closes. Responses are sent by a writer thread per
+     * connection, so a client that doesn't read its responses never stalls the
+     * workers; once too many of them are unsent, or a send blocks for too long,
+     * its connection is closed. Before returning, waits for the open connections
+     * to end. A request line longer than 64 KiB is answered with a "request too
+     * long" error and closes its connection. Only available on POSIX systems; returns false elsewhere.
+     */
+    bool ServeSocket(const std::string &path);
+
+    /**
+     * @brief Makes a running ServeSocket() stop accepting connections and return
+     *
+     * Does nothing if no socket is being served.
+     */
+    void StopSocket();
+
+  private:
+    struct Job {
+        std::string request;  ///< Request line
+        Respond respond;      ///< Destination of the response
+    };
+
+    /**
+     * @brief Answers one request with a given planner
+     */
+    std::string Handle(std::string_view request, GraphPlanner &planner) const;
+
+    /**
+     * @brief Serves one socket connection until the client closes it
+     */
+    void ServeConnection(int fd);
+
+    /**
+     * @brief Unregisters and closes the listening socket of ServeSocket()
+     */
+    void StopServing(int listener);
+
+    void Run();
+
+    RouteGraph m_Graph;                  ///< Road network
+    SegmentIndex m_Index;                ///< Snaps positions onto m_Graph
+    std::size_t m_Capacity;              ///< Largest number of queued requests
+    std::mutex m_Mutex;                  ///< Guards m_Jobs and m_Stopping
+    std::condition_variable m_Ready;     ///< Signals new jobs or shutdown
+    std::condition_variable m_Space;     ///< Signals a free queue slot
+    std::deque<Job> m_Jobs;              ///< Pending requests
+    bool m_Stopping = false;             ///< Set by the destructor
+    std::vector<std::thread> m_Workers;  ///< Worker threads
+    std::mutex m_ListenerMutex;          ///< Guards m_Listener
+    int m_Listener = -1;                 ///< Socket ServeSocket() accepts on, or -1
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "reach.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace {
+
+// Grows every node's reach with the reaches it has in the shortest-path tree of one source.
+class TreeScanner {
+  public:
+    explicit TreeScanner(const RouteGraph &graph) : m_Graph(graph), m_Height(graph.NumNodes()) {
+        m_Space.Resize(graph.NumNodes());
+    }
+
+    void Scan(int source, std::vector<double> &reach) {
+        // Full Dijkstra from the source, recording the settle order.
+        m_Order.clear();
+        m_Space.NewQuery();
+        m_Open.clear();
+        m_Space.Reach(source, 0.f, -1);
+        m_Open.push(source, 0.f);
+        while (!m_Open.empty()) {
+            const int v = m_Open.pop().second;
+            if (m_Space.Settled(v))
+                continue;
+            m_Space.Settle(v);
+            m_Order.push_back(v);
+            for (auto e = m_Graph.FirstOut(v); e < m_Graph.FirstOut(v + 1); ++e) {
+                const int w = m_Graph.Head(e);
+                const float g_w = m_Space.G(v) + m_Graph.Weight(e);
+                if (!m_Space.Settled(w) && (!m_Space.Reached(w) || g_w < m_Space.G(w))) {
+                    m_Space.Reach(w, g_w, v);
+                    m_Open.push(w, g_w);
+                }
+            }
+        }
+
+        // Children are settled after their parent, so a reverse sweep sees every subtree complete.
+        for (auto v : m_Order)
+            m_Height[v] = 0.f;
+        for (auto it = m_Order.rbegin(); it != m_Order.rend(); ++it) {
+            const int v = *it;
+            const auto depth = m_Space.G(v);
+            reach[v] = std::max(reach[v], static_cast<double>(std::min(depth, m_Height[v])));
+            const int parent = m_Space.Parent(v);
+            if (parent >= 0)
+                m_Height[parent] = std::max(m_Height[parent], m_Height[v] + depth - m_Space.G(parent));
+        }
+    }
+
+  private:
+    const RouteGraph &m_Graph;
+    SearchSpace m_Space;
+    BinaryHeapQueue<int, float> m_Open;
+    std::vector<float> m_Height;
+    std::vector<int> m_Order;
+};
+
+}  // namespace
+
+ReachBounds ReachBounds::Compute(const RouteGraph &graph, unsigned threads)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    const int n = graph.NumNodes();
+
+    // Every worker keeps its own maxima; they are merged at the end.
+    std::vector<std::vector<double>> partial(threads, std::vector<double>(n, 0.));
+    std::atomic<int> next_source{0};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t)
+        workers.emplace_back([&, t] {
+            TreeScanner scanner{graph};
+            for (int s = next_source++; s < n; s = next_source++)
+                scanner.Scan(s, partial[t]);
+        });
+    for (auto &worker : workers)
+        worker.join();
+
+    std::vector<float> reach(n);
+    for (int v = 0; v < n; ++v) {
+        double r = 0.;
+        for (const auto &p : partial)
+            r = std::max(r, p[v]);
+        const auto meters = r * graph.MetricScale();
+        reach[v] = static_cast<float>(meters * (1. + kRelativeSlack) + kAbsoluteSlack);
+    }
+    ReachBounds bounds;
+    bounds.m_Reach = std::move(reach);
+    return bounds;
+}
+
+void ReachBounds::Save(ArtifactWriter &writer) const
+{
+    writer.AddArray("reach.bounds", m_Reach);
+}
+
+std::optional<ReachBounds> ReachBounds::Load(const ArtifactFile &file, const RouteGraph &graph)
+{
+    auto reach = file.Array<float>("reach.bounds");
+    if (!reach || static_cast<int>(reach->size()) != graph.NumNodes())
+        return std::nullopt;
+    ReachBounds bounds;
+    bounds.m_Reach = std::move(*reach);
+    return bounds;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file reach.h
+ * @brief Reach bounds and reach-based pruning for long-distance queries
+ *
+ * The reach of a node v is the largest value of min(d(s, v), d(v, t)) over
+ * all shortest s-t paths through v. Local residential nodes only appear near
+ * the ends of long shortest paths and therefore have a small reach, so a
+ * query may skip a node whose reach is below both its distance from the
+ * source and a lower bound of its distance to the target.
+ */
+
+#ifndef REACH_H
+#define REACH_H
+
+#include <optional>
+#include <vector>
+#include "artifact_store.h"
+#include "graph_planner.h"
+#include "route_graph.h"
+
+/**
+ * @class ReachBounds
+ * @brief Per-node upper bounds on reach, in meters
+ */
+class ReachBounds {
+  public:
+    /**
+     * @brief Computes reach bounds from one shortest-path tree per node
+     * @param graph The graph to preprocess
+     * @param threads Number of worker threads; 0 selects the hardware concurrency
+     * @return The bounds
+     *
+     * Exact reaches are padded by kRelativeSlack and kAbsoluteSlack so that
+     * float rounding and integer cost rounding in the query never prune a
+     * node that lies on a shortest path. Preprocessing time is quadratic in
+     * the number of nodes; on large maps compute once and persist with Save().
+     */
+    static ReachBounds Compute(const RouteGraph &graph, unsigned threads = 0);
+
+    /**
+     * @brief Returns the reach bound of a node in meters
+     */
+    float Reach(int v) const noexcept { return m_Reach[v]; }
+
+    /**
+     * @brief Returns the number of nodes covered
+     */
+    int Size() const noexcept { return static_cast<int>(m_Reach.size()); }
+
+    /**
+     * @brief Adds the bounds as a section of an artifact file
+     */
+    void Save(ArtifactWriter &writer) const;
+
+    /**
+     * @brief Restores bounds saved with Save()
+     * @param file A validated artifact file
+     * @param graph The graph the bounds were computed for
+     * @return The bounds, or nullopt if the section is missing or has the wrong size
+     */
+    static std::optional<ReachBounds> Load(const ArtifactFile &file, const RouteGraph &graph);
+
+    static constexpr double kRelativeSlack = 1e-4;  ///< Relative padding of every bound
+    static constexpr double kAbsoluteSlack = 1.;    ///< Absolute padding of every bound in meters
+
+  private:
+    MappedArray<float> m_Reach;  ///< Reach bound per graph node, in meters
+};
+
+/**
+ * @struct ReachPruning
+ * @brief Pruning policy skipping nodes whose reach bound is too small
+ *
+ * Composes with any admissible heuristic: the heuristic value doubles as
+ * the lower bound on the distance to the target.
+ */
+struct ReachPruning {
+    const ReachBounds *bounds = nullptr;  ///< Bounds of the searched graph
+
+    bool operator()(int w, double g_meters, double h_meters) const noexcept {
+        const double reach = bounds->Reach(w);
+        return reach < g_meters && reach < h_meters;
+    }
+};
+
+/**
+ * @brief A* planner with reach-based pruning; construct with ReachPruning{&bounds}
+ */
+using ReachGraphPlanner = BasicGraphPlanner<EuclideanDistance, BinaryHeapQueue, StopAtGoal, FloatCosts, ReachPruning>;
+
+#endif
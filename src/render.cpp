@@ -1,19 +1,23 @@
 #include "render.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 
-static float RoadMetricWidth(Model::Road::Type type);
-static io2d::rgba_color RoadColor(Model::Road::Type type);
-static io2d::dashes RoadDashes(Model::Road::Type type);
 static io2d::point_2d ToPoint2D( const Model::Node &node ) noexcept; 
 
 Render::Render( RouteModel &model ):
-    m_Model(model)
+    m_Model(model),
+    m_Index(model),
+    m_Lod(model)
 {
     BuildRoadReps();
     BuildLanduseBrushes();
+    for( auto &color: kHeatmapColors )
+        m_HeatmapBrushes.emplace_back(ToRgba(color));
 }
 
-io2d::interpreted_path Render::PathLine() const
+io2d::interpreted_path Render::PathLine(const io2d::matrix_2d &matrix) const
 {    
     if( m_Model.path.empty() )
         return {};
@@ -21,7 +25,7 @@ io2d::interpreted_path Render::PathLine() const
     const auto nodes = m_Model.path;    
     
     auto pb = io2d::path_builder{};
-    pb.matrix(m_Matrix);
+    pb.matrix(matrix);
     pb.new_figure( ToPoint2D( m_Model.path[0]));
 
     for( int i=1; i< m_Model.path.size();i++ )
@@ -31,105 +35,209 @@ io2d::interpreted_path Render::PathLine() const
     return io2d::interpreted_path{pb};
 }
 
-io2d::interpreted_path Render::PathFromWay(const Model::Way &way) const
+void Render::AppendWay(io2d::path_builder &pb, int way, int band) const
 {    
-    if( way.nodes.empty() )
-        return {};
+    const auto way_nodes = m_Lod.Nodes(band, way);
+    if( way_nodes.empty() )
+        return;
 
     const auto nodes = m_Model.Nodes().data();    
-    
-    auto pb = io2d::path_builder{};
-    pb.matrix(m_Matrix);
-    pb.new_figure( ToPoint2D(nodes[way.nodes.front()]) );
-    for( auto it = ++way.nodes.begin(); it != std::end(way.nodes); ++it )
+    pb.new_figure( ToPoint2D(nodes[way_nodes.front()]) );
+    for( auto it = way_nodes.begin() + 1; it != way_nodes.end(); ++it )
         pb.line( ToPoint2D(nodes[*it]) );     
-    return io2d::interpreted_path{pb};
 }
 
-io2d::interpreted_path Render::PathFromMP(const Model::Multipolygon &mp) const
+void Render::AppendMP(io2d::path_builder &pb, const Model::Multipolygon &mp, int band) const
 {
     const auto nodes = m_Model.Nodes().data();
-    const auto ways = m_Model.Ways().data();
 
-    auto pb = io2d::path_builder{};    
-    pb.matrix(m_Matrix);    
-    
-    auto commit = [&](const Model::Way &way) {
-        if( way.nodes.empty() )
-            return;
-        pb.new_figure( ToPoint2D(nodes[way.nodes.front()]) );
-        for( auto it = ++way.nodes.begin(); it != std::end(way.nodes); ++it )
-            pb.line( ToPoint2D(nodes[*it]) );        
-        pb.close_figure();        
+    // Outer rings run counterclockwise and holes clockwise, so the nonzero fill of a path
+    // holding many polygons is their union regardless of how the data orients them.
+    auto commit = [&](int way_num, bool counterclockwise) {
+        bool first = true;
+        m_Lod.VisitRing(band, way_num, counterclockwise, [&](int n) {
+            if( first )
+                pb.new_figure( ToPoint2D(nodes[n]) );
+            else
+                pb.line( ToPoint2D(nodes[n]) );
+            first = false;
+        });
+        if( !first )
+            pb.close_figure();        
     };
     
     for( auto way_num: mp.outer )
-        commit( ways[way_num] );
+        commit( way_num, true );
     for( auto way_num: mp.inner )
-        commit( ways[way_num] );
-    
-    return io2d::interpreted_path{pb};
+        commit( way_num, false );
 }
 
-void Render::BuildRoadReps()
+void Render::VisibleFeatures(FeatureLayer layer, const Viewport &viewport, const PixelRect &rect, std::vector<int> &features) const
 {
-    using R = Model::Road;
-    auto types = {R::Motorway, R::Trunk, R::Primary,  R::Secondary, R::Tertiary,
-        R::Residential, R::Service, R::Unclassified, R::Footway};
-    for( auto type: types ) {
-        auto &rep = m_RoadReps[type];
-        rep.brush = io2d::brush{ RoadColor(type) };
-        rep.metric_width = RoadMetricWidth(type);  
-        rep.dashes = RoadDashes(type);
+    m_Index.QueryVisible(layer, viewport.Bounds(rect.x, rect.y, rect.width, rect.height), viewport.Scale(),
+                         m_Model.MetricScale(), WidestMetricWidth(), m_MinFeaturePixels, features);
+}
+
+bool Render::IsEmpty(const Viewport &viewport) const
+{
+    if( !m_Model.path.empty() || (m_Trace && !m_Trace->expansions.empty()) )
+        return false;
+    std::vector<int> features;
+    for( int layer = 0; layer < kFeatureLayers; ++layer ) {
+        VisibleFeatures(static_cast<FeatureLayer>(layer), viewport, {0, 0, viewport.width, viewport.height}, features);
+        if( !features.empty() )
+            return false;
     }
+    return true;
 }
 
-void Render::BuildLanduseBrushes()
+std::size_t Render::CountVisibleFeatures(const Viewport &viewport) const
 {
-    m_LanduseBrushes.insert_or_assign(Model::Landuse::Commercial, io2d::brush{io2d::rgba_color{233, 195, 196}});
-    m_LanduseBrushes.insert_or_assign(Model::Landuse::Construction, io2d::brush{io2d::rgba_color{187, 188, 165}});
-    m_LanduseBrushes.insert_or_assign(Model::Landuse::Grass, io2d::brush{io2d::rgba_color{197, 236, 148}});
-    m_LanduseBrushes.insert_or_assign(Model::Landuse::Forest, io2d::brush{io2d::rgba_color{158, 201, 141}});    
-    m_LanduseBrushes.insert_or_assign(Model::Landuse::Industrial, io2d::brush{io2d::rgba_color{223, 197, 220}});
-    m_LanduseBrushes.insert_or_assign(Model::Landuse::Railway, io2d::brush{io2d::rgba_color{223, 197, 220}});
-    m_LanduseBrushes.insert_or_assign(Model::Landuse::Residential, io2d::brush{io2d::rgba_color{209, 209, 209}});
+    std::size_t count = 0;
+    std::vector<int> features;
+    for( int layer = 0; layer < kFeatureLayers; ++layer ) {
+        VisibleFeatures(static_cast<FeatureLayer>(layer), viewport, {0, 0, viewport.width, viewport.height}, features);
+        count += features.size();
+    }
+    return count;
 }
 
-static float RoadMetricWidth(Model::Road::Type type)
+Render::DisplayList Render::BuildDisplayList(const Viewport &viewport, const PixelRect &rect) const
 {
-    switch( type ) {
-        case Model::Road::Motorway:     return 6.f;
-        case Model::Road::Trunk:        return 6.f;
-        case Model::Road::Primary:      return 5.f;
-        case Model::Road::Secondary:    return 5.f;    
-        case Model::Road::Tertiary:     return 4.f;
-        case Model::Road::Residential:  return 2.5f;
-        case Model::Road::Unclassified: return 2.5f;            
-        case Model::Road::Service:      return 1.f;
-        case Model::Road::Footway:      return 0.f;
-        default:                        return 1.f;            
+    DisplayList list;
+    list.viewport = viewport;
+    list.scale = static_cast<float>(viewport.Scale());
+    list.pixels_in_meter = static_cast<float>(list.scale / m_Model.MetricScale());
+    list.matrix = io2d::matrix_2d::create_translate({-static_cast<float>(viewport.center_x), -static_cast<float>(viewport.center_y)}) *
+                  io2d::matrix_2d::create_scale({list.scale, -list.scale}) *
+                  io2d::matrix_2d::create_translate({viewport.width / 2.f - rect.x, viewport.height / 2.f - rect.y});
+
+    // Simplify to half a pixel.
+    const int band = m_Lod.Band(0.5 / list.scale);
+    std::vector<int> visible;
+    auto query = [&](FeatureLayer layer) -> const std::vector<int> & {
+        VisibleFeatures(layer, viewport, rect, visible);
+        return visible;
+    };
+
+    auto new_path = [&] {
+        io2d::path_builder pb;
+        pb.matrix(list.matrix);
+        return pb;
+    };
+    // Merges all visible features of a layer into one path.
+    auto merge = [&](FeatureLayer layer, auto append) -> std::optional<io2d::interpreted_path> {
+        if( query(layer).empty() )
+            return std::nullopt;
+        auto pb = new_path();
+        for( auto i: visible )
+            append(pb, i);
+        return io2d::interpreted_path{pb};
+    };
+
+    // Land uses of one type are merged while they follow each other, which keeps the drawing order.
+    query(FeatureLayer::Landuse);
+    auto landuses = new_path();
+    const io2d::brush *landuse_brush = nullptr;
+    for( auto i: visible ) {
+        auto &landuse = m_Model.Landuses()[i];
+        auto br = m_LanduseBrushes.find(landuse.type);
+        if( br == m_LanduseBrushes.end() )
+            continue;
+        if( &br->second != landuse_brush ) {
+            if( landuse_brush )
+                list.landuses.push_back({landuse_brush, io2d::interpreted_path{landuses}});
+            landuse_brush = &br->second;
+            landuses = new_path();
+        }
+        AppendMP(landuses, landuse, band);
     }
+    if( landuse_brush )
+        list.landuses.push_back({landuse_brush, io2d::interpreted_path{landuses}});
+
+    list.leisures = merge(FeatureLayer::Leisure, [&](auto &pb, int i) { AppendMP(pb, m_Model.Leisures()[i], band); });
+    list.waters = merge(FeatureLayer::Water, [&](auto &pb, int i) { AppendMP(pb, m_Model.Waters()[i], band); });
+    list.railways = merge(FeatureLayer::Railway, [&](auto &pb, int i) { AppendWay(pb, m_Model.Railways()[i].way, band); });
+
+    // Roads are sorted by type, so every type becomes a single stroke.
+    query(FeatureLayer::Road);
+    auto roads = new_path();
+    const RoadRep *road_rep = nullptr;
+    auto commit_roads = [&] {
+        auto width = road_rep->metric_width > 0.f ? (road_rep->metric_width * list.pixels_in_meter) : 1.f;
+        list.roads.push_back({road_rep, io2d::stroke_props{width, io2d::line_cap::round}, io2d::interpreted_path{roads}});
+    };
+    for( auto i: visible ) {
+        auto &road = m_Model.Roads()[i];
+        auto rep_it = m_RoadReps.find(road.type);
+        if( rep_it == m_RoadReps.end() )
+            continue;
+        if( &rep_it->second != road_rep ) {
+            if( road_rep )
+                commit_roads();
+            road_rep = &rep_it->second;
+            roads = new_path();
+        }
+        AppendWay(roads, road.way, band);
+    }
+    if( road_rep )
+        commit_roads();
+
+    list.buildings = merge(FeatureLayer::Building, [&](auto &pb, int i) { AppendMP(pb, m_Model.Buildings()[i], band); });
+    return list;
 }
 
-static io2d::rgba_color RoadColor(Model::Road::Type type)
+RgbaImage Render::ReadPixels(io2d::image_surface &surface)
 {
-    switch( type) {
-        case Model::Road::Motorway:     return io2d::rgba_color{226, 122, 143};
-        case Model::Road::Trunk:        return io2d::rgba_color{245, 161, 136};
-        case Model::Road::Primary:      return io2d::rgba_color{249, 207, 144};
-        case Model::Road::Secondary:    return io2d::rgba_color{244, 251, 173};    
-        case Model::Road::Tertiary:     return io2d::rgba_color{244, 251, 173};
-        case Model::Road::Residential:  return io2d::rgba_color{254, 254, 254};
-        case Model::Road::Service:      return io2d::rgba_color{254, 254, 254};
-        case Model::Road::Footway:      return io2d::rgba_color{241, 106, 96};    
-        case Model::Road::Unclassified: return io2d::rgba_color{254, 254, 254};
-        default:                        return io2d::rgba_color::grey;  
+    RgbaImage image;
+    surface.map([&](io2d::mapped_surface &mapped) {
+        const bool opaque = mapped.format() == io2d::format::xrgb32;
+        image.width = mapped.width();
+        image.height = mapped.height();
+        image.pixels.resize(static_cast<std::size_t>(image.width) * image.height * 4);
+        auto out = image.pixels.data();
+        for( int y = 0; y < image.height; ++y ) {
+            const auto row = mapped.data() + static_cast<std::size_t>(y) * mapped.stride();
+            for( int x = 0; x < image.width; ++x, out += 4 ) {
+                std::uint32_t argb;
+                std::memcpy(&argb, row + 4 * x, sizeof(argb));
+                const std::uint32_t a = opaque ? 255u : argb >> 24;
+                std::uint32_t r = (argb >> 16) & 255u, g = (argb >> 8) & 255u, b = argb & 255u;
+                if( a != 0u && a != 255u ) {
+                    r = (r * 255u + a / 2u) / a;
+                    g = (g * 255u + a / 2u) / a;
+                    b = (b * 255u + a / 2u) / a;
+                }
+                out[0] = static_cast<std::uint8_t>(r);
+                out[1] = static_cast<std::uint8_t>(g);
+                out[2] = static_cast<std::uint8_t>(b);
+                out[3] = static_cast<std::uint8_t>(a);
+            }
+        }
+    });
+    return image;
+}
+
+void Render::BuildRoadReps()
+{
+    using R = Model::Road;
+    auto types = {R::Motorway, R::Trunk, R::Primary,  R::Secondary, R::Tertiary,
+        R::Residential, R::Service, R::Unclassified, R::Footway};
+    for( auto type: types ) {
+        auto &rep = m_RoadReps[type];
+        rep.brush = io2d::brush{ ToRgba(RoadColor(type)) };
+        rep.metric_width = RoadMetricWidth(type);  
+        rep.dashes = io2d::dashes{0.f, RoadDashes(type)};
     }
 }
 
-static io2d::dashes RoadDashes(Model::Road::Type type)
+void Render::BuildLanduseBrushes()
 {
-    return type == Model::Road::Footway ? io2d::dashes{0.f, {1.f, 2.f}} : io2d::dashes{};   
+    using L = Model::Landuse;
+    auto types = {L::Commercial, L::Construction, L::Grass, L::Forest, L::Industrial, L::Railway, L::Residential};
+    for( auto type: types )
+        if( auto color = LanduseColor(type) )
+            m_LanduseBrushes.insert_or_assign(type, io2d::brush{ToRgba(*color)});
 }
 
 static io2d::point_2d ToPoint2D( const Model::Node &node ) noexcept
@@ -8,9 +8,23 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 #include <io2d.h>
+#include "feature_index.h"
+#include "geometry_lod.h"
+#include "map_style.h"
+#include "png_writer.h"
 #include "route_model.h"
+#include "search_trace.h"
+#include "viewport.h"
 
 using namespace std::experimental;
 
@@ -21,6 +35,13 @@ using namespace std::experimental;
  * The Render class is responsible for drawing all visual elements of the map
  * including roads, buildings, water bodies, and the calculated route path.
  * It uses the IO2D library for 2D graphics rendering.
+ *
+ * The static map layers are built once per viewport into a display list and
+ * rasterized into a cached base bitmap. Later frames of the same view only
+ * copy the bitmap and draw the route and its markers on top. A spatial
+ * index over the features limits the list to what the viewport can show,
+ * ways are drawn at the level of detail that matches the zoom, and features
+ * smaller than a pixel are skipped.
  */
 class Render
 {
@@ -42,21 +63,165 @@ public:
      */
     template <typename T>
     void Display( T &surface ) {
-        m_Scale = static_cast<float>(std::min(surface.dimensions().x(), surface.dimensions().y()));    
-        m_PixelsInMeter = static_cast<float>(m_Scale / m_Model.MetricScale()); 
-        m_Matrix = io2d::matrix_2d::create_scale({m_Scale, -m_Scale}) *
-                   io2d::matrix_2d::create_translate({0.f, static_cast<float>(surface.dimensions().y())});
-        
-        surface.paint(m_BackgroundFillBrush);        
-        DrawLanduses(surface);
-        DrawLeisure(surface);
-        DrawWater(surface);    
-        DrawRailways(surface);
-        DrawHighways(surface);    
-        DrawBuildings(surface);  
-        DrawPath(surface);
-        DrawStartPosition(surface);   
-        DrawEndPosition(surface);
+        Display(surface, Viewport::Fit(surface.dimensions().x(), surface.dimensions().y()));
+    }
+
+    /**
+     * @brief Renders the part of the map and route inside a viewport
+     * @tparam T The surface type (must support IO2D operations)
+     * @param surface Reference to the rendering surface
+     * @param viewport The visible area; its pixel size should match the surface
+     */
+    template <typename T>
+    void Display( T &surface, const Viewport &viewport ) {
+        if( !m_DisplayList || m_DisplayList->viewport != viewport ) {
+            auto list = BuildDisplayList(viewport, {0, 0, viewport.width, viewport.height});
+            io2d::image_surface base{io2d::format::argb32, viewport.width, viewport.height};
+            DrawBase(base, list);
+            m_BaseLayer.emplace(std::move(base));
+            m_DisplayList = std::move(list);
+        }
+        surface.paint(*m_BaseLayer);
+        DrawOverlay(surface, *m_DisplayList);
+    }
+
+    /**
+     * @brief Renders a viewport without reading or updating the display list cache
+     * @tparam T The surface type (must support IO2D operations)
+     * @param surface Reference to the rendering surface
+     * @param viewport The visible area; its pixel size should match the surface
+     *
+     * Only reads the model and the styles, so several threads may call it at
+     * once, e.g. to render independent map tiles.
+     */
+    template <typename T>
+    void DisplayUncached( T &surface, const Viewport &viewport ) const {
+        Draw(surface, BuildDisplayList(viewport, {0, 0, viewport.width, viewport.height}));
+    }
+
+    /**
+     * @brief Renders the part of the map and route inside a viewport tile by tile on worker threads
+     * @tparam T The surface type (must support IO2D operations)
+     * @param surface Reference to the rendering surface
+     * @param viewport The visible area; its pixel size should match the surface
+     * @param tile_size Edge length of the square tiles in pixels
+     * @param threads Number of threads including the caller, 0 for one per hardware thread
+     *
+     * Every tile builds its own display list and draws into its own image
+     * surface, with the viewport's transform shifted by the tile's whole-pixel
+     * offset. Features crossing a border are drawn into every tile they touch,
+     * so the composed image has no seams. Tiles are composed onto the surface
+     * on the calling thread. The display list cache is not used. If fewer
+     * threads can be started than requested, the ones that started draw all tiles.
+     */
+    template <typename T>
+    void DisplayTiled( T &surface, const Viewport &viewport, int tile_size = 256, unsigned threads = 0 ) const {
+        tile_size = std::max(tile_size, 1);
+        const int columns = (viewport.width + tile_size - 1) / tile_size;
+        const int rows = (viewport.height + tile_size - 1) / tile_size;
+        const int count = columns * rows;
+        auto tile_rect = [&](int t) {
+            const int x = t % columns * tile_size, y = t / columns * tile_size;
+            return PixelRect{x, y, std::min(tile_size, viewport.width - x), std::min(tile_size, viewport.height - y)};
+        };
+
+        std::vector<std::optional<io2d::image_surface>> tiles(count);
+        std::atomic<int> next{0};
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        auto work = [&] {
+            try {
+                for( int t; (t = next++) < count; ) {
+                    const auto rect = tile_rect(t);
+                    io2d::image_surface tile{io2d::format::argb32, rect.width, rect.height};
+                    Draw(tile, BuildDisplayList(viewport, rect));
+                    tiles[t].emplace(std::move(tile));
+                }
+            }
+            catch( ... ) {
+                std::lock_guard lock{error_mutex};
+                error = std::current_exception();
+                next = count;
+            }
+        };
+        if( threads == 0 )
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        // If a thread can't be started, the tiles are shared among those that could;
+        // the started workers must be joined either way.
+        std::vector<std::thread> workers;
+        workers.reserve(std::min<unsigned>(threads, count));
+        for( unsigned i = 1; i < std::min<unsigned>(threads, count); ++i ) {
+            try {
+                workers.emplace_back(work);
+            }
+            catch( const std::system_error & ) {
+                break;
+            }
+        }
+        work();
+        for( auto &worker: workers )
+            worker.join();
+        if( error )
+            std::rethrow_exception(error);
+
+        for( int t = 0; t < count; ++t ) {
+            const auto rect = tile_rect(t);
+            io2d::brush_props props;
+            props.brush_matrix(io2d::matrix_2d::create_translate({-static_cast<float>(rect.x), -static_cast<float>(rect.y)}));
+            props.filter(io2d::filter::nearest);
+            auto pb = io2d::path_builder{};
+            pb.new_figure({static_cast<float>(rect.x), static_cast<float>(rect.y)});
+            pb.rel_line({static_cast<float>(rect.width), 0.f});
+            pb.rel_line({0.f, static_cast<float>(rect.height)});
+            pb.rel_line({-static_cast<float>(rect.width), 0.f});
+            pb.close_figure();
+            surface.fill(io2d::brush{std::move(*tiles[t])}, pb, props);
+        }
+    }
+
+    /**
+     * @brief Checks whether a viewport would show nothing but the background
+     *
+     * Uses the same culling as drawing; a route or a shown search trace
+     * counts as content.
+     */
+    bool IsEmpty(const Viewport &viewport) const;
+
+    /**
+     * @brief Returns the number of map features left after culling a viewport
+     *
+     * Uses the same culling as drawing; the route and search trace are not
+     * counted. Depends only on the model, so it measures render work the
+     * same way on every host.
+     */
+    std::size_t CountVisibleFeatures(const Viewport &viewport) const;
+
+    /**
+     * @brief Draws the nodes a search expanded as a heatmap under the route
+     * @param trace Recorded by a planner's SetTrace(); nullptr hides the heatmap.
+     *              Must stay alive while it is shown.
+     *
+     * Dots are colored from blue for the first expanded nodes to red for the
+     * last. The heatmap is redrawn on every frame with the route, so a new
+     * trace shows up without invalidating the cached base layer.
+     */
+    void ShowSearchTrace(const SearchTrace *trace) noexcept { m_Trace = trace; }
+
+    /**
+     * @brief Copies the pixels of a surface for PNG encoding
+     *
+     * Converts io2d's premultiplied, native-endian ARGB to straight RGBA, so
+     * the image can be handed to an AsyncPngWriter while the surface is
+     * reused for the next frame.
+     */
+    static RgbaImage ReadPixels(io2d::image_surface &surface);
+
+    /**
+     * @brief Drops the cached base layer, e.g. after the model's features changed
+     */
+    void Invalidate() noexcept {
+        m_DisplayList.reset();
+        m_BaseLayer.reset();
     }
     
 private:
@@ -73,121 +238,178 @@ private:
      * Creates color brushes for commercial, residential, forest areas, etc.
      */
     void BuildLanduseBrushes();
+
+    /**
+     * @brief Converts a color of the map style to io2d
+     */
+    static io2d::rgba_color ToRgba(const MapColor &color) noexcept {
+        return io2d::rgba_color{color.r, color.g, color.b};
+    }
     
+    struct DisplayList;
+
+    /**
+     * @struct PixelRect
+     * @brief A rectangle of surface pixels
+     */
+    struct PixelRect {
+        int x = 0;       ///< Left edge
+        int y = 0;       ///< Top edge
+        int width = 0;   ///< Width in pixels
+        int height = 0;  ///< Height in pixels
+    };
+
+    /**
+     * @brief Draws a display list onto a surface
+     * @tparam T The surface type
+     * @param surface Reference to the rendering surface
+     * @param list Paths to draw
+     *
+     * Only reads the list and the styles, so several threads may draw at once.
+     */
+    template <typename T>
+    void Draw(T &surface, const DisplayList &list) const {
+        DrawBase(surface, list);
+        DrawOverlay(surface, list);
+    }
+
+    /**
+     * @brief Draws the background and the static map layers
+     * @tparam T The surface type
+     * @param surface Reference to the rendering surface
+     * @param list Paths to draw
+     */
+    template <typename T>
+    void DrawBase(T &surface, const DisplayList &list) const {
+        surface.paint(m_BackgroundFillBrush);        
+        DrawLanduses(surface, list);
+        DrawLeisure(surface, list);
+        DrawWater(surface, list);    
+        DrawRailways(surface, list);
+        DrawHighways(surface, list);    
+        DrawBuildings(surface, list);  
+    }
+
+    /**
+     * @brief Draws the route and its start and end markers
+     * @tparam T The surface type
+     * @param surface Reference to the rendering surface
+     * @param list Provides the transform
+     */
+    template <typename T>
+    void DrawOverlay(T &surface, const DisplayList &list) const {
+        DrawSearchTrace(surface, list);
+        DrawPath(surface, list);
+        DrawStartPosition(surface, list);   
+        DrawEndPosition(surface, list);
+    }
+
     /**
      * @brief Draws all buildings on the surface
      * @tparam T The surface type
      * @param surface Reference to the rendering surface
+     * @param list Paths to draw
      */
     template <typename T>
-    void DrawBuildings(T &surface) const {
-        for( auto &building: m_Model.Buildings() ) {
-            auto path = PathFromMP(building);
-            surface.fill(m_BuildingFillBrush, path);        
-            surface.stroke(m_BuildingOutlineBrush, path, std::nullopt, m_BuildingOutlineStrokeProps);
-        }
+    void DrawBuildings(T &surface, const DisplayList &list) const {
+        if( !list.buildings ) return;
+        surface.fill(m_BuildingFillBrush, *list.buildings);        
+        surface.stroke(m_BuildingOutlineBrush, *list.buildings, std::nullopt, m_BuildingOutlineStrokeProps);
     }
 
     /**
      * @brief Draws all roads (highways) on the surface
      * @tparam T The surface type
      * @param surface Reference to the rendering surface
+     * @param list Paths to draw
      * 
-     * Renders roads with appropriate styling based on their classification.
+     * Renders roads with appropriate styling based on their classification,
+     * one stroke per road type.
      */
     template <typename T>
-    void DrawHighways(T &surface) const {
-        auto ways = m_Model.Ways().data();
-        for( auto road: m_Model.Roads() )
-            if( auto rep_it = m_RoadReps.find(road.type); rep_it != m_RoadReps.end() ) {
-                auto &rep = rep_it->second;   
-                auto &way = ways[road.way];
-                auto width = rep.metric_width > 0.f ? (rep.metric_width * m_PixelsInMeter) : 1.f;
-                auto sp = io2d::stroke_props{width, io2d::line_cap::round};
-                surface.stroke(rep.brush, PathFromWay(way), std::nullopt, sp, rep.dashes);        
-            }
+    void DrawHighways(T &surface, const DisplayList &list) const {
+        for( auto &road: list.roads )
+            surface.stroke(road.rep->brush, road.path, std::nullopt, road.props, road.rep->dashes);        
     }
 
     /**
      * @brief Draws all railway lines on the surface
      * @tparam T The surface type
      * @param surface Reference to the rendering surface
+     * @param list Paths to draw
      * 
      * Renders railways with a distinctive dashed line pattern.
      */
     template <typename T>
-    void DrawRailways(T &surface) const {     
-        auto ways = m_Model.Ways().data();
-        for( auto &railway: m_Model.Railways() ) {
-            auto &way = ways[railway.way];
-            auto path = PathFromWay(way);
-            surface.stroke(m_RailwayStrokeBrush, path, std::nullopt, io2d::stroke_props{m_RailwayOuterWidth * m_PixelsInMeter});
-            surface.stroke(m_RailwayDashBrush, path, std::nullopt, io2d::stroke_props{m_RailwayInnerWidth * m_PixelsInMeter}, m_RailwayDashes);
-        }
+    void DrawRailways(T &surface, const DisplayList &list) const {     
+        if( !list.railways ) return;
+        surface.stroke(m_RailwayStrokeBrush, *list.railways, std::nullopt, io2d::stroke_props{m_RailwayOuterWidth * list.pixels_in_meter});
+        surface.stroke(m_RailwayDashBrush, *list.railways, std::nullopt, io2d::stroke_props{m_RailwayInnerWidth * list.pixels_in_meter}, m_RailwayDashes);
     }
 
     /**
      * @brief Draws all leisure areas on the surface
      * @tparam T The surface type
      * @param surface Reference to the rendering surface
+     * @param list Paths to draw
      * 
      * Renders parks, sports facilities, and other leisure areas.
      */
     template <typename T>
-    void DrawLeisure(T &surface) const {
-        for( auto &leisure: m_Model.Leisures()) {
-            auto path = PathFromMP(leisure);
-            surface.fill(m_LeisureFillBrush, path);        
-            surface.stroke(m_LeisureOutlineBrush, path, std::nullopt, m_LeisureOutlineStrokeProps);
-        }
+    void DrawLeisure(T &surface, const DisplayList &list) const {
+        if( !list.leisures ) return;
+        surface.fill(m_LeisureFillBrush, *list.leisures);        
+        surface.stroke(m_LeisureOutlineBrush, *list.leisures, std::nullopt, m_LeisureOutlineStrokeProps);
     }
 
     /**
      * @brief Draws all water bodies on the surface
      * @tparam T The surface type
      * @param surface Reference to the rendering surface
+     * @param list Paths to draw
      * 
      * Renders lakes, rivers, and other water features.
      */
     template <typename T>
-    void DrawWater(T &surface) const {
-        for( auto &water: m_Model.Waters())
-            surface.fill(m_WaterFillBrush, PathFromMP(water));
+    void DrawWater(T &surface, const DisplayList &list) const {
+        if( list.waters )
+            surface.fill(m_WaterFillBrush, *list.waters);
     }
 
     /**
      * @brief Draws all land use areas on the surface
      * @tparam T The surface type
      * @param surface Reference to the rendering surface
+     * @param list Paths to draw
      * 
      * Renders different land use types with appropriate colors.
      */
     template <typename T>
-    void DrawLanduses(T &surface) const {
-        for( auto &landuse: m_Model.Landuses() )
-            if( auto br = m_LanduseBrushes.find(landuse.type); br != m_LanduseBrushes.end() )        
-                surface.fill(br->second, PathFromMP(landuse));
+    void DrawLanduses(T &surface, const DisplayList &list) const {
+        for( auto &[brush, path]: list.landuses )
+            surface.fill(*brush, path);
     }
 
     /**
      * @brief Draws the starting position marker on the surface
      * @tparam T The surface type
      * @param surface Reference to the rendering surface
+     * @param list Paths to draw
      * 
      * Renders a green square marker at the start of the calculated path.
      */
     template <typename T>
-    void DrawStartPosition(T &surface) const {
+    void DrawStartPosition(T &surface, const DisplayList &list) const {
         if (m_Model.path.empty()) return;
 
         io2d::render_props aliased{ io2d::antialias::none };
-        io2d::brush foreBrush{ io2d::rgba_color::green };
+        io2d::brush foreBrush{ ToRgba(kStartColor) };
 
         auto pb = io2d::path_builder{}; 
-        pb.matrix(m_Matrix);
+        pb.matrix(list.matrix);
 
         pb.new_figure({(float) m_Model.path.front().x, (float) m_Model.path.front().y});
-        float constexpr l_marker = 0.01f;
+        float constexpr l_marker = kMarkerSize;
         pb.rel_line({l_marker, 0.f});
         pb.rel_line({0.f, l_marker});
         pb.rel_line({-l_marker, 0.f});
@@ -202,20 +424,21 @@ private:
      * @brief Draws the ending position marker on the surface
      * @tparam T The surface type
      * @param surface Reference to the rendering surface
+     * @param list Paths to draw
      * 
      * Renders a red square marker at the end of the calculated path.
      */
     template <typename T>
-    void DrawEndPosition(T &surface) const {
+    void DrawEndPosition(T &surface, const DisplayList &list) const {
         if (m_Model.path.empty()) return;
         io2d::render_props aliased{ io2d::antialias::none };
-        io2d::brush foreBrush{ io2d::rgba_color::red };
+        io2d::brush foreBrush{ ToRgba(kEndColor) };
 
         auto pb = io2d::path_builder{}; 
-        pb.matrix(m_Matrix);
+        pb.matrix(list.matrix);
 
         pb.new_figure({(float) m_Model.path.back().x, (float) m_Model.path.back().y});
-        float constexpr l_marker = 0.01f;
+        float constexpr l_marker = kMarkerSize;
         pb.rel_line({l_marker, 0.f});
         pb.rel_line({0.f, l_marker});
         pb.rel_line({-l_marker, 0.f});
@@ -226,63 +449,109 @@ private:
         surface.stroke(foreBrush, io2d::interpreted_path{pb}, std::nullopt, std::nullopt, std::nullopt, aliased);
     }
 
+    /**
+     * @brief Draws the expanded nodes of the shown search trace
+     * @tparam T The surface type
+     * @param surface Reference to the rendering surface
+     * @param list Paths to draw
+     *
+     * Splits the expansions into one run per heatmap color and fills every
+     * run as a single path of dots.
+     */
+    template <typename T>
+    void DrawSearchTrace(T &surface, const DisplayList &list) const {
+        if( !m_Trace || m_Trace->expansions.empty() ) return;
+
+        const auto &expansions = m_Trace->expansions;
+        const float dot = kHeatmapDotSize / list.scale;
+        const auto bounds = list.viewport.Bounds().Expanded(dot);
+        const auto colors = m_HeatmapBrushes.size();
+        for( std::size_t color = 0; color < colors; ++color ) {
+            auto pb = io2d::path_builder{};
+            pb.matrix(list.matrix);
+            bool empty = true;
+            for( auto i = expansions.size() * color / colors, last = expansions.size() * (color + 1) / colors; i < last; ++i ) {
+                const auto &e = expansions[i];
+                if( e.x < bounds.min_x || e.x > bounds.max_x || e.y < bounds.min_y || e.y > bounds.max_y )
+                    continue;
+                pb.new_figure({e.x - dot / 2.f, e.y - dot / 2.f});
+                pb.rel_line({dot, 0.f});
+                pb.rel_line({0.f, dot});
+                pb.rel_line({-dot, 0.f});
+                pb.close_figure();
+                empty = false;
+            }
+            if( !empty )
+                surface.fill(m_HeatmapBrushes[color], pb);
+        }
+    }
+
     /**
      * @brief Draws the calculated route path on the surface
      * @tparam T The surface type
      * @param surface Reference to the rendering surface
+     * @param list Paths to draw
      * 
      * Renders the path found by the A* algorithm as an orange line.
      */
     template <typename T>
-    void DrawPath(T &surface) const {
+    void DrawPath(T &surface, const DisplayList &list) const {
         io2d::render_props aliased{ io2d::antialias::none };
-        io2d::brush foreBrush{ io2d::rgba_color::orange}; 
-        float width = 5.0f;
-        surface.stroke(foreBrush, PathLine(), std::nullopt, io2d::stroke_props{width});
+        io2d::brush foreBrush{ ToRgba(kRouteColor) }; 
+        float width = kRouteWidth;
+        surface.stroke(foreBrush, PathLine(list.matrix), std::nullopt, io2d::stroke_props{width});
     }
 
     /**
-     * @brief Converts a Way to an IO2D path
-     * @param way The way to convert
-     * @return An IO2D interpreted path object
+     * @brief Appends a Way to a path as an open figure
+     * @param pb The path to extend; its matrix maps the map to the surface
+     * @param way Index of the way to append
+     * @param band Level of detail, see GeometryLod
      */
-    io2d::interpreted_path PathFromWay(const Model::Way &way) const;
+    void AppendWay(io2d::path_builder &pb, int way, int band) const;
     
     /**
-     * @brief Converts a Multipolygon to an IO2D path
-     * @param mp The multipolygon to convert
-     * @return An IO2D interpreted path object
+     * @brief Appends the rings of a Multipolygon to a path as closed figures
+     * @param pb The path to extend; its matrix maps the map to the surface
+     * @param mp The multipolygon to append
+     * @param band Level of detail, see GeometryLod
+     *
+     * Rings are oriented so that filling a path of several multipolygons
+     * with the nonzero rule fills their union and keeps their holes.
      */
-    io2d::interpreted_path PathFromMP(const Model::Multipolygon &mp) const;
+    void AppendMP(io2d::path_builder &pb, const Model::Multipolygon &mp, int band) const;
     
     /**
      * @brief Creates an IO2D path from the calculated route
+     * @param matrix Map to surface transform
      * @return An IO2D interpreted path representing the route
      */
-    io2d::interpreted_path PathLine() const;
+    io2d::interpreted_path PathLine(const io2d::matrix_2d &matrix) const;
 
     RouteModel &m_Model;           ///< Reference to the route model
-    float m_Scale = 1.f;           ///< Scaling factor for rendering
-    float m_PixelsInMeter = 1.f;   ///< Conversion factor from meters to pixels
-    io2d::matrix_2d m_Matrix;      ///< Transformation matrix for coordinate mapping
+    FeatureIndex m_Index;          ///< Bounding boxes of the map features
+    GeometryLod m_Lod;             ///< Simplified way geometry per zoom band
+    float m_MinFeaturePixels = 1.f;  ///< Features whose box is smaller than this are not drawn
+    const SearchTrace *m_Trace = nullptr;  ///< Expansions drawn as a heatmap, if set
+    std::vector<io2d::brush> m_HeatmapBrushes;  ///< Heatmap colors from first to last expansion
     
-    io2d::brush m_BackgroundFillBrush{ io2d::rgba_color{238, 235, 227} };  ///< Background color brush
+    io2d::brush m_BackgroundFillBrush{ ToRgba(kBackgroundColor) };  ///< Background color brush
     
-    io2d::brush m_BuildingFillBrush{ io2d::rgba_color{208, 197, 190} };      ///< Building fill color
-    io2d::brush m_BuildingOutlineBrush{ io2d::rgba_color{181, 167, 154} };   ///< Building outline color
-    io2d::stroke_props m_BuildingOutlineStrokeProps{1.f};                    ///< Building outline stroke properties
+    io2d::brush m_BuildingFillBrush{ ToRgba(kBuildingFillColor) };         ///< Building fill color
+    io2d::brush m_BuildingOutlineBrush{ ToRgba(kBuildingOutlineColor) };   ///< Building outline color
+    io2d::stroke_props m_BuildingOutlineStrokeProps{kBuildingOutlineWidth};  ///< Building outline stroke properties
     
-    io2d::brush m_LeisureFillBrush{ io2d::rgba_color{189, 252, 193} };       ///< Leisure area fill color
-    io2d::brush m_LeisureOutlineBrush{ io2d::rgba_color{160, 248, 162} };    ///< Leisure area outline color
-    io2d::stroke_props m_LeisureOutlineStrokeProps{1.f};                     ///< Leisure area outline stroke properties
+    io2d::brush m_LeisureFillBrush{ ToRgba(kLeisureFillColor) };           ///< Leisure area fill color
+    io2d::brush m_LeisureOutlineBrush{ ToRgba(kLeisureOutlineColor) };     ///< Leisure area outline color
+    io2d::stroke_props m_LeisureOutlineStrokeProps{kLeisureOutlineWidth};  ///< Leisure area outline stroke properties
 
-    io2d::brush m_WaterFillBrush{ io2d::rgba_color{155, 201, 215} };         ///< Water body fill color
+    io2d::brush m_WaterFillBrush{ ToRgba(kWaterFillColor) };               ///< Water body fill color
         
-    io2d::brush m_RailwayStrokeBrush{ io2d::rgba_color{93,93,93} };          ///< Railway outer stroke color
-    io2d::brush m_RailwayDashBrush{ io2d::rgba_color::white };               ///< Railway dash line color
-    io2d::dashes m_RailwayDashes{0.f, {3.f, 3.f}};                           ///< Railway dash pattern
-    float m_RailwayOuterWidth = 3.f;                                         ///< Railway outer line width
-    float m_RailwayInnerWidth = 2.f;                                         ///< Railway inner line width
+    io2d::brush m_RailwayStrokeBrush{ ToRgba(kRailwayStrokeColor) };       ///< Railway outer stroke color
+    io2d::brush m_RailwayDashBrush{ ToRgba(kRailwayDashColor) };           ///< Railway dash line color
+    io2d::dashes m_RailwayDashes{0.f, {kRailwayDash, kRailwayDash}};       ///< Railway dash pattern
+    float m_RailwayOuterWidth = kRailwayOuterWidth;                        ///< Railway outer line width
+    float m_RailwayInnerWidth = kRailwayInnerWidth;                        ///< Railway inner line width
     
     /**
      * @struct RoadRep
@@ -298,4 +567,54 @@ private:
     std::unordered_map<Model::Road::Type, RoadRep> m_RoadReps;  ///< Road rendering styles by type
     
     std::unordered_map<Model::Landuse::Type, io2d::brush> m_LanduseBrushes;  ///< Brushes for land use types
+
+    /**
+     * @struct DisplayList
+     * @brief Paths of the visible features of every map layer, built for one viewport
+     *
+     * Styles and the transform are resolved while building, so drawing needs
+     * no map lookups and no state outside the list. Features that share a
+     * style are merged into one multi-figure path, so a layer costs one
+     * fill or stroke per style instead of one per feature.
+     */
+    struct DisplayList {
+        /**
+         * @struct Road
+         * @brief The paths of one road type with its resolved style
+         */
+        struct Road {
+            const RoadRep *rep;               ///< Style of the road type
+            io2d::stroke_props props;         ///< Stroke width in pixels
+            io2d::interpreted_path path;      ///< Geometry of all roads of the type
+        };
+
+        Viewport viewport;                    ///< Viewport the paths were built for
+        io2d::matrix_2d matrix;               ///< Map to surface transform
+        float scale = 1.f;                    ///< Pixels per normalized unit
+        float pixels_in_meter = 1.f;          ///< Conversion factor from meters to pixels
+        std::vector<std::pair<const io2d::brush *, io2d::interpreted_path>> landuses;  ///< Land use fills, one per run of a type
+        std::optional<io2d::interpreted_path> leisures;   ///< Leisure areas, if any are visible
+        std::optional<io2d::interpreted_path> waters;     ///< Water bodies, if any are visible
+        std::optional<io2d::interpreted_path> railways;   ///< Railway lines, if any are visible
+        std::vector<Road> roads;                          ///< Roads by type, in drawing order
+        std::optional<io2d::interpreted_path> buildings;  ///< Buildings, if any are visible
+    };
+    std::optional<DisplayList> m_DisplayList;  ///< Paths of the cached base layer, rebuilt when the viewport changes
+    std::optional<io2d::brush> m_BaseLayer;    ///< Rasterized static layers of m_DisplayList's viewport
+
+    /**
+     * @brief Builds the paths of the features inside part of a viewport
+     * @param viewport The visible area
+     * @param rect The pixels to cover; the list's transform maps rect's corner to the origin
+     */
+    DisplayList BuildDisplayList(const Viewport &viewport, const PixelRect &rect) const;
+
+    /**
+     * @brief Finds the features of a layer that can show up in part of a viewport
+     * @param layer The layer to search
+     * @param viewport The visible area
+     * @param rect The pixels to cover
+     * @param features Receives the feature indices in drawing order
+     */
+    void VisibleFeatures(FeatureLayer layer, const Viewport &viewport, const PixelRect &rect, std::vector<int> &features) const;
 };
\ No newline at end of file
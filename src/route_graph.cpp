@@ -0,0 +1,183 @@
+#include "route_graph.h"
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+// Interleaves the bits of two 16-bit values into a Z-order key.
+static std::uint32_t MortonKey(double x, double y)
+{
+    auto quantize = [](double v) {
+        return static_cast<std::uint32_t>(std::clamp(v, 0., 1.) * 65535.);
+    };
+    auto spread = [](std::uint32_t v) {
+        v = (v | (v << 8)) & 0x00FF00FFu;
+        v = (v | (v << 4)) & 0x0F0F0F0Fu;
+        v = (v | (v << 2)) & 0x33333333u;
+        v = (v | (v << 1)) & 0x55555555u;
+        return v;
+    };
+    return spread(quantize(x)) | (spread(quantize(y)) << 1);
+}
+
+RouteGraph::RouteGraph(const Model &model) : m_Model(&model)
+{
+    const auto &nodes = model.Nodes();
+    const auto &ways = model.Ways();
+
+    // Collect the routable nodes and every undirected road segment.
+    std::vector<char> routable(nodes.size(), 0);
+    std::vector<std::pair<int, int>> segments;
+    for (const Model::Road &road : model.Roads()) {
+        if (road.type == Model::Road::Type::Footway)
+            continue;
+        const auto &way_nodes = ways[road.way].nodes;
+        for (std::size_t i = 0; i < way_nodes.size(); ++i) {
+            routable[way_nodes[i]] = 1;
+            if (i > 0 && way_nodes[i - 1] != way_nodes[i]) {
+                segments.emplace_back(way_nodes[i - 1], way_nodes[i]);
+                segments.emplace_back(way_nodes[i], way_nodes[i - 1]);
+            }
+        }
+    }
+
+    // Number the routable nodes in Z-order.
+    std::vector<int> model_index;
+    for (int i = 0; i < static_cast<int>(nodes.size()); ++i)
+        if (routable[i])
+            model_index.push_back(i);
+    std::stable_sort(model_index.begin(), model_index.end(), [&](int a, int b) {
+        return MortonKey(nodes[a].x, nodes[a].y) < MortonKey(nodes[b].x, nodes[b].y);
+    });
+
+    const auto n = static_cast<int>(model_index.size());
+    std::vector<int> graph_node(nodes.size(), -1);
+    std::vector<float> x(n), y(n);
+    for (int v = 0; v < n; ++v) {
+        graph_node[model_index[v]] = v;
+        x[v] = static_cast<float>(nodes[model_index[v]].x);
+        y[v] = static_cast<float>(nodes[model_index[v]].y);
+    }
+
+    // Build the adjacency arrays, dropping parallel segments.
+    for (auto &segment : segments)
+        segment = {graph_node[segment.first], graph_node[segment.second]};
+    std::sort(segments.begin(), segments.end());
+    segments.erase(std::unique(segments.begin(), segments.end()), segments.end());
+
+    std::vector<std::uint32_t> first_out(n + 1, 0);
+    for (const auto &segment : segments)
+        ++first_out[segment.first + 1];
+    for (int v = 0; v < n; ++v)
+        first_out[v + 1] += first_out[v];
+    std::vector<int> head;
+    head.reserve(segments.size());
+    for (const auto &segment : segments)
+        head.push_back(segment.second);
+
+    m_X = std::move(x);
+    m_Y = std::move(y);
+    m_FirstOut = std::move(first_out);
+    m_Head = std::move(head);
+    m_ModelIndex = std::move(model_index);
+    m_GraphNode = std::move(graph_node);
+}
+
+void RouteGraph::SetWeights(std::vector<float> weight, double cost_unit)
+{
+    m_CostUnit = cost_unit;
+    m_IntegerScale = MetricScale() / cost_unit;
+    std::vector<std::uint32_t> int_weight(weight.size());
+    for (std::size_t e = 0; e < weight.size(); ++e) {
+        const auto units = std::ceil(static_cast<double>(weight[e]) * m_IntegerScale);
+        int_weight[e] = static_cast<std::uint32_t>(std::min(units, double(std::numeric_limits<std::uint32_t>::max())));
+    }
+    m_Weight = std::move(weight);
+    m_IntWeight = std::move(int_weight);
+}
+
+void RouteGraph::Save(ArtifactWriter &writer) const
+{
+    writer.AddValue("graph.cost_unit", m_CostUnit);
+    writer.AddArray("graph.x", m_X);
+    writer.AddArray("graph.y", m_Y);
+    writer.AddArray("graph.first_out", m_FirstOut);
+    writer.AddArray("graph.head", m_Head);
+    writer.AddArray("graph.weight", m_Weight);
+    writer.AddArray("graph.int_weight", m_IntWeight);
+    writer.AddArray("graph.model_index", m_ModelIndex);
+    writer.AddArray("graph.graph_node", m_GraphNode);
+}
+
+std::optional<RouteGraph> RouteGraph::Load(const ArtifactFile &file, const Model &model)
+{
+    auto cost_unit = file.Value<double>("graph.cost_unit");
+    auto x = file.Array<float>("graph.x");
+    auto y = file.Array<float>("graph.y");
+    auto first_out = file.Array<std::uint32_t>("graph.first_out");
+    auto head = file.Array<int>("graph.head");
+    auto weight = file.Array<float>("graph.weight");
+    auto int_weight = file.Array<std::uint32_t>("graph.int_weight");
+    auto model_index = file.Array<int>("graph.model_index");
+    auto graph_node = file.Array<int>("graph.graph_node");
+    if (!cost_unit || !x || !y || !first_out || !head || !weight || !int_weight || !model_index || !graph_node)
+        return std::nullopt;
+
+    // Reject arrays that would make the search read out of bounds.
+    const auto n = x->size();
+    const auto m = head->size();
+    if (y->size() != n || first_out->size() != n + 1 || (*first_out)[0] != 0 || (*first_out)[n] != m ||
+        weight->size() != m || int_weight->size() != m || model_index->size() != n ||
+        graph_node->size() != model.Nodes().size() || *cost_unit <= 0.)
+        return std::nullopt;
+    for (std::size_t v = 0; v < n; ++v)
+        if ((*first_out)[v] > (*first_out)[v + 1] || (*model_index)[v] < 0 ||
+            (*model_index)[v] >= static_cast<int>(graph_node->size()))
+            return std::nullopt;
+    for (auto w : *head)
+        if (w < 0 || w >= static_cast<int>(n))
+            return std::nullopt;
+    // GraphNode() results are used as node ids, and ModelIndex() must map back to them.
+    for (auto v : *graph_node)
+        if (v < -1 || v >= static_cast<int>(n))
+            return std::nullopt;
+    for (std::size_t v = 0; v < n; ++v)
+        if ((*graph_node)[(*model_index)[v]] != static_cast<int>(v))
+            return std::nullopt;
+
+    RouteGraph graph;
+    graph.m_Model = &model;
+    graph.m_X = std::move(*x);
+    graph.m_Y = std::move(*y);
+    graph.m_FirstOut = std::move(*first_out);
+    graph.m_Head = std::move(*head);
+    graph.m_Weight = std::move(*weight);
+    graph.m_IntWeight = std::move(*int_weight);
+    graph.m_CostUnit = *cost_unit;
+    graph.m_IntegerScale = model.MetricScale() / *cost_unit;
+    graph.m_ModelIndex = std::move(*model_index);
+    graph.m_GraphNode = std::move(*graph_node);
+    return graph;
+}
+
+std::uint64_t RouteGraph::Fingerprint(const Model &model, std::string_view metric, double cost_unit)
+{
+    auto fingerprint = CombineFingerprint(ModelFingerprint(model), "RouteGraph");
+    fingerprint = CombineFingerprint(fingerprint, metric);
+    return Fnv1a64(&cost_unit, sizeof(cost_unit), fingerprint);
+}
+
+int RouteGraph::ClosestNode(float x, float y) const noexcept
+{
+    float min_dist = std::numeric_limits<float>::max();
+    int closest = -1;
+    for (int v = 0; v < NumNodes(); ++v) {
+        const auto dx = m_X[v] - x;
+        const auto dy = m_Y[v] - y;
+        const auto dist = dx * dx + dy * dy;
+        if (dist < min_dist) {
+            min_dist = dist;
+            closest = v;
+        }
+    }
+    return closest;
+}
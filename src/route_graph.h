@@ -0,0 +1,227 @@
+/**
+ * @file route_graph.h
+ * @brief Compact structure-of-arrays road graph for routing
+ *
+ * This file contains the RouteGraph class, a read-only adjacency-array (CSR)
+ * view of the drivable road network of a Model. Every per-node attribute lives
+ * in its own array indexed by a dense node id, so the search only pulls the
+ * fields it actually touches into the cache.
+ */
+
+#ifndef ROUTE_GRAPH_H
+#define ROUTE_GRAPH_H
+
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "artifact_store.h"
+#include "model.h"
+#include "planner_policies.h"
+
+/**
+ * @class RouteGraph
+ * @brief Drivable road network stored as parallel arrays
+ *
+ * Nodes are the Model nodes that lie on non-footway roads, renumbered in
+ * Morton (Z-order) so that nodes close on the map are close in memory. Two
+ * nodes are connected when they are consecutive on a road way; every edge is
+ * stored in both directions.
+ */
+class RouteGraph {
+  public:
+    /**
+     * @brief Builds the graph with edge weights measured by a metric
+     * @tparam Metric Distance metric policy (see planner_policies.h)
+     * @param model The model to extract the road network from
+     * @param cost_unit Length of one integer cost unit in meters
+     * @return The graph, with float weights in normalized map units and
+     *         integer weights in cost units
+     */
+    template <typename Metric = EuclideanDistance>
+    static RouteGraph Build(const Model &model, double cost_unit = kDefaultCostUnit) {
+        RouteGraph graph{model};
+        const Metric metric{model};
+        std::vector<float> weight(graph.m_Head.size());
+        for (int v = 0; v < graph.NumNodes(); ++v)
+            for (auto e = graph.m_FirstOut[v]; e < graph.m_FirstOut[v + 1]; ++e) {
+                const auto w = graph.m_Head[e];
+                weight[e] = metric(graph.m_X[v], graph.m_Y[v], graph.m_X[w], graph.m_Y[w]);
+            }
+        graph.SetWeights(std::move(weight), cost_unit);
+        return graph;
+    }
+
+    /**
+     * @brief Loads the graph from an artifact file, building and saving it if stale
+     * @tparam Metric Distance metric policy (see planner_policies.h), named by its kName
+     * @param model The model to extract the road network from
+     * @param path The artifact file caching the graph
+     * @param cost_unit Length of one integer cost unit in meters
+     * @return The graph; its arrays are mapped from the file when it was valid
+     *
+     * The file is keyed by the model fingerprint, the metric and the cost unit,
+     * so editing the map or changing the parameters triggers a rebuild.
+     */
+    template <typename Metric = EuclideanDistance>
+    static RouteGraph LoadOrBuild(const Model &model, const std::string &path, double cost_unit = kDefaultCostUnit) {
+        const auto fingerprint = Fingerprint(model, Metric::kName, cost_unit);
+        if (auto file = ArtifactFile::Open(path, fingerprint))
+            if (auto graph = Load(*file, model))
+                return std::move(*graph);
+
+        auto graph = Build<Metric>(model, cost_unit);
+        ArtifactWriter writer;
+        graph.Save(writer);
+        writer.Write(path, fingerprint);
+        return graph;
+    }
+
+    /**
+     * @brief Adds the graph arrays as sections of an artifact file
+     */
+    void Save(ArtifactWriter &writer) const;
+
+    /**
+     * @brief Restores a graph saved with Save() without copying its arrays
+     * @param file A validated artifact file
+     * @param model The model the file was built from
+     * @return The graph, or nullopt if sections are missing or inconsistent
+     */
+    static std::optional<RouteGraph> Load(const ArtifactFile &file, const Model &model);
+
+    /**
+     * @brief Returns the artifact fingerprint of a graph built with these parameters
+     *
+     * The cost unit is hashed bit for bit, so any two distinct values give
+     * distinct fingerprints.
+     */
+    static std::uint64_t Fingerprint(const Model &model, std::string_view metric, double cost_unit);
+
+    static constexpr double kDefaultCostUnit = 0.001;  ///< Integer cost unit in meters (millimetres)
+
+    /**
+     * @brief Returns the number of nodes in the graph
+     */
+    int NumNodes() const noexcept { return static_cast<int>(m_X.size()); }
+
+    /**
+     * @brief Returns the number of directed edges in the graph
+     */
+    int NumEdges() const noexcept { return static_cast<int>(m_Head.size()); }
+
+    /**
+     * @brief Returns the normalized x-coordinate of a node
+     */
+    float X(int v) const noexcept { return m_X[v]; }
+
+    /**
+     * @brief Returns the normalized y-coordinate of a node
+     */
+    float Y(int v) const noexcept { return m_Y[v]; }
+
+    /**
+     * @brief Returns the index of the first outgoing edge of a node
+     *
+     * The outgoing edges of v are [FirstOut(v), FirstOut(v + 1)).
+     */
+    std::uint32_t FirstOut(int v) const noexcept { return m_FirstOut[v]; }
+
+    /**
+     * @brief Returns the target node of an edge
+     */
+    int Head(std::uint32_t e) const noexcept { return m_Head[e]; }
+
+    /**
+     * @brief Returns the weight of an edge in normalized map units
+     */
+    float Weight(std::uint32_t e) const noexcept { return m_Weight[e]; }
+
+    /**
+     * @brief Returns the weight of an edge in integer cost units
+     *
+     * Integer weights are the float weights converted to CostUnit() and
+     * rounded up, so an integer heuristic rounded down (IntegerCost()) stays
+     * admissible and consistent.
+     */
+    std::uint32_t IntWeight(std::uint32_t e) const noexcept { return m_IntWeight[e]; }
+
+    /**
+     * @brief Returns the length of one integer cost unit in meters
+     */
+    double CostUnit() const noexcept { return m_CostUnit; }
+
+    /**
+     * @brief Converts a normalized lower-bound distance to integer cost units
+     * @param distance A distance in normalized map units
+     * @return The distance in cost units, rounded down
+     */
+    std::uint32_t IntegerCost(float distance) const noexcept {
+        return static_cast<std::uint32_t>(std::floor(distance * m_IntegerScale));
+    }
+
+    /**
+     * @brief Returns the Model node index of a graph node
+     */
+    int ModelIndex(int v) const noexcept { return m_ModelIndex[v]; }
+
+    /**
+     * @brief Returns the graph node of a Model node, or -1 if it is not routable
+     */
+    int GraphNode(int model_index) const noexcept {
+        return model_index >= 0 && model_index < static_cast<int>(m_GraphNode.size()) ? m_GraphNode[model_index] : -1;
+    }
+
+    /**
+     * @brief Finds the graph node closest to the given coordinates
+     * @param x The x-coordinate (normalized longitude)
+     * @param y The y-coordinate (normalized latitude)
+     * @return The closest node id, or -1 for an empty graph
+     */
+    int ClosestNode(float x, float y) const noexcept;
+
+    /**
+     * @brief Returns the model the graph was built from
+     */
+    const Model &Source() const noexcept { return *m_Model; }
+
+    /**
+     * @brief Returns the scale factor from normalized units to meters
+     */
+    double MetricScale() const noexcept { return m_Model->MetricScale(); }
+
+  private:
+    /**
+     * @brief Extracts the topology and coordinates; weights are left empty
+     * @param model The model to extract the road network from
+     */
+    explicit RouteGraph(const Model &model);
+
+    /**
+     * @brief Creates an empty graph to be filled by Load()
+     */
+    RouteGraph() = default;
+
+    /**
+     * @brief Stores the float weights and derives the integer weights from them
+     * @param weight Edge weights in normalized units
+     * @param cost_unit Length of one integer cost unit in meters
+     */
+    void SetWeights(std::vector<float> weight, double cost_unit);
+
+    const Model *m_Model = nullptr;             ///< Source model
+    MappedArray<float> m_X;                     ///< Node x-coordinates
+    MappedArray<float> m_Y;                     ///< Node y-coordinates
+    MappedArray<std::uint32_t> m_FirstOut;      ///< CSR offsets, NumNodes() + 1 entries
+    MappedArray<int> m_Head;                    ///< Edge targets
+    MappedArray<float> m_Weight;                ///< Edge weights in normalized units
+    MappedArray<std::uint32_t> m_IntWeight;     ///< Edge weights in integer cost units
+    double m_CostUnit = kDefaultCostUnit;       ///< Meters per integer cost unit
+    double m_IntegerScale = 1.;                 ///< Normalized units to integer cost units
+    MappedArray<int> m_ModelIndex;              ///< Graph node to Model node index
+    MappedArray<int> m_GraphNode;               ///< Model node index to graph node (-1 if absent)
+};
+
+#endif
@@ -23,15 +23,28 @@ void RouteModel::CreateNodeToRoadHashmap() {
             }
         }
     }
+    for (const auto &[node_idx, roads] : node_to_road)
+        m_Nodes[node_idx].neighbors.reserve(roads.size());
 }
 
 
-RouteModel::Node *RouteModel::Node::FindNeighbor(std::vector<int> node_indices) {
+void RouteModel::ResetSearch() {
+    for (auto &node : m_Nodes) {
+        node.parent = nullptr;
+        node.h_value = std::numeric_limits<float>::max();
+        node.g_value = 0.f;
+        node.visited = false;
+        node.neighbors.clear();
+    }
+    path.clear();
+}
+
+
+RouteModel::Node *RouteModel::Node::FindNeighbor(const std::vector<int> &node_indices) {
     Node *closest_node = nullptr;
-    Node node;
 
     for (int node_index : node_indices) {
-        node = parent_model->SNodes()[node_index];
+        const Node &node = parent_model->SNodes()[node_index];
         if (this->distance(node) != 0 && !node.visited) {
             if (closest_node == nullptr || this->distance(node) < this->distance(*closest_node)) {
                 closest_node = &parent_model->SNodes()[node_index];
@@ -43,7 +56,11 @@ RouteModel::Node *RouteModel::Node::FindNeighbor(std::vector<int> node_indices)
 
 
 void RouteModel::Node::FindNeighbors() {
-    for (auto & road : parent_model->node_to_road[this->index]) {
+    // find() rather than operator[], which would insert (and allocate) for nodes off the road network.
+    auto roads = parent_model->node_to_road.find(this->index);
+    if (roads == parent_model->node_to_road.end())
+        return;
+    for (auto & road : roads->second) {
         RouteModel::Node *new_neighbor = this->FindNeighbor(parent_model->Ways()[road->way].nodes);
         if (new_neighbor) {
             this->neighbors.emplace_back(new_neighbor);
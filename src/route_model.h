@@ -55,10 +55,28 @@ class RouteModel : public Model {
          * @param other The other node to measure distance to
          * @return The Euclidean distance between the two nodes
          */
-        float distance(Node other) const {
+        float distance(const Node &other) const {
             return std::sqrt(std::pow((x - other.x), 2) + std::pow((y - other.y), 2));
         }
 
+        /**
+         * @brief Copies another node's position and search state, but not its neighbors
+         * @param other The node to copy
+         *
+         * Path snapshots don't need neighbor lists, and skipping them lets a
+         * reused path buffer be refilled without allocating.
+         */
+        void AssignWithoutNeighbors(const Node &other) {
+            static_cast<Model::Node &>(*this) = other;
+            parent = other.parent;
+            h_value = other.h_value;
+            g_value = other.g_value;
+            visited = other.visited;
+            neighbors.clear();
+            index = other.index;
+            parent_model = other.parent_model;
+        }
+
         /**
          * @brief Default constructor
          */
@@ -80,7 +98,7 @@ class RouteModel : public Model {
          * @param node_indices Vector of node indices to search through
          * @return Pointer to the found neighbor node, or nullptr if not found
          */
-        Node * FindNeighbor(std::vector<int> node_indices);
+        Node * FindNeighbor(const std::vector<int> &node_indices);
         
         RouteModel * parent_model = nullptr;  ///< Pointer to the parent RouteModel
     };
@@ -109,6 +127,14 @@ class RouteModel : public Model {
      * @return Reference to the nodes vector
      */
     auto &SNodes() { return m_Nodes; }
+
+    /**
+     * @brief Clears the search state of every node and the path
+     *
+     * Keeps all buffer capacities, so the next search doesn't allocate for
+     * neighbor lists or the path.
+     */
+    void ResetSearch();
     
     std::vector<Node> path;  ///< The calculated path from start to end
     
@@ -117,7 +143,8 @@ class RouteModel : public Model {
      * @brief Creates a hashmap mapping nodes to roads
      * 
      * Builds an index that maps each node to all roads that pass through it,
-     * enabling efficient neighbor lookup during pathfinding.
+     * enabling efficient neighbor lookup during pathfinding. Also reserves
+     * each node's neighbor list, which holds at most one node per road.
      */
     void CreateNodeToRoadHashmap();
     
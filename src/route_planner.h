@@ -1,9 +1,10 @@
 /**
  * @file route_planner.h
  * @brief A* pathfinding algorithm implementation for route planning
- * 
- * This file contains the RoutePlanner class which implements the A* search
- * algorithm to find the optimal path between two points on the map.
+ *
+ * This file contains the BasicRoutePlanner class template which implements
+ * the A* search algorithm to find the optimal path between two points on the
+ * map, and RoutePlanner, its default instantiation.
  */
 
 #ifndef ROUTE_PLANNER_H
@@ -13,89 +14,270 @@
 #include <vector>
 #include <string>
 #include "route_model.h"
+#include "planner_policies.h"
+#include "search_stats.h"
+#include "search_trace.h"
 
 
 /**
- * @class RoutePlanner
+ * @class BasicRoutePlanner
  * @brief Implements A* pathfinding algorithm for route planning
- * 
- * The RoutePlanner class uses the A* search algorithm to find the shortest
- * path between two points on a RouteModel. It maintains an open list of
- * nodes to explore and calculates both actual (g) and heuristic (h) costs.
+ * @tparam Heuristic Distance metric used as the h value (see planner_policies.h)
+ * @tparam Queue Open-list template, instantiated as Queue<RouteModel::Node *, float>
+ * @tparam EdgeCost Distance metric used for the g value of each step
+ * @tparam Termination Predicate deciding when the search loop ends
+ *
+ * The planner uses the A* search algorithm to find the shortest path between
+ * two points on a RouteModel. It maintains an open list of nodes to explore
+ * and calculates both actual (g) and heuristic (h) costs. All policies are
+ * resolved at compile time, so each combination is fully inlined.
+ *
+ * For repeated queries, keep a Context per thread and model and construct
+ * each planner with it after RouteModel::ResetSearch(): once the buffers
+ * have grown to the largest query, AStarSearch() makes no heap allocations.
  */
-class RoutePlanner {
+template <typename Heuristic = EuclideanDistance,
+          template <typename, typename> class Queue = SortedVectorQueue,
+          typename EdgeCost = EuclideanDistance,
+          typename Termination = StopAtGoal>
+class BasicRoutePlanner {
   public:
     /**
-     * @brief Constructs a RoutePlanner with start and end coordinates
+     * @struct Context
+     * @brief Search buffers reused across the planners of successive queries
+     */
+    struct Context {
+        Context() = default;
+
+        /**
+         * @brief Reserves the open list for every node of a model
+         */
+        explicit Context(const RouteModel &model) { open_list.reserve(model.Nodes().size()); }
+
+        Queue<RouteModel::Node *, float> open_list;  ///< Open list storage
+    };
+
+    /**
+     * @brief Constructs a planner with start and end coordinates
      * @param model Reference to the RouteModel containing the map data
      * @param start_x Starting x-coordinate (normalized longitude)
      * @param start_y Starting y-coordinate (normalized latitude)
      * @param end_x Ending x-coordinate (normalized longitude)
      * @param end_y Ending y-coordinate (normalized latitude)
-     * 
+     *
      * Initializes the route planner by finding the closest nodes on the road
      * network to the specified start and end coordinates.
      */
-    RoutePlanner(RouteModel &model, float start_x, float start_y, float end_x, float end_y);
-    
+    BasicRoutePlanner(RouteModel &model, float start_x, float start_y, float end_x, float end_y)
+        : BasicRoutePlanner(model, m_OwnContext, start_x, start_y, end_x, end_y) {}
+
+    /**
+     * @brief Constructs a planner that keeps its open list in a reused context
+     * @param model Reference to the RouteModel containing the map data
+     * @param context Buffers shared with earlier planners; must outlive this one
+     * @param start_x Starting x-coordinate (normalized longitude)
+     * @param start_y Starting y-coordinate (normalized latitude)
+     * @param end_x Ending x-coordinate (normalized longitude)
+     * @param end_y Ending y-coordinate (normalized latitude)
+     */
+    BasicRoutePlanner(RouteModel &model, Context &context, float start_x, float start_y, float end_x, float end_y)
+        : open_list(context.open_list), m_Model(model), m_Heuristic(model), m_Cost(model) {
+        open_list.clear();
+        // Convert inputs to percentage:
+        start_x *= 0.01;
+        start_y *= 0.01;
+        end_x *= 0.01;
+        end_y *= 0.01;
+
+        StatsTimer timer{m_Stats.snap_seconds};
+        start_node = &m_Model.FindClosestNode(start_x, start_y);
+        end_node = &m_Model.FindClosestNode(end_x, end_y);
+    }
+
+    BasicRoutePlanner(const BasicRoutePlanner &) = delete;
+    BasicRoutePlanner &operator=(const BasicRoutePlanner &) = delete;
+
     /**
      * @brief Returns the total distance of the calculated path
-     * @return The path distance in normalized units
+     * @return The path distance in meters
      */
     float GetDistance() const {return distance;}
-    
+
+    /**
+     * @brief Returns the statistics of the last search (zero unless ROUTE_PLANNER_ENABLE_STATS)
+     */
+    const SearchStats &Stats() const noexcept { return m_Stats; }
+
+    /**
+     * @brief Records the nodes expanded by later searches
+     * @param trace Cleared and filled by every AStarSearch(); nullptr stops recording.
+     *              Must outlive the planner or be detached first.
+     */
+    void SetTrace(SearchTrace *trace) noexcept { m_Trace = trace; }
+
     /**
      * @brief Executes the A* search algorithm to find the optimal path
-     * 
+     *
      * Performs A* search from the start node to the end node, updating
      * the model's path with the result and calculating the total distance.
      */
-    void AStarSearch();
-    
+    void AStarSearch() {
+        m_Stats.ResetSearch();
+        StatsTimer timer{m_Stats.search_seconds};
+        RouteModel::Node *current_node = start_node;
+        std::size_t expansions = 0;
+        if (m_Trace) {
+            m_Trace->Clear();
+            Trace(current_node);
+        }
+
+        current_node->visited = true;
+        AddNeighbors(current_node);
+
+        while (!open_list.empty()) {
+            current_node = NextNode();
+            m_Stats.Expand();
+            if (m_Trace)
+                Trace(current_node);
+            if (m_Terminate(current_node, end_node, ++expansions)) {
+                if (current_node == end_node) {
+                    timer.Stop();
+                    ConstructFinalPath(current_node, m_Model.path);
+                }
+                break;
+            }
+            AddNeighbors(current_node);
+        }
+    }
+
     /**
      * @brief Adds neighboring nodes to the open list
      * @param current_node Pointer to the current node being explored
-     * 
+     *
      * Finds all neighbors of the current node, updates their g and h values,
      * sets their parent pointers, and adds them to the open list.
      */
-    void AddNeighbors(RouteModel::Node *current_node);
-    
+    void AddNeighbors(RouteModel::Node *current_node) {
+        current_node->FindNeighbors();
+        m_Stats.Scan(current_node->neighbors.size());
+
+        for (RouteModel::Node *neighbor : current_node->neighbors) {
+            if (!neighbor->visited) {
+                neighbor->parent = current_node;
+                neighbor->g_value = current_node->g_value + Cost(current_node, neighbor);
+                neighbor->h_value = CalculateHValue(neighbor);
+                open_list.push(neighbor, neighbor->g_value + neighbor->h_value);
+                m_Stats.Push(open_list.size());
+                neighbor->visited = true;
+            }
+        }
+    }
+
     /**
      * @brief Calculates the heuristic (h) value for a node
      * @param node Pointer to the node to calculate h-value for
      * @return The heuristic cost estimate from this node to the goal
-     * 
-     * Uses Euclidean distance as the heuristic function for A* search.
      */
-    float CalculateHValue(RouteModel::Node const *node);
-    
+    float CalculateHValue(RouteModel::Node const *node) {
+        return m_Heuristic(node->x, node->y, end_node->x, end_node->y);
+    }
+
     /**
      * @brief Reconstructs the final path from start to end
      * @param current_node Pointer to the end node
      * @return Vector of nodes representing the path from start to end
-     * 
+     *
      * Traces back through parent pointers from the end node to the start node,
      * building the complete path and calculating the total distance.
      */
-    std::vector<RouteModel::Node> ConstructFinalPath(RouteModel::Node *);
-    
+    std::vector<RouteModel::Node> ConstructFinalPath(RouteModel::Node *current_node) {
+        StatsTimer timer{m_Stats.reconstruction_seconds};
+        distance = 0.0f;
+        std::vector<RouteModel::Node> path_found;
+
+        while (current_node != start_node) {
+            distance += Cost(current_node, current_node->parent);
+            path_found.insert(path_found.begin(), *current_node);
+            current_node = current_node->parent;
+        }
+        path_found.insert(path_found.begin(), *start_node);
+        distance *= m_Model.MetricScale(); // Multiply the distance by the scale of the map to get meters.
+        return path_found;
+    }
+
+    /**
+     * @brief Reconstructs the final path into a reused buffer
+     * @param current_node Pointer to the end node
+     * @param path Receives the nodes from start to end, without their neighbor lists
+     *
+     * Computes the same distance as the returning overload, but fills the
+     * buffer in place instead of inserting at the front, so it runs in linear
+     * time and allocates only if the buffer has to grow.
+     */
+    void ConstructFinalPath(RouteModel::Node *current_node, std::vector<RouteModel::Node> &path) {
+        StatsTimer timer{m_Stats.reconstruction_seconds};
+        distance = 0.0f;
+        std::size_t count = 1;
+        for (auto *node = current_node; node != start_node; node = node->parent)
+            ++count;
+
+        path.resize(count);
+        for (auto i = count - 1; current_node != start_node; --i) {
+            distance += Cost(current_node, current_node->parent);
+            path[i].AssignWithoutNeighbors(*current_node);
+            current_node = current_node->parent;
+        }
+        path[0].AssignWithoutNeighbors(*start_node);
+        distance *= m_Model.MetricScale(); // Multiply the distance by the scale of the map to get meters.
+    }
+
     /**
      * @brief Selects the next node to explore from the open list
      * @return Pointer to the node with the lowest f-value (g + h)
-     * 
-     * Finds and removes the most promising node from the open list based
-     * on the sum of actual cost (g) and heuristic cost (h).
+     *
+     * Removes the most promising node from the open list based on the sum
+     * of actual cost (g) and heuristic cost (h).
      */
-    RouteModel::Node *NextNode();
+    RouteModel::Node *NextNode() {
+        m_Stats.Pop();
+        return open_list.pop().second;
+    }
 
   private:
-    std::vector<RouteModel::Node*> open_list;  ///< List of nodes to be explored
-    RouteModel::Node *start_node;              ///< Pointer to the starting node
-    RouteModel::Node *end_node;                ///< Pointer to the goal node
+    /**
+     * @brief Appends an expanded node to the attached trace
+     */
+    void Trace(const RouteModel::Node *node) {
+        m_Trace->Record(static_cast<int>(node - m_Model.SNodes().data()), static_cast<float>(node->x),
+                        static_cast<float>(node->y));
+    }
+
+    /**
+     * @brief Returns the edge cost between two nodes under the EdgeCost policy
+     */
+    float Cost(RouteModel::Node const *from, RouteModel::Node const *to) const {
+        return m_Cost(from->x, from->y, to->x, to->y);
+    }
+
+    Context m_OwnContext;                         ///< Buffers of a planner constructed without a context
+    Queue<RouteModel::Node *, float> &open_list;  ///< List of nodes to be explored
+    RouteModel::Node *start_node;                ///< Pointer to the starting node
+    RouteModel::Node *end_node;                  ///< Pointer to the goal node
 
     float distance = 0.0f;     ///< Total distance of the calculated path
     RouteModel &m_Model;       ///< Reference to the route model
+    Heuristic m_Heuristic;     ///< Heuristic metric policy
+    EdgeCost m_Cost;           ///< Edge cost metric policy
+    Termination m_Terminate;   ///< Termination policy
+    SearchStats m_Stats;       ///< Statistics of the last search
+    SearchTrace *m_Trace = nullptr;  ///< Receives the expanded nodes, if set
 };
 
-#endif
\ No newline at end of file
+/**
+ * @brief The default planner: Euclidean heuristic and cost, sorted-vector open list
+ */
+using RoutePlanner = BasicRoutePlanner<>;
+
+extern template class BasicRoutePlanner<>;
+
+#endif
@@ -0,0 +1,235 @@
+#include "route_verifier.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <queue>
+#include <random>
+#include "graph_planner.h"
+#include "incremental_planner.h"
+
+namespace {
+
+constexpr double kUnreachable = std::numeric_limits<double>::infinity();
+constexpr std::size_t kMaxExamples = 5;
+
+using Clock = std::chrono::steady_clock;
+
+double Seconds(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * @brief Compares one planner's answers with the reference answers
+ * @param integer True if the mode rounds every edge up to a CostUnit()
+ */
+void Compare(ModeReport &report, const RouteGraph &graph, const DifferentialOptions &options, bool integer,
+             int source, int target, double expected, const GraphPath &path)
+{
+    ++report.queries;
+    const double actual = path.found ? path.distance : kUnreachable;
+    bool match;
+    if (std::isinf(expected) || std::isinf(actual))
+        match = std::isinf(expected) == std::isinf(actual);
+    else {
+        // Distances are reported as float, so allow float precision on top of the tolerance.
+        const double error = std::abs(actual - expected);
+        double tolerance = options.relative_tolerance * expected + 1e-6 * std::max(expected, 1.);
+        if (integer)
+            tolerance += graph.CostUnit() * (path.nodes.size() + 2);
+        report.max_error = std::max(report.max_error, error);
+        match = error <= tolerance;
+    }
+    if (!match) {
+        ++report.mismatches;
+        if (report.examples.size() < kMaxExamples)
+            report.examples.push_back({source, target, expected, actual});
+    }
+}
+
+/**
+ * @brief Runs a node-pair mode over all queries, then compares its answers
+ */
+ModeReport CheckPairs(const std::string &name, const RouteGraph &graph, const DifferentialOptions &options,
+                      bool integer, const std::vector<std::pair<int, int>> &pairs,
+                      const std::vector<double> &expected, double reference_seconds,
+                      const std::function<GraphPath(int, int)> &search)
+{
+    ModeReport report;
+    report.name = name;
+    report.reference_seconds = reference_seconds;
+    std::vector<GraphPath> paths;
+    paths.reserve(pairs.size());
+    const auto start = Clock::now();
+    for (const auto &[s, t] : pairs)
+        paths.push_back(search(s, t));
+    report.seconds = Seconds(start);
+    for (std::size_t i = 0; i < pairs.size(); ++i)
+        Compare(report, graph, options, integer, pairs[i].first, pairs[i].second, expected[i], paths[i]);
+    return report;
+}
+
+}  // namespace
+
+double ReferenceDijkstra::Distance(int source, int target) const
+{
+    if (source < 0 || target < 0)
+        return kUnreachable;
+    return Run({{source, 0.}}, {{target, 0.}}, kUnreachable);
+}
+
+double ReferenceDijkstra::Distance(const EdgeSnap &from, const EdgeSnap &to) const
+{
+    if (from.u < 0 || to.u < 0)
+        return kUnreachable;
+    const double w_from = m_Graph.Weight(from.edge), w_to = m_Graph.Weight(to.edge);
+    double direct = kUnreachable;
+    if (from.u == to.u && from.v == to.v)
+        direct = std::abs(from.t - to.t) * w_from;
+    else if (from.u == to.v && from.v == to.u)
+        direct = std::abs(from.t - (1. - to.t)) * w_from;
+    return Run({{from.u, from.t * w_from}, {from.v, (1. - from.t) * w_from}},
+               {{to.u, to.t * w_to}, {to.v, (1. - to.t) * w_to}},
+               direct * m_Graph.MetricScale());
+}
+
+double ReferenceDijkstra::Run(const std::vector<std::pair<int, double>> &seeds,
+                              const std::vector<std::pair<int, double>> &targets, double best) const
+{
+    const double scale = m_Graph.MetricScale();
+    best /= scale;
+    std::vector<double> dist(m_Graph.NumNodes(), kUnreachable);
+    using Entry = std::pair<double, int>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    for (const auto &[v, d] : seeds)
+        if (d < dist[v]) {
+            dist[v] = d;
+            open.emplace(d, v);
+        }
+
+    while (!open.empty()) {
+        const auto [d, v] = open.top();
+        open.pop();
+        if (d > dist[v])
+            continue;
+        if (d >= best)
+            break;
+        for (const auto &[t, extra] : targets)
+            if (t == v)
+                best = std::min(best, d + extra);
+        for (auto e = m_Graph.FirstOut(v); e < m_Graph.FirstOut(v + 1); ++e) {
+            const int w = m_Graph.Head(e);
+            const double d_w = d + m_Graph.Weight(e);
+            if (d_w < dist[w]) {
+                dist[w] = d_w;
+                open.emplace(d_w, w);
+            }
+        }
+    }
+    return best * scale;
+}
+
+bool DifferentialReport::Ok() const noexcept
+{
+    return std::all_of(modes.begin(), modes.end(), [](const auto &mode) { return mode.mismatches == 0; });
+}
+
+void DifferentialReport::Print(std::ostream &os) const
+{
+    os << std::left << std::setw(24) << "mode" << std::right << std::setw(9) << "queries" << std::setw(12)
+       << "mismatches" << std::setw(14) << "max error m" << std::setw(12) << "mode us" << std::setw(12)
+       << "ref us" << std::setw(10) << "ratio" << "\n";
+    for (const auto &mode : modes) {
+        const double per_query = mode.queries ? 1e6 / mode.queries : 0.;
+        os << std::left << std::setw(24) << mode.name << std::right << std::setw(9) << mode.queries
+           << std::setw(12) << mode.mismatches << std::setw(14) << std::setprecision(3) << std::scientific
+           << mode.max_error << std::fixed << std::setprecision(2) << std::setw(12) << mode.seconds * per_query
+           << std::setw(12) << mode.reference_seconds * per_query << std::setw(10) << mode.LatencyRatio() << "\n";
+        os.unsetf(std::ios::floatfield);
+    }
+    for (const auto &mode : modes)
+        for (const auto &m : mode.examples)
+            os << mode.name << ": " << m.source << " -> " << m.target << " expected " << m.expected
+               << " m, got " << m.actual << " m\n";
+}
+
+DifferentialReport RunDifferential(const RouteGraph &graph, const DifferentialOptions &options)
+{
+    DifferentialReport report;
+    if (graph.NumNodes() == 0)
+        return report;
+
+    std::mt19937_64 rng{options.seed};
+    std::uniform_int_distribution<int> node{0, graph.NumNodes() - 1};
+    std::vector<std::pair<int, int>> pairs(options.queries);
+    for (auto &pair : pairs)
+        pair = {node(rng), node(rng)};
+
+    const ReferenceDijkstra reference{graph};
+    std::vector<double> expected;
+    expected.reserve(pairs.size());
+    auto start = Clock::now();
+    for (const auto &[s, t] : pairs)
+        expected.push_back(reference.Distance(s, t));
+    const double reference_seconds = Seconds(start);
+
+    GraphPlanner astar{graph};
+    report.modes.push_back(CheckPairs("GraphPlanner", graph, options, false, pairs, expected, reference_seconds,
+                                      [&](int s, int t) { return astar.Search(s, t); }));
+    RadixGraphPlanner radix{graph};
+    report.modes.push_back(CheckPairs("RadixGraphPlanner", graph, options, true, pairs, expected, reference_seconds,
+                                      [&](int s, int t) { return radix.Search(s, t); }));
+    if (options.reach) {
+        ReachGraphPlanner reach{graph, ReachPruning{options.reach}};
+        report.modes.push_back(CheckPairs("ReachGraphPlanner", graph, options, false, pairs, expected,
+                                          reference_seconds, [&](int s, int t) { return reach.Search(s, t); }));
+    }
+    if (options.incremental) {
+        IncrementalPlanner incremental{graph};
+        report.modes.push_back(CheckPairs("IncrementalPlanner", graph, options, false, pairs, expected,
+                                          reference_seconds, [&](int s, int t) {
+                                              incremental.Start(s, t);
+                                              return incremental.Plan();
+                                          }));
+    }
+
+    if (options.index) {
+        std::uniform_real_distribution<float> coordinate{0.f, 1.f};
+        std::vector<std::pair<EdgeSnap, EdgeSnap>> snaps;
+        for (std::size_t i = 0; i < options.queries; ++i) {
+            auto from = options.index->Snap(coordinate(rng), coordinate(rng));
+            auto to = options.index->Snap(coordinate(rng), coordinate(rng));
+            if (from && to)
+                snaps.emplace_back(*from, *to);
+        }
+
+        std::vector<double> snapped_expected;
+        start = Clock::now();
+        for (const auto &[from, to] : snaps)
+            snapped_expected.push_back(reference.Distance(from, to));
+        const double snapped_reference_seconds = Seconds(start);
+
+        auto check_snapped = [&](const char *name, auto &planner) {
+            ModeReport mode;
+            mode.name = name;
+            mode.reference_seconds = snapped_reference_seconds;
+            std::vector<GraphPath> paths;
+            start = Clock::now();
+            for (const auto &[from, to] : snaps)
+                paths.push_back(planner.Search(from, to));
+            mode.seconds = Seconds(start);
+            for (std::size_t i = 0; i < snaps.size(); ++i)
+                Compare(mode, graph, options, false, static_cast<int>(i), static_cast<int>(i), snapped_expected[i], paths[i]);
+            report.modes.push_back(std::move(mode));
+        };
+        check_snapped("GraphPlanner/snapped", astar);
+        if (options.reach) {
+            ReachGraphPlanner reach{graph, ReachPruning{options.reach}};
+            check_snapped("ReachGraphPlanner/snapped", reach);
+        }
+    }
+    return report;
+}
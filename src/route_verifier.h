@@ -0,0 +1,134 @@
+/**
+ * @file route_verifier.h
+ * @brief Differential verification of the accelerated planners
+ *
+ * This file contains ReferenceDijkstra, a deliberately plain shortest-path
+ * implementation sharing no search code with the planners, and
+ * RunDifferential, which sends randomized queries through the reference and
+ * every accelerated mode and reports cost mismatches and latency ratios.
+ */
+
+#ifndef ROUTE_VERIFIER_H
+#define ROUTE_VERIFIER_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "reach.h"
+#include "route_graph.h"
+#include "segment_index.h"
+
+/**
+ * @class ReferenceDijkstra
+ * @brief Textbook Dijkstra over the float edge weights, accumulated in double
+ *
+ * No heuristic, pruning, integer rounding or reuse of planner state: every
+ * query allocates fresh arrays and uses std::priority_queue.
+ */
+class ReferenceDijkstra {
+  public:
+    /**
+     * @brief Constructs the reference for a graph
+     * @param graph The graph to search; must outlive the reference
+     */
+    explicit ReferenceDijkstra(const RouteGraph &graph) : m_Graph(graph) {}
+
+    /**
+     * @brief Returns the shortest distance between two nodes in meters, infinity if unreachable
+     */
+    double Distance(int source, int target) const;
+
+    /**
+     * @brief Returns the shortest distance between two snapped positions in meters
+     */
+    double Distance(const EdgeSnap &from, const EdgeSnap &to) const;
+
+  private:
+    /**
+     * @brief Runs Dijkstra from weighted seeds until the targets cannot improve
+     * @param seeds Start nodes and their initial distances in normalized units
+     * @param targets Goal nodes and the extra distance to add at each
+     * @param best Initial answer, e.g. a direct stretch on a shared segment
+     */
+    double Run(const std::vector<std::pair<int, double>> &seeds,
+               const std::vector<std::pair<int, double>> &targets, double best) const;
+
+    const RouteGraph &m_Graph;  ///< Graph being searched
+};
+
+/**
+ * @struct DifferentialOptions
+ * @brief Parameters of a differential run
+ */
+struct DifferentialOptions {
+    std::size_t queries = 200;               ///< Random node pairs, and as many random positions pairs
+    std::uint64_t seed = 42;                 ///< Seed of the query generator
+    double relative_tolerance = 1e-4;        ///< Allowed relative cost difference
+    const ReachBounds *reach = nullptr;      ///< Bounds for the reach mode; skipped if null
+    const SegmentIndex *index = nullptr;     ///< Index for the snapped mode; skipped if null
+    bool incremental = true;                 ///< Also check IncrementalPlanner (D* Lite)
+};
+
+/**
+ * @struct Mismatch
+ * @brief A query whose cost differs from the reference
+ */
+struct Mismatch {
+    int source;       ///< Start node, or query number for snapped queries
+    int target;       ///< Goal node, or query number for snapped queries
+    double expected;  ///< Reference distance in meters
+    double actual;    ///< Planner distance in meters, infinity if no path was found
+};
+
+/**
+ * @struct ModeReport
+ * @brief Outcome of one accelerated mode
+ */
+struct ModeReport {
+    std::string name;                  ///< Planner configuration
+    std::size_t queries = 0;           ///< Queries compared
+    std::size_t mismatches = 0;        ///< Queries outside the tolerance
+    double max_error = 0.;             ///< Largest absolute difference in meters over reachable queries
+    double seconds = 0.;               ///< Total query time of the mode
+    double reference_seconds = 0.;     ///< Total query time of the reference on the same queries
+    std::vector<Mismatch> examples;    ///< The first few mismatches
+
+    /**
+     * @brief Returns the mode's time relative to the reference; below 1 is faster
+     */
+    double LatencyRatio() const noexcept { return reference_seconds > 0. ? seconds / reference_seconds : 0.; }
+};
+
+/**
+ * @struct DifferentialReport
+ * @brief Outcome of a differential run
+ */
+struct DifferentialReport {
+    std::vector<ModeReport> modes;  ///< One entry per accelerated mode
+
+    /**
+     * @brief Returns true if no mode had a mismatch
+     */
+    bool Ok() const noexcept;
+
+    /**
+     * @brief Prints one row per mode and the recorded mismatches
+     */
+    void Print(std::ostream &os) const;
+};
+
+/**
+ * @brief Compares every accelerated mode against ReferenceDijkstra on random queries
+ * @param graph The graph to query
+ * @param options Queries, tolerance and optional modes
+ * @return Mismatches and timings per mode
+ *
+ * Node-pair modes are GraphPlanner, RadixGraphPlanner, ReachGraphPlanner and
+ * IncrementalPlanner; the snapped modes route GraphPlanner and, with reach
+ * bounds, ReachGraphPlanner between random positions projected with SegmentIndex. Unreachable pairs must be reported
+ * unreachable. Integer costs are allowed one CostUnit() of rounding per edge.
+ */
+DifferentialReport RunDifferential(const RouteGraph &graph, const DifferentialOptions &options);
+
+#endif
@@ -0,0 +1,203 @@
+/**
+ * @file search_stats.h
+ * @brief Per-query search instrumentation
+ *
+ * This file contains SearchStats, the counters and timings a planner records
+ * for each query, StatsTimer, and histograms aggregating many queries.
+ * Recording is compiled in only when ROUTE_PLANNER_ENABLE_STATS is defined
+ * (CMake option of the same name). Otherwise every recording call is an
+ * empty inline function and the counters stay at zero.
+ */
+
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <string>
+
+#if defined(ROUTE_PLANNER_ENABLE_STATS)
+constexpr bool kSearchStatsEnabled = true;   ///< Planners record SearchStats
+#else
+constexpr bool kSearchStatsEnabled = false;  ///< Planners record SearchStats
+#endif
+
+/**
+ * @struct SearchStats
+ * @brief Counters and timings of one query
+ */
+struct SearchStats {
+    std::size_t expansions = 0;           ///< Nodes expanded
+    std::size_t pushes = 0;               ///< Open-list pushes
+    std::size_t pops = 0;                 ///< Open-list pops, including stale entries
+    std::size_t peak_open = 0;            ///< Largest open-list size
+    std::size_t neighbor_scans = 0;       ///< Neighbors or edges examined
+    double snap_seconds = 0.;             ///< Time spent snapping the endpoints
+    double search_seconds = 0.;           ///< Time spent in the search loop
+    double reconstruction_seconds = 0.;   ///< Time spent building the path
+
+    /**
+     * @brief Clears everything but the snap time, which precedes the search
+     */
+    void ResetSearch() noexcept {
+        const auto snap = snap_seconds;
+        *this = SearchStats{};
+        snap_seconds = snap;
+    }
+
+    void Expand() noexcept {
+        if constexpr (kSearchStatsEnabled)
+            ++expansions;
+    }
+
+    void Push(std::size_t open_size) noexcept {
+        if constexpr (kSearchStatsEnabled) {
+            ++pushes;
+            if (open_size > peak_open)
+                peak_open = open_size;
+        }
+    }
+
+    void Pop() noexcept {
+        if constexpr (kSearchStatsEnabled)
+            ++pops;
+    }
+
+    void Scan(std::size_t neighbors) noexcept {
+        if constexpr (kSearchStatsEnabled)
+            neighbor_scans += neighbors;
+    }
+};
+
+/**
+ * @class StatsTimer
+ * @brief Adds the time until Stop() or destruction to a SearchStats field
+ *
+ * Doesn't read the clock when statistics are disabled.
+ */
+class StatsTimer {
+    using Clock = std::chrono::steady_clock;
+
+  public:
+    explicit StatsTimer(double &seconds) noexcept : m_Seconds(&seconds) {
+        if constexpr (kSearchStatsEnabled)
+            m_Start = Clock::now();
+    }
+
+    ~StatsTimer() { Stop(); }
+
+    StatsTimer(const StatsTimer &) = delete;
+    StatsTimer &operator=(const StatsTimer &) = delete;
+
+    /**
+     * @brief Records the elapsed time; later calls do nothing
+     */
+    void Stop() noexcept {
+        if constexpr (kSearchStatsEnabled) {
+            if (m_Seconds) {
+                *m_Seconds += std::chrono::duration<double>(Clock::now() - m_Start).count();
+                m_Seconds = nullptr;
+            }
+        }
+    }
+
+  private:
+    double *m_Seconds;          ///< Field receiving the elapsed time
+    Clock::time_point m_Start;  ///< Start of the measurement
+};
+
+/**
+ * @class LogHistogram
+ * @brief Histogram with power-of-two buckets
+ *
+ * Bucket 0 counts values below 1, bucket i counts values in [2^(i-1), 2^i).
+ */
+class LogHistogram {
+  public:
+    static constexpr std::size_t kBuckets = 64;
+
+    void Add(double value) noexcept {
+        std::size_t bucket = 0;
+        if (value >= 1.)
+            bucket = std::min<std::size_t>(kBuckets - 1, static_cast<std::size_t>(std::ilogb(value)) + 1);
+        ++m_Counts[bucket];
+        ++m_Total;
+    }
+
+    std::uint64_t Count() const noexcept { return m_Total; }
+    std::uint64_t Bucket(std::size_t i) const noexcept { return m_Counts[i]; }
+
+    /**
+     * @brief Returns the exclusive upper edge of a bucket
+     */
+    static double UpperBound(std::size_t i) noexcept { return std::ldexp(1., static_cast<int>(i)); }
+
+    /**
+     * @brief Returns the upper edge of the bucket holding the given quantile
+     * @param q Quantile in [0, 1]
+     */
+    double Quantile(double q) const noexcept {
+        const auto rank = static_cast<std::uint64_t>(std::ceil(q * m_Total));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < kBuckets; ++i)
+            if ((seen += m_Counts[i]) >= rank && seen > 0)
+                return UpperBound(i);
+        return 0.;
+    }
+
+  private:
+    std::array<std::uint64_t, kBuckets> m_Counts{};  ///< Values per bucket
+    std::uint64_t m_Total = 0;                       ///< Values added
+};
+
+/**
+ * @class SearchStatsHistograms
+ * @brief Aggregates SearchStats over many queries
+ */
+class SearchStatsHistograms {
+  public:
+    void Add(const SearchStats &stats) noexcept {
+        m_Expansions.Add(static_cast<double>(stats.expansions));
+        m_Pushes.Add(static_cast<double>(stats.pushes));
+        m_PeakOpen.Add(static_cast<double>(stats.peak_open));
+        m_SearchMicros.Add(stats.search_seconds * 1e6);
+        m_TotalMicros.Add((stats.snap_seconds + stats.search_seconds + stats.reconstruction_seconds) * 1e6);
+    }
+
+    const LogHistogram &Expansions() const noexcept { return m_Expansions; }
+    const LogHistogram &Pushes() const noexcept { return m_Pushes; }
+    const LogHistogram &PeakOpen() const noexcept { return m_PeakOpen; }
+    const LogHistogram &SearchMicros() const noexcept { return m_SearchMicros; }
+    const LogHistogram &TotalMicros() const noexcept { return m_TotalMicros; }
+
+    /**
+     * @brief Prints the median, p90 and p99 bucket of every histogram
+     */
+    void Print(std::ostream &os) const {
+        auto row = [&](const std::string &name, const LogHistogram &h) {
+            os << std::left << std::setw(16) << name << " p50 <" << std::setw(10) << h.Quantile(0.5)
+               << " p90 <" << std::setw(10) << h.Quantile(0.9) << " p99 <" << h.Quantile(0.99) << "\n";
+        };
+        os << "queries: " << m_Expansions.Count() << "\n";
+        row("expansions", m_Expansions);
+        row("pushes", m_Pushes);
+        row("peak open", m_PeakOpen);
+        row("search us", m_SearchMicros);
+        row("total us", m_TotalMicros);
+    }
+
+  private:
+    LogHistogram m_Expansions;    ///< Nodes expanded per query
+    LogHistogram m_Pushes;        ///< Open-list pushes per query
+    LogHistogram m_PeakOpen;      ///< Peak open-list size per query
+    LogHistogram m_SearchMicros;  ///< Search time per query in microseconds
+    LogHistogram m_TotalMicros;   ///< Snap + search + reconstruction time in microseconds
+};
+
+#endif
@@ -0,0 +1,45 @@
+/**
+ * @file search_trace.h
+ * @brief Recording of the nodes a search expanded
+ *
+ * This file contains SearchTrace, which a planner fills with every node it
+ * expands, in expansion order, when one is attached with SetTrace(). Render
+ * can draw a trace as a heatmap under the route to show where a query
+ * wandered. Unlike SearchStats, tracing is chosen per query at run time;
+ * a planner without a trace pays one null check per expansion.
+ */
+
+#ifndef SEARCH_TRACE_H
+#define SEARCH_TRACE_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @struct SearchTrace
+ * @brief Expanded nodes of one query, in expansion order
+ */
+struct SearchTrace {
+    /**
+     * @struct Expansion
+     * @brief One expanded node
+     */
+    struct Expansion {
+        int node;  ///< Node index in the planner's model or graph
+        float x;   ///< Normalized x-coordinate
+        float y;   ///< Normalized y-coordinate
+    };
+
+    std::vector<Expansion> expansions;  ///< Expanded nodes; the index is the expansion order
+
+    /**
+     * @brief Forgets the previous query; keeps the capacity
+     */
+    void Clear() noexcept { expansions.clear(); }
+
+    void Record(int node, float x, float y) { expansions.push_back({node, x, y}); }
+
+    std::size_t Size() const noexcept { return expansions.size(); }
+};
+
+#endif
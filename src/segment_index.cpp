@@ -0,0 +1,112 @@
+#include "segment_index.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+SegmentIndex::SegmentIndex(const RouteGraph &graph, int cells_per_side) : m_Graph(graph)
+{
+    const int n = graph.NumNodes();
+    m_Tail.resize(graph.NumEdges());
+    for (int u = 0; u < n; ++u)
+        for (auto e = graph.FirstOut(u); e < graph.FirstOut(u + 1); ++e)
+            m_Tail[e] = u;
+
+    if (n > 0) {
+        auto max_x = graph.X(0), max_y = graph.Y(0);
+        m_MinX = graph.X(0);
+        m_MinY = graph.Y(0);
+        for (int v = 1; v < n; ++v) {
+            m_MinX = std::min(m_MinX, graph.X(v));
+            m_MinY = std::min(m_MinY, graph.Y(v));
+            max_x = std::max(max_x, graph.X(v));
+            max_y = std::max(max_y, graph.Y(v));
+        }
+        if (cells_per_side <= 0)
+            cells_per_side = static_cast<int>(std::ceil(std::sqrt(graph.NumEdges() / 2.)));
+        m_Cells = std::max(1, cells_per_side);
+        m_CellWidth = std::max((max_x - m_MinX) / m_Cells, std::numeric_limits<float>::epsilon());
+        m_CellHeight = std::max((max_y - m_MinY) / m_Cells, std::numeric_limits<float>::epsilon());
+    }
+
+    // Counting pass, then fill pass, over the cells each segment's bounding box covers.
+    auto for_each_cell = [&](std::uint32_t e, auto &&visit) {
+        const int u = m_Tail[e], v = graph.Head(e);
+        const int x0 = CellX(std::min(graph.X(u), graph.X(v))), x1 = CellX(std::max(graph.X(u), graph.X(v)));
+        const int y0 = CellY(std::min(graph.Y(u), graph.Y(v))), y1 = CellY(std::max(graph.Y(u), graph.Y(v)));
+        for (int cy = y0; cy <= y1; ++cy)
+            for (int cx = x0; cx <= x1; ++cx)
+                visit(cy * m_Cells + cx);
+    };
+    m_CellStart.assign(static_cast<std::size_t>(m_Cells) * m_Cells + 1, 0);
+    for (std::uint32_t e = 0; e < m_Tail.size(); ++e)
+        if (m_Tail[e] < graph.Head(e))
+            for_each_cell(e, [&](int cell) { ++m_CellStart[cell + 1]; });
+    for (std::size_t c = 1; c < m_CellStart.size(); ++c)
+        m_CellStart[c] += m_CellStart[c - 1];
+    m_CellEdges.resize(m_CellStart.back());
+    auto fill = m_CellStart;
+    for (std::uint32_t e = 0; e < m_Tail.size(); ++e)
+        if (m_Tail[e] < graph.Head(e))
+            for_each_cell(e, [&](int cell) { m_CellEdges[fill[cell]++] = e; });
+}
+
+std::optional<EdgeSnap> SegmentIndex::Snap(float x, float y) const
+{
+    if (m_CellEdges.empty())
+        return std::nullopt;
+
+    std::optional<EdgeSnap> best;
+    const int cx = CellX(x), cy = CellY(y);
+    const auto ring_step = std::min(m_CellWidth, m_CellHeight);
+    for (int r = 0; r <= m_Cells; ++r) {
+        // Rings 0..r-1 are scanned; any cell in ring r or beyond is at least r - 1 cells away.
+        if (best && best->distance <= (r - 1) * ring_step)
+            break;
+        for (int y_cell = cy - r; y_cell <= cy + r; ++y_cell) {
+            if (y_cell < 0 || y_cell >= m_Cells)
+                continue;
+            const bool edge_row = y_cell == cy - r || y_cell == cy + r;
+            for (int x_cell = cx - r; x_cell <= cx + r; x_cell += edge_row ? 1 : 2 * r) {
+                if (x_cell >= 0 && x_cell < m_Cells) {
+                    const auto cell = y_cell * m_Cells + x_cell;
+                    for (auto i = m_CellStart[cell]; i < m_CellStart[cell + 1]; ++i) {
+                        const auto e = m_CellEdges[i];
+                        const auto snap = Project(e, m_Tail[e], x, y);
+                        if (!best || snap.distance < best->distance)
+                            best = snap;
+                    }
+                }
+            }
+        }
+    }
+    return best;
+}
+
+EdgeSnap SegmentIndex::Project(std::uint32_t e, int u, float x, float y) const
+{
+    const int v = m_Graph.Head(e);
+    const auto ux = m_Graph.X(u), uy = m_Graph.Y(u);
+    const auto dx = m_Graph.X(v) - ux, dy = m_Graph.Y(v) - uy;
+    const auto length2 = dx * dx + dy * dy;
+    const auto t = length2 > 0.f ? std::clamp(((x - ux) * dx + (y - uy) * dy) / length2, 0.f, 1.f) : 0.f;
+
+    EdgeSnap snap;
+    snap.edge = e;
+    snap.u = u;
+    snap.v = v;
+    snap.t = t;
+    snap.x = ux + t * dx;
+    snap.y = uy + t * dy;
+    snap.distance = std::hypot(snap.x - x, snap.y - y);
+    return snap;
+}
+
+int SegmentIndex::CellX(float x) const noexcept
+{
+    return static_cast<int>(std::clamp((x - m_MinX) / m_CellWidth, 0.f, m_Cells - 1.f));
+}
+
+int SegmentIndex::CellY(float y) const noexcept
+{
+    return static_cast<int>(std::clamp((y - m_MinY) / m_CellHeight, 0.f, m_Cells - 1.f));
+}
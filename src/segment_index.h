@@ -0,0 +1,79 @@
+/**
+ * @file segment_index.h
+ * @brief Spatial index over road segments for edge-projection snapping
+ *
+ * This file contains EdgeSnap, the projection of a position onto a road
+ * segment, and SegmentIndex, a uniform grid over the segments of a
+ * RouteGraph. Snapping to the nearest segment instead of the nearest vertex
+ * lets a route start and end exactly where the user is, even on long
+ * straight roads with few vertices.
+ */
+
+#ifndef SEGMENT_INDEX_H
+#define SEGMENT_INDEX_H
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "route_graph.h"
+
+/**
+ * @struct EdgeSnap
+ * @brief A position projected onto a road segment
+ */
+struct EdgeSnap {
+    std::uint32_t edge = 0;  ///< Directed edge from u to v
+    int u = -1;              ///< Segment start node
+    int v = -1;              ///< Segment end node
+    float t = 0.f;           ///< Position along the segment, 0 at u and 1 at v
+    float x = 0.f;           ///< Projected x-coordinate (normalized longitude)
+    float y = 0.f;           ///< Projected y-coordinate (normalized latitude)
+    float distance = 0.f;    ///< Distance from the query position in normalized units
+};
+
+/**
+ * @class SegmentIndex
+ * @brief Uniform grid of road segments supporting nearest-segment queries
+ *
+ * Every undirected segment is listed in each grid cell its bounding box
+ * overlaps. A query scans rings of cells around the position and stops once
+ * no unscanned cell can hold a closer segment.
+ */
+class SegmentIndex {
+  public:
+    /**
+     * @brief Builds the index for a graph
+     * @param graph The graph whose segments are indexed; must outlive the index
+     * @param cells_per_side Grid resolution; 0 picks about one cell per segment
+     */
+    explicit SegmentIndex(const RouteGraph &graph, int cells_per_side = 0);
+
+    /**
+     * @brief Projects a position onto the nearest road segment
+     * @param x The x-coordinate (normalized longitude)
+     * @param y The y-coordinate (normalized latitude)
+     * @return The snap, or nullopt if the graph has no segments
+     */
+    std::optional<EdgeSnap> Snap(float x, float y) const;
+
+  private:
+    /**
+     * @brief Projects a position onto one directed edge
+     */
+    EdgeSnap Project(std::uint32_t e, int u, float x, float y) const;
+
+    int CellX(float x) const noexcept;
+    int CellY(float y) const noexcept;
+
+    const RouteGraph &m_Graph;              ///< Indexed graph
+    int m_Cells = 1;                        ///< Cells per side
+    float m_MinX = 0.f;                     ///< Grid origin x
+    float m_MinY = 0.f;                     ///< Grid origin y
+    float m_CellWidth = 1.f;                ///< Cell width in normalized units
+    float m_CellHeight = 1.f;               ///< Cell height in normalized units
+    std::vector<std::uint32_t> m_CellStart; ///< CSR offsets into m_CellEdges, row-major
+    std::vector<std::uint32_t> m_CellEdges; ///< Edge ids (u < v) per cell
+    std::vector<int> m_Tail;                ///< Source node of every edge
+};
+
+#endif
@@ -0,0 +1,324 @@
+#include "svg_writer.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <optional>
+#include <sstream>
+#include <string>
+#include "map_style.h"
+
+namespace {
+
+/**
+ * @brief Writes a fixed-point number without trailing zeros
+ * @param value The number times 10^decimals
+ */
+void WriteFixed(std::ostream &os, long long value, int decimals)
+{
+    char digits[24];
+    auto end = std::to_chars(digits, digits + sizeof(digits), std::llabs(value)).ptr;
+    const int length = static_cast<int>(end - digits);
+
+    char out[32];
+    char *p = out;
+    if( value < 0 )
+        *p++ = '-';
+    const int whole = length - decimals;
+    if( whole > 0 )
+        p = std::copy(digits, digits + whole, p);
+    // Drop trailing zeros of the fraction, and the leading zero of "0.5".
+    int fraction = std::min(decimals, length);
+    const char *first = end - fraction;
+    while( fraction > 0 && first[fraction - 1] == '0' )
+        --fraction;
+    if( fraction > 0 ) {
+        *p++ = '.';
+        p = std::fill_n(p, decimals - std::min(decimals, length), '0');
+        p = std::copy(first, first + fraction, p);
+    }
+    else if( whole <= 0 )
+        *p++ = '0';
+    os.write(out, p - out);
+}
+
+void WriteColor(std::ostream &os, const MapColor &color)
+{
+    constexpr char hex[] = "0123456789abcdef";
+    const char out[7] = {'#', hex[color.r >> 4], hex[color.r & 15], hex[color.g >> 4],
+                         hex[color.g & 15], hex[color.b >> 4], hex[color.b & 15]};
+    os.write(out, sizeof(out));
+}
+
+/**
+ * @class PathWriter
+ * @brief Streams the figures of one <path> element
+ *
+ * The element is opened with the first figure, so a style without visible
+ * features writes nothing. Figures use relative moves and the implicit line
+ * commands that follow them, and deltas are taken between quantized points
+ * so rounding errors don't add up along a way.
+ */
+class PathWriter {
+  public:
+    PathWriter(std::ostream &os, const Viewport &viewport, int decimals) :
+        m_Os(os), m_Viewport(viewport), m_Decimals(decimals), m_Factor(std::pow(10., decimals)) {}
+
+    /**
+     * @brief Starts a new element; attributes are written with its first figure
+     * @param attributes Presentation attributes, each with a leading space
+     */
+    void Begin(std::string attributes) {
+        End();
+        m_Attributes = std::move(attributes);
+    }
+
+    /**
+     * @brief Closes the current element, if it holds any figure
+     */
+    void End() {
+        if( m_Open )
+            m_Os << "\"/>\n";
+        m_Open = false;
+        m_X = m_Y = 0;
+    }
+
+    void MoveTo(const Model::Node &node) {
+        if( !m_Open ) {
+            m_Os << "<path" << m_Attributes << " d=\"";
+            m_Open = true;
+        }
+        auto [x, y] = Quantize(node);
+        m_Os.put('m');
+        m_Separate = false;
+        Write(x - m_X, y - m_Y);
+        m_X = m_StartX = x;
+        m_Y = m_StartY = y;
+    }
+
+    void LineTo(const Model::Node &node) {
+        auto [x, y] = Quantize(node);
+        if( x == m_X && y == m_Y )
+            return;
+        Write(x - m_X, y - m_Y);
+        m_X = x;
+        m_Y = y;
+    }
+
+    void Close() {
+        m_Os.put('z');
+        m_Separate = false;
+        m_X = m_StartX;
+        m_Y = m_StartY;
+    }
+
+  private:
+    std::pair<long long, long long> Quantize(const Model::Node &node) const {
+        auto [px, py] = m_Viewport.ToPixel(node.x, node.y);
+        return {std::llround(px * m_Factor), std::llround(py * m_Factor)};
+    }
+
+    void Write(long long dx, long long dy) {
+        for( auto value: {dx, dy} ) {
+            if( m_Separate && value >= 0 )
+                m_Os.put(' ');
+            WriteFixed(m_Os, value, m_Decimals);
+            m_Separate = true;
+        }
+    }
+
+    std::ostream &m_Os;
+    const Viewport &m_Viewport;
+    int m_Decimals;
+    double m_Factor;
+    std::string m_Attributes;
+    bool m_Open = false;
+    bool m_Separate = false;  ///< A number was written last and the next one needs a separator
+    long long m_X = 0, m_Y = 0;
+    long long m_StartX = 0, m_StartY = 0;
+};
+
+std::string FillStyle(const MapColor &color)
+{
+    std::ostringstream os;
+    os << " fill=\"";
+    WriteColor(os, color);
+    os << '"';
+    return os.str();
+}
+
+std::string StrokeStyle(const MapColor &color, float width, const std::vector<float> &dashes = {},
+                        const char *cap = nullptr)
+{
+    std::ostringstream os;
+    os << " stroke=\"";
+    WriteColor(os, color);
+    os << "\" stroke-width=\"";
+    WriteFixed(os, std::llround(width * 100.), 2);
+    os << '"';
+    if( cap )
+        os << " stroke-linecap=\"" << cap << '"';
+    if( !dashes.empty() ) {
+        os << " stroke-dasharray=\"";
+        for( std::size_t i = 0; i < dashes.size(); ++i ) {
+            if( i )
+                os << ' ';
+            WriteFixed(os, std::llround(dashes[i] * 100.), 2);
+        }
+        os << '"';
+    }
+    return os.str();
+}
+
+}  // namespace
+
+SvgWriter::SvgWriter(const RouteModel &model, SvgOptions options) :
+    m_Model(model),
+    m_Options(options),
+    m_Index(model),
+    m_Lod(model)
+{
+    m_Options.decimals = std::clamp(m_Options.decimals, 0, 6);
+}
+
+void SvgWriter::VisibleFeatures(FeatureLayer layer, const Viewport &viewport, std::vector<int> &features) const
+{
+    m_Index.QueryVisible(layer, viewport.Bounds(), viewport.Scale(), m_Model.MetricScale(), WidestMetricWidth(),
+                         m_MinFeaturePixels, features);
+}
+
+bool SvgWriter::Write(std::ostream &os, const Viewport &viewport) const
+{
+    const auto scale = viewport.Scale();
+    const auto pixels_in_meter = static_cast<float>(scale / m_Model.MetricScale());
+    const int band = m_Lod.Band(0.5 / scale);
+    const auto nodes = m_Model.Nodes().data();
+    PathWriter path{os, viewport, m_Options.decimals};
+    std::vector<int> visible;
+
+    auto begin_layer = [&](const char *name) {
+        if( m_Options.group_layers )
+            os << "<g id=\"" << name << "\">\n";
+    };
+    auto end_layer = [&] {
+        path.End();
+        if( m_Options.group_layers )
+            os << "</g>\n";
+    };
+    auto write_way = [&](int way) {
+        const auto way_nodes = m_Lod.Nodes(band, way);
+        if( way_nodes.empty() )
+            return;
+        path.MoveTo(nodes[way_nodes.front()]);
+        for( auto it = way_nodes.begin() + 1; it != way_nodes.end(); ++it )
+            path.LineTo(nodes[*it]);
+    };
+    // Outer rings run counterclockwise and holes clockwise, as in Render, so the nonzero
+    // fill of merged polygons is their union.
+    auto write_ring = [&](int way, bool counterclockwise) {
+        bool first = true;
+        m_Lod.VisitRing(band, way, counterclockwise, [&](int n) {
+            if( first )
+                path.MoveTo(nodes[n]);
+            else
+                path.LineTo(nodes[n]);
+            first = false;
+        });
+        if( !first )
+            path.Close();
+    };
+    auto write_mp = [&](const Model::Multipolygon &mp) {
+        for( auto way: mp.outer )
+            write_ring(way, true);
+        for( auto way: mp.inner )
+            write_ring(way, false);
+    };
+    auto area_layer = [&](const char *name, FeatureLayer layer, const auto &features, std::string style) {
+        begin_layer(name);
+        VisibleFeatures(layer, viewport, visible);
+        path.Begin(std::move(style));
+        for( auto i: visible )
+            write_mp(features[i]);
+        end_layer();
+    };
+
+    os << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << viewport.width << "\" height=\"" << viewport.height
+       << "\" viewBox=\"0 0 " << viewport.width << ' ' << viewport.height << "\" fill=\"none\" stroke-linejoin=\"round\">\n";
+    os << "<rect width=\"100%\" height=\"100%\"" << FillStyle(kBackgroundColor) << "/>\n";
+
+    // Land uses of one type are merged while they follow each other, which keeps the drawing order.
+    begin_layer("landuse");
+    VisibleFeatures(FeatureLayer::Landuse, viewport, visible);
+    std::optional<Model::Landuse::Type> landuse_type;
+    for( auto i: visible ) {
+        auto &landuse = m_Model.Landuses()[i];
+        auto color = LanduseColor(landuse.type);
+        if( !color )
+            continue;
+        if( landuse.type != landuse_type ) {
+            path.Begin(FillStyle(*color));
+            landuse_type = landuse.type;
+        }
+        write_mp(landuse);
+    }
+    end_layer();
+
+    area_layer("leisure", FeatureLayer::Leisure, m_Model.Leisures(),
+               FillStyle(kLeisureFillColor) + StrokeStyle(kLeisureOutlineColor, kLeisureOutlineWidth));
+    area_layer("water", FeatureLayer::Water, m_Model.Waters(), FillStyle(kWaterFillColor));
+
+    begin_layer("railways");
+    VisibleFeatures(FeatureLayer::Railway, viewport, visible);
+    path.Begin(StrokeStyle(kRailwayStrokeColor, kRailwayOuterWidth * pixels_in_meter));
+    for( auto i: visible )
+        write_way(m_Model.Railways()[i].way);
+    path.Begin(StrokeStyle(kRailwayDashColor, kRailwayInnerWidth * pixels_in_meter, {kRailwayDash, kRailwayDash}));
+    for( auto i: visible )
+        write_way(m_Model.Railways()[i].way);
+    end_layer();
+
+    // Roads are sorted by type, so every type becomes a single path element.
+    begin_layer("roads");
+    VisibleFeatures(FeatureLayer::Road, viewport, visible);
+    std::optional<Model::Road::Type> road_type;
+    for( auto i: visible ) {
+        auto &road = m_Model.Roads()[i];
+        if( road.type == Model::Road::Invalid )
+            continue;
+        if( road.type != road_type ) {
+            const auto metric_width = RoadMetricWidth(road.type);
+            const auto width = metric_width > 0.f ? metric_width * pixels_in_meter : 1.f;
+            path.Begin(StrokeStyle(RoadColor(road.type), width, RoadDashes(road.type), "round"));
+            road_type = road.type;
+        }
+        write_way(road.way);
+    }
+    end_layer();
+
+    area_layer("buildings", FeatureLayer::Building, m_Model.Buildings(),
+               FillStyle(kBuildingFillColor) + StrokeStyle(kBuildingOutlineColor, kBuildingOutlineWidth));
+
+    begin_layer("route");
+    if( !m_Model.path.empty() ) {
+        path.Begin(StrokeStyle(kRouteColor, kRouteWidth));
+        path.MoveTo(m_Model.path.front());
+        for( auto it = m_Model.path.begin() + 1; it != m_Model.path.end(); ++it )
+            path.LineTo(*it);
+        path.End();
+
+        auto marker = [&](const Model::Node &at, const MapColor &color) {
+            path.Begin(FillStyle(color) + " shape-rendering=\"crispEdges\"");
+            path.MoveTo(at);
+            path.LineTo({at.x + kMarkerSize, at.y});
+            path.LineTo({at.x + kMarkerSize, at.y + kMarkerSize});
+            path.LineTo({at.x, at.y + kMarkerSize});
+            path.Close();
+        };
+        marker(m_Model.path.front(), kStartColor);
+        marker(m_Model.path.back(), kEndColor);
+    }
+    end_layer();
+
+    os << "</svg>\n";
+    return os.good();
+}
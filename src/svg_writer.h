@@ -0,0 +1,75 @@
+/**
+ * @file svg_writer.h
+ * @brief Vector map output in SVG format
+ *
+ * This file contains SvgWriter, which draws the same layers as Render into
+ * an SVG document instead of a bitmap. Path data is streamed to the output
+ * as the features are visited, so memory use does not grow with the size of
+ * the document, and no graphics library is needed.
+ */
+
+#ifndef SVG_WRITER_H
+#define SVG_WRITER_H
+
+#include <ostream>
+#include <vector>
+#include "feature_index.h"
+#include "geometry_lod.h"
+#include "route_model.h"
+#include "viewport.h"
+
+/**
+ * @struct SvgOptions
+ * @brief Output settings of SvgWriter
+ */
+struct SvgOptions {
+    int decimals = 1;          ///< Digits kept after the decimal point of pixel coordinates, 0 to 6
+    bool group_layers = true;  ///< Wrap every layer in a <g> element named after the layer
+};
+
+/**
+ * @class SvgWriter
+ * @brief Writes the map of a viewport and the calculated route as SVG
+ *
+ * Layers follow Render's order: background, land uses, leisure areas,
+ * water, railways, roads, buildings, the route and its start and end
+ * markers, styled from map_style.h. Features are culled and simplified for
+ * the viewport like Render does, and features that share a style are
+ * merged into one path element.
+ *
+ * Coordinates are quantized to SvgOptions::decimals and written relative
+ * to the previous point, so most of them take only a few characters;
+ * points that quantize onto their predecessor are dropped.
+ */
+class SvgWriter {
+  public:
+    /**
+     * @brief Prepares the spatial index and simplified geometry of a model
+     * @param model The map and route to write; must outlive the writer
+     * @param options Output settings
+     */
+    explicit SvgWriter(const RouteModel &model, SvgOptions options = {});
+
+    /**
+     * @brief Writes a complete SVG document of a viewport
+     * @param os Stream that receives the document
+     * @param viewport The visible area; its size becomes the document size in pixels
+     * @return True if the stream is still good afterwards
+     */
+    bool Write(std::ostream &os, const Viewport &viewport) const;
+
+  private:
+    /**
+     * @brief Finds the features of a layer worth drawing in a viewport
+     * @param features Receives the feature indices in ascending order
+     */
+    void VisibleFeatures(FeatureLayer layer, const Viewport &viewport, std::vector<int> &features) const;
+
+    const RouteModel &m_Model;   ///< Map and route
+    SvgOptions m_Options;        ///< Output settings
+    FeatureIndex m_Index;        ///< Bounding boxes of the map features
+    GeometryLod m_Lod;           ///< Simplified way geometry per zoom band
+    float m_MinFeaturePixels = 1.f;  ///< Features whose box is smaller than this are not written
+};
+
+#endif
@@ -0,0 +1,279 @@
+#include "synthetic_map.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace {
+
+constexpr double kMetersPerDegree = 111320.;
+
+// SplitMix64 finalizer; every random choice hashes its coordinates, so two passes agree.
+std::uint64_t Mix(std::uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+double Unit(std::uint64_t seed, std::uint64_t a, std::uint64_t b, std::uint64_t salt)
+{
+    const auto h = Mix(seed ^ Mix(a ^ Mix(b ^ Mix(salt))));
+    return (h >> 11) * (1. / 9007199254740992.);
+}
+
+enum class BlockKind { Empty, Area, Courtyard, Building };
+
+class Layout {
+  public:
+    explicit Layout(const SyntheticMapOptions &options)
+        : m_Options(options),
+          m_Grid(std::max(2, options.grid)),
+          m_Sub(std::max(0, options.subdivisions)),
+          m_Fine((m_Grid - 1) * (m_Sub + 1) + 1),
+          m_Step(options.block_meters / (m_Sub + 1)),
+          m_Amplitude(std::clamp(options.perturbation, 0., 0.25) * options.block_meters),
+          m_LonScale(kMetersPerDegree * std::cos(options.origin_lat * 3.14159265358979323846 / 180.)) {}
+
+    int Grid() const { return m_Grid; }
+    int Fine() const { return m_Fine; }
+    int Sub() const { return m_Sub; }
+    double Block() const { return m_Options.block_meters; }
+    double Amplitude() const { return m_Amplitude; }
+    const SyntheticMapOptions &Options() const { return m_Options; }
+
+    // Street nodes lie on the fine lattice points that belong to a grid line.
+    bool OnStreet(int i, int j) const { return i % (m_Sub + 1) == 0 || j % (m_Sub + 1) == 0; }
+
+    std::uint64_t StreetNodes() const {
+        return static_cast<std::uint64_t>(m_Grid) * m_Fine + static_cast<std::uint64_t>(m_Fine - m_Grid) * m_Grid;
+    }
+
+    std::uint64_t StreetId(int i, int j) const {
+        const std::uint64_t line_rows = (j + m_Sub) / (m_Sub + 1);
+        const std::uint64_t rows_before = line_rows * m_Fine + (j - line_rows) * m_Grid;
+        const std::uint64_t within = j % (m_Sub + 1) == 0 ? i : i / (m_Sub + 1);
+        return 1 + rows_before + within;
+    }
+
+    void StreetPosition(int i, int j, double &x, double &y) const {
+        x = i * m_Step;
+        y = j * m_Step;
+        if (m_Amplitude > 0.) {
+            x += (2. * Unit(m_Options.seed, i, j, 11) - 1.) * m_Amplitude;
+            y += (2. * Unit(m_Options.seed, i, j, 12) - 1.) * m_Amplitude;
+        }
+    }
+
+    double Lat(double y) const { return m_Options.origin_lat + y / kMetersPerDegree; }
+    double Lon(double x) const { return m_Options.origin_lon + x / m_LonScale; }
+
+    BlockKind Kind(int bx, int by) const {
+        auto r = Unit(m_Options.seed, bx, by, 1);
+        if ((r -= m_Options.landuse_density) < 0.)
+            return BlockKind::Area;
+        if ((r -= m_Options.relation_density) < 0.)
+            return BlockKind::Courtyard;
+        if ((r -= m_Options.building_density) < 0.)
+            return BlockKind::Building;
+        return BlockKind::Empty;
+    }
+
+    static int NodesOf(BlockKind kind) {
+        switch (kind) {
+            case BlockKind::Area: return 4;
+            case BlockKind::Building: return 4;
+            case BlockKind::Courtyard: return 8;
+            default: return 0;
+        }
+    }
+
+    // Corners of the block features, counter-clockwise; courtyards list the outer then the inner ring.
+    void Corners(int bx, int by, BlockKind kind, double (*xy)[2]) const {
+        const double margin = Block() * 0.1 + m_Amplitude;
+        double x0 = bx * Block() + margin, x1 = (bx + 1) * Block() - margin;
+        double y0 = by * Block() + margin, y1 = (by + 1) * Block() - margin;
+        if (kind == BlockKind::Building) {
+            // A random rectangle covering 30-90% of the block interior in each direction.
+            const double w = (x1 - x0) * (0.3 + 0.6 * Unit(m_Options.seed, bx, by, 2));
+            const double h = (y1 - y0) * (0.3 + 0.6 * Unit(m_Options.seed, bx, by, 3));
+            x0 += (x1 - x0 - w) * Unit(m_Options.seed, bx, by, 4);
+            y0 += (y1 - y0 - h) * Unit(m_Options.seed, bx, by, 5);
+            x1 = x0 + w;
+            y1 = y0 + h;
+        }
+        const double ring[4][2] = {{x0, y0}, {x1, y0}, {x1, y1}, {x0, y1}};
+        for (int k = 0; k < 4; ++k) {
+            xy[k][0] = ring[k][0];
+            xy[k][1] = ring[k][1];
+        }
+        if (kind == BlockKind::Courtyard) {
+            const double cx = (x0 + x1) / 2, cy = (y0 + y1) / 2;
+            const double hw = (x1 - x0) / 4, hh = (y1 - y0) / 4;
+            const double inner[4][2] = {{cx - hw, cy - hh}, {cx + hw, cy - hh}, {cx + hw, cy + hh}, {cx - hw, cy + hh}};
+            for (int k = 0; k < 4; ++k) {
+                xy[4 + k][0] = inner[k][0];
+                xy[4 + k][1] = inner[k][1];
+            }
+        }
+    }
+
+  private:
+    const SyntheticMapOptions &m_Options;
+    int m_Grid;
+    int m_Sub;
+    int m_Fine;
+    double m_Step;
+    double m_Amplitude;
+    double m_LonScale;
+};
+
+const char *RoadClass(int line)
+{
+    if (line % 32 == 0) return "trunk";
+    if (line % 16 == 0) return "primary";
+    if (line % 8 == 0)  return "secondary";
+    if (line % 4 == 0)  return "tertiary";
+    if (line % 2 == 0)  return "residential";
+    return "service";
+}
+
+void AreaTag(std::ostream &os, std::uint64_t seed, int bx, int by)
+{
+    static const char *const kTags[][2] = {
+        {"landuse", "residential"}, {"landuse", "commercial"}, {"landuse", "industrial"},
+        {"landuse", "grass"}, {"landuse", "forest"}, {"landuse", "construction"}, {"leisure", "park"}};
+    const auto &tag = kTags[static_cast<int>(Unit(seed, bx, by, 6) * 7)];
+    os << "  <tag k=\"" << tag[0] << "\" v=\"" << tag[1] << "\"/>\n";
+}
+
+}  // namespace
+
+int SyntheticGridForNodes(const SyntheticMapOptions &options, std::size_t nodes)
+{
+    const double area = std::clamp(options.landuse_density, 0., 1.);
+    const double courtyard = std::clamp(options.relation_density, 0., 1. - area);
+    const double building = std::clamp(options.building_density, 0., 1. - area - courtyard);
+    const double per_block = 4. * (area + building) + 8. * courtyard;
+    const double per_cell = 2. * std::max(0, options.subdivisions) + 1. + per_block;
+    return std::max(2, static_cast<int>(std::lround(std::sqrt(nodes / per_cell))));
+}
+
+SyntheticMapStats WriteSyntheticOsm(std::ostream &os, const SyntheticMapOptions &options)
+{
+    const Layout layout{options};
+    const int grid = layout.Grid(), fine = layout.Fine(), step = layout.Sub() + 1;
+    SyntheticMapStats stats;
+
+    const auto extent = (grid - 1) * layout.Block();
+    const auto pad = layout.Amplitude() + 1.;
+    os << std::fixed << std::setprecision(7);
+    os << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+       << "<osm version=\"0.6\" generator=\"osm_generator\">\n"
+       << " <bounds minlat=\"" << layout.Lat(-pad) << "\" minlon=\"" << layout.Lon(-pad)
+       << "\" maxlat=\"" << layout.Lat(extent + pad) << "\" maxlon=\"" << layout.Lon(extent + pad) << "\"/>\n";
+
+    auto node = [&](std::uint64_t id, double x, double y) {
+        os << " <node id=\"" << id << "\" lat=\"" << layout.Lat(y) << "\" lon=\"" << layout.Lon(x) << "\"/>\n";
+        ++stats.nodes;
+    };
+
+    // Street nodes, in StreetId() order.
+    for (int j = 0; j < fine; ++j)
+        for (int i = 0; i < fine; ++i)
+            if (layout.OnStreet(i, j)) {
+                double x, y;
+                layout.StreetPosition(i, j, x, y);
+                node(layout.StreetId(i, j), x, y);
+            }
+
+    // Block feature nodes; the way pass below walks the blocks in the same order.
+    auto next_id = layout.StreetNodes() + 1;
+    double corners[8][2];
+    for (int by = 0; by + 1 < grid; ++by)
+        for (int bx = 0; bx + 1 < grid; ++bx) {
+            const auto kind = layout.Kind(bx, by);
+            layout.Corners(bx, by, kind, corners);
+            for (int k = 0; k < Layout::NodesOf(kind); ++k)
+                node(next_id++, corners[k][0], corners[k][1]);
+        }
+
+    // One way per street line, tagged by its place in the road hierarchy.
+    std::uint64_t way_id = 1;
+    for (int line = 0; line < grid; ++line)
+        for (int vertical = 0; vertical < 2; ++vertical) {
+            os << " <way id=\"" << way_id++ << "\">\n";
+            for (int k = 0; k < fine; ++k) {
+                const auto id = vertical ? layout.StreetId(line * step, k) : layout.StreetId(k, line * step);
+                os << "  <nd ref=\"" << id << "\"/>\n";
+            }
+            os << "  <tag k=\"highway\" v=\"" << RoadClass(line) << "\"/>\n </way>\n";
+            ++stats.ways;
+        }
+
+    auto ring = [&](std::uint64_t first) {
+        for (int k = 0; k < 5; ++k)
+            os << "  <nd ref=\"" << first + k % 4 << "\"/>\n";
+    };
+    next_id = layout.StreetNodes() + 1;
+    const auto first_block_way = way_id;
+    for (int by = 0; by + 1 < grid; ++by)
+        for (int bx = 0; bx + 1 < grid; ++bx) {
+            const auto kind = layout.Kind(bx, by);
+            if (kind == BlockKind::Area || kind == BlockKind::Building) {
+                os << " <way id=\"" << way_id++ << "\">\n";
+                ring(next_id);
+                if (kind == BlockKind::Area)
+                    AreaTag(os, options.seed, bx, by);
+                else
+                    os << "  <tag k=\"building\" v=\"yes\"/>\n";
+                os << " </way>\n";
+                ++stats.ways;
+            }
+            else if (kind == BlockKind::Courtyard) {
+                // Untagged ring ways; the relation carries the tags.
+                os << " <way id=\"" << way_id++ << "\">\n";
+                ring(next_id);
+                os << " </way>\n <way id=\"" << way_id++ << "\">\n";
+                ring(next_id + 4);
+                os << " </way>\n";
+                stats.ways += 2;
+            }
+            next_id += Layout::NodesOf(kind);
+        }
+
+    // Relations go after every way, as in OSM files. Walk the blocks again and
+    // replay the way numbering rather than holding the relations in memory.
+    way_id = first_block_way;
+    std::uint64_t relation_id = 1;
+    for (int by = 0; by + 1 < grid; ++by)
+        for (int bx = 0; bx + 1 < grid; ++bx) {
+            const auto kind = layout.Kind(bx, by);
+            if (kind == BlockKind::Area || kind == BlockKind::Building)
+                ++way_id;
+            else if (kind == BlockKind::Courtyard) {
+                const auto outer = way_id++, inner = way_id++;
+                os << " <relation id=\"" << relation_id++ << "\">\n"
+                   << "  <member type=\"way\" ref=\"" << outer << "\" role=\"outer\"/>\n"
+                   << "  <member type=\"way\" ref=\"" << inner << "\" role=\"inner\"/>\n"
+                   << "  <tag k=\"type\" v=\"multipolygon\"/>\n"
+                   << "  <tag k=\"building\" v=\"yes\"/>\n"
+                   << " </relation>\n";
+                ++stats.relations;
+            }
+        }
+    os << "</osm>\n";
+    return stats;
+}
+
+std::vector<std::byte> GenerateSyntheticOsm(const SyntheticMapOptions &options)
+{
+    std::ostringstream os;
+    WriteSyntheticOsm(os, options);
+    const auto xml = os.str();
+    std::vector<std::byte> bytes(xml.size());
+    std::transform(xml.begin(), xml.end(), bytes.begin(), [](char c) { return static_cast<std::byte>(c); });
+    return bytes;
+}
@@ -0,0 +1,67 @@
+/**
+ * @file synthetic_map.h
+ * @brief Deterministic synthetic OpenStreetMap data for scaling tests
+ *
+ * This file contains the options and writer for synthetic OSM XML maps: a
+ * grid or perturbed-grid street network with a road-class hierarchy,
+ * building and landuse polygons, leisure areas and multipolygon relations.
+ * The output depends only on the options (including the seed) and is
+ * streamed, so maps of 10^7 nodes can be written in constant memory.
+ */
+
+#ifndef SYNTHETIC_MAP_H
+#define SYNTHETIC_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/**
+ * @struct SyntheticMapOptions
+ * @brief Parameters of a synthetic map
+ */
+struct SyntheticMapOptions {
+    std::uint64_t seed = 1;         ///< Seed of every random choice
+    int grid = 32;                  ///< Streets per direction
+    int subdivisions = 2;           ///< Shape nodes between two intersections
+    double block_meters = 120.;     ///< Distance between parallel streets
+    double perturbation = 0.;       ///< Node jitter as a fraction of the block size, at most 0.25
+    double building_density = 0.6;  ///< Probability that a block holds a building
+    double landuse_density = 0.15;  ///< Probability that a block is a landuse or leisure area
+    double relation_density = 0.05; ///< Probability that a block holds a multipolygon building with a courtyard
+    double origin_lat = 37.0;       ///< Latitude of the south-west corner
+    double origin_lon = -122.0;     ///< Longitude of the south-west corner
+};
+
+/**
+ * @struct SyntheticMapStats
+ * @brief Element counts of a written synthetic map
+ */
+struct SyntheticMapStats {
+    std::size_t nodes = 0;      ///< <node> elements
+    std::size_t ways = 0;       ///< <way> elements
+    std::size_t relations = 0;  ///< <relation> elements
+};
+
+/**
+ * @brief Returns the grid size whose map has about the given number of nodes
+ * @param options Options providing everything but the grid size
+ * @param nodes Target node count
+ */
+int SyntheticGridForNodes(const SyntheticMapOptions &options, std::size_t nodes);
+
+/**
+ * @brief Streams a synthetic map as OSM XML
+ * @param os Destination stream
+ * @param options Map parameters
+ * @return The element counts
+ */
+SyntheticMapStats WriteSyntheticOsm(std::ostream &os, const SyntheticMapOptions &options);
+
+/**
+ * @brief Returns a synthetic map as OSM XML bytes, ready for Model
+ */
+std::vector<std::byte> GenerateSyntheticOsm(const SyntheticMapOptions &options);
+
+#endif
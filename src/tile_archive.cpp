@@ -0,0 +1,231 @@
+#include "tile_archive.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+#include "artifact_store.h"
+
+namespace {
+
+constexpr char kMagic[8] = {'O', 'S', 'M', 'R', 'T', 'I', 'L', 'E'};
+constexpr char kIndexMagic[8] = {'O', 'S', 'M', 'R', 'T', 'I', 'D', 'X'};
+constexpr std::uint32_t kFormatVersion = 1;
+constexpr std::uint32_t kEndianTag = 0x01020304u;
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t endian_tag;
+};
+
+struct RecordHeader {
+    std::uint32_t z, x, y;
+    std::uint32_t size;
+    std::uint64_t checksum;
+};
+
+struct IndexEntry {
+    std::uint32_t z, x, y;
+    std::uint32_t size;
+    std::uint64_t offset;
+    std::uint64_t checksum;
+};
+
+struct Footer {
+    std::uint64_t index_offset;
+    std::uint64_t count;
+    std::uint64_t index_checksum;
+    char magic[8];
+};
+static_assert(sizeof(FileHeader) == 16, "unexpected tile archive header layout");
+static_assert(sizeof(RecordHeader) == 24, "unexpected tile record layout");
+static_assert(sizeof(IndexEntry) == 32, "unexpected tile index layout");
+static_assert(sizeof(Footer) == 32, "unexpected tile footer layout");
+
+template <typename T>
+bool ReadAt(std::ifstream &is, std::uint64_t offset, T &value)
+{
+    is.seekg(static_cast<std::streamoff>(offset));
+    return static_cast<bool>(is.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+bool ValidHeader(std::ifstream &is)
+{
+    FileHeader header;
+    return ReadAt(is, 0, header) && std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 &&
+           header.version == kFormatVersion && header.endian_tag == kEndianTag;
+}
+
+/**
+ * @brief Reads the footer of a finished archive
+ * @return The footer, or nullopt if the file doesn't end with a plausible one
+ */
+std::optional<Footer> ReadFooter(std::ifstream &is, std::uint64_t file_size)
+{
+    Footer footer;
+    if (file_size < sizeof(FileHeader) + sizeof(Footer) || !ReadAt(is, file_size - sizeof(Footer), footer) ||
+        std::memcmp(footer.magic, kIndexMagic, sizeof(kIndexMagic)) != 0 || footer.index_offset < sizeof(FileHeader) ||
+        footer.index_offset > file_size - sizeof(Footer) ||
+        footer.count != (file_size - sizeof(Footer) - footer.index_offset) / sizeof(IndexEntry) ||
+        (file_size - sizeof(Footer) - footer.index_offset) % sizeof(IndexEntry) != 0)
+        return std::nullopt;
+    return footer;
+}
+
+}  // namespace
+
+std::optional<TileArchiveWriter> TileArchiveWriter::Open(const std::string &path)
+{
+    TileArchiveWriter writer;
+    std::error_code error;
+    const auto file_size = std::filesystem::exists(path, error) ? std::filesystem::file_size(path, error) : 0;
+    if (error)
+        return std::nullopt;
+
+    if (file_size == 0) {
+        FileHeader header;
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kFormatVersion;
+        header.endian_tag = kEndianTag;
+        writer.m_Stream.open(path, std::ios::binary | std::ios::trunc);
+        writer.m_Stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        writer.m_End = sizeof(header);
+        if (!writer.m_Stream.flush())
+            return std::nullopt;
+        return writer;
+    }
+
+    // Keep every complete record; stop at the old index, a torn record or corrupt data.
+    std::uint64_t end = sizeof(FileHeader);
+    {
+        std::ifstream is{path, std::ios::binary};
+        if (!is || !ValidHeader(is))
+            return std::nullopt;
+        std::uint64_t records_end = file_size;
+        if (auto footer = ReadFooter(is, file_size))
+            records_end = footer->index_offset;
+        is.clear();
+
+        std::vector<char> data;
+        RecordHeader record;
+        while (end + sizeof(record) <= records_end && ReadAt(is, end, record) &&
+               record.size <= records_end - end - sizeof(record)) {
+            data.resize(record.size);
+            if (!is.read(data.data(), record.size) || Fnv1a64(data.data(), data.size()) != record.checksum)
+                break;
+            writer.m_Entries[{record.z, record.x, record.y}] = {end + sizeof(record), record.size, record.checksum};
+            end += sizeof(record) + record.size;
+        }
+    }
+    if (end != file_size) {
+        std::filesystem::resize_file(path, end, error);
+        if (error)
+            return std::nullopt;
+    }
+
+    writer.m_Stream.open(path, std::ios::binary | std::ios::app);
+    if (!writer.m_Stream)
+        return std::nullopt;
+    writer.m_End = end;
+    return writer;
+}
+
+bool TileArchiveWriter::Add(const TileKey &key, const void *data, std::size_t size)
+{
+    if (!m_Stream.is_open() || size > UINT32_MAX)
+        return false;
+    RecordHeader record{key.z, key.x, key.y, static_cast<std::uint32_t>(size), Fnv1a64(data, size)};
+    m_Stream.write(reinterpret_cast<const char *>(&record), sizeof(record));
+    if (size > 0)
+        m_Stream.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+    if (!m_Stream)
+        return false;
+    m_Entries[key] = {m_End + sizeof(record), record.size, record.checksum};
+    m_End += sizeof(record) + size;
+    return true;
+}
+
+bool TileArchiveWriter::Flush()
+{
+    return m_Stream.is_open() && m_Stream.flush();
+}
+
+bool TileArchiveWriter::Finish()
+{
+    if (!m_Stream.is_open())
+        return false;
+    std::vector<IndexEntry> index;
+    index.reserve(m_Entries.size());
+    for (const auto &[key, entry] : m_Entries)
+        index.push_back({key.z, key.x, key.y, entry.size, entry.offset, entry.checksum});
+
+    Footer footer;
+    footer.index_offset = m_End;
+    footer.count = index.size();
+    footer.index_checksum = Fnv1a64(index.data(), index.size() * sizeof(IndexEntry));
+    std::memcpy(footer.magic, kIndexMagic, sizeof(kIndexMagic));
+    m_Stream.write(reinterpret_cast<const char *>(index.data()), index.size() * sizeof(IndexEntry));
+    m_Stream.write(reinterpret_cast<const char *>(&footer), sizeof(footer));
+    m_Stream.close();
+    return !m_Stream.fail();
+}
+
+std::optional<TileArchive> TileArchive::Open(const std::string &path)
+{
+    TileArchive archive;
+    std::error_code error;
+    const auto file_size = std::filesystem::file_size(path, error);
+    if (error)
+        return std::nullopt;
+    archive.m_Stream.open(path, std::ios::binary);
+    auto &is = archive.m_Stream;
+    if (!is || !ValidHeader(is))
+        return std::nullopt;
+    const auto footer = ReadFooter(is, file_size);
+    if (!footer)
+        return std::nullopt;
+
+    std::vector<IndexEntry> index(footer->count);
+    is.seekg(static_cast<std::streamoff>(footer->index_offset));
+    if (!is.read(reinterpret_cast<char *>(index.data()), index.size() * sizeof(IndexEntry)) ||
+        Fnv1a64(index.data(), index.size() * sizeof(IndexEntry)) != footer->index_checksum)
+        return std::nullopt;
+
+    archive.m_Keys.reserve(index.size());
+    archive.m_Entries.reserve(index.size());
+    for (const auto &entry : index) {
+        if (entry.offset > footer->index_offset || entry.size > footer->index_offset - entry.offset)
+            return std::nullopt;
+        const TileKey key{entry.z, entry.x, entry.y};
+        if (!archive.m_Keys.empty() && !(archive.m_Keys.back() < key))
+            return std::nullopt;
+        archive.m_Keys.push_back(key);
+        archive.m_Entries.push_back({entry.offset, entry.size, entry.checksum});
+    }
+    return archive;
+}
+
+const TileArchiveEntry *TileArchive::Find(const TileKey &key) const
+{
+    const auto it = std::lower_bound(m_Keys.begin(), m_Keys.end(), key);
+    if (it == m_Keys.end() || !(*it == key))
+        return nullptr;
+    return &m_Entries[it - m_Keys.begin()];
+}
+
+std::optional<std::vector<std::byte>> TileArchive::Read(const TileKey &key) const
+{
+    const auto *entry = Find(key);
+    if (!entry)
+        return std::nullopt;
+    std::vector<std::byte> data(entry->size);
+    if (entry->size > 0) {
+        m_Stream.clear();
+        m_Stream.seekg(static_cast<std::streamoff>(entry->offset));
+        if (!m_Stream.read(reinterpret_cast<char *>(data.data()), entry->size))
+            return std::nullopt;
+    }
+    if (Fnv1a64(data.data(), data.size()) != entry->checksum)
+        return std::nullopt;
+    return data;
+}
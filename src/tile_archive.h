@@ -0,0 +1,145 @@
+/**
+ * @file tile_archive.h
+ * @brief Single-file container for a z/x/y map tile pyramid
+ *
+ * This file contains the tile archive format written by the tile generator.
+ * Tiles are appended as checksummed records, so an interrupted run can be
+ * resumed: reopening the archive keeps every complete record and cuts off a
+ * torn tail. Finishing the archive appends a sorted index and a footer that
+ * readers use to find tiles without scanning. A record of size zero marks a
+ * tile that was found to be empty.
+ */
+
+#ifndef TILE_ARCHIVE_H
+#define TILE_ARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/**
+ * @struct TileKey
+ * @brief Address of a tile in the XYZ scheme, y counted from the north
+ */
+struct TileKey {
+    std::uint32_t z = 0;  ///< Zoom level
+    std::uint32_t x = 0;  ///< Column, from the west
+    std::uint32_t y = 0;  ///< Row, from the north
+
+    bool operator<(const TileKey &other) const noexcept {
+        return std::tie(z, x, y) < std::tie(other.z, other.x, other.y);
+    }
+    bool operator==(const TileKey &other) const noexcept {
+        return z == other.z && x == other.x && y == other.y;
+    }
+};
+
+/**
+ * @struct TileArchiveEntry
+ * @brief Location of one tile in the archive file
+ */
+struct TileArchiveEntry {
+    std::uint64_t offset = 0;    ///< Byte offset of the tile data
+    std::uint32_t size = 0;      ///< Size of the tile data; 0 for an empty tile
+    std::uint64_t checksum = 0;  ///< FNV-1a 64 of the tile data
+};
+
+/**
+ * @class TileArchiveWriter
+ * @brief Appends tiles to an archive, resuming where a previous run stopped
+ *
+ * Not thread-safe; callers that produce tiles in parallel serialize Add().
+ */
+class TileArchiveWriter {
+  public:
+    /**
+     * @brief Opens an archive for appending, creating it if it doesn't exist
+     *
+     * Complete records of an existing archive are kept; a torn last record
+     * and an old index are cut off. Tiles that are stored again later replace
+     * the earlier record.
+     *
+     * @return The writer, or nullopt if the file can't be opened or isn't a tile archive
+     */
+    static std::optional<TileArchiveWriter> Open(const std::string &path);
+
+    /**
+     * @brief Returns true if the archive already holds a tile, empty or not
+     */
+    bool Contains(const TileKey &key) const { return m_Entries.count(key) != 0; }
+
+    /**
+     * @brief Returns the number of distinct tiles stored
+     */
+    std::size_t Size() const noexcept { return m_Entries.size(); }
+
+    /**
+     * @brief Appends a tile
+     * @param data Tile contents, e.g. PNG bytes; size 0 records an empty tile
+     * @return True on success
+     */
+    bool Add(const TileKey &key, const void *data, std::size_t size);
+
+    /**
+     * @brief Pushes buffered records to the file, making them survive a crash of the process
+     */
+    bool Flush();
+
+    /**
+     * @brief Writes the index and footer and closes the file
+     * @return True on success; the writer accepts no tiles afterwards
+     */
+    bool Finish();
+
+  private:
+    TileArchiveWriter() = default;
+
+    std::ofstream m_Stream;                         ///< Append stream, closed after Finish()
+    std::uint64_t m_End = 0;                        ///< Current file size
+    std::map<TileKey, TileArchiveEntry> m_Entries;  ///< Latest record of every tile
+};
+
+/**
+ * @class TileArchive
+ * @brief Read access to a finished tile archive through its index
+ *
+ * Reads share one file stream and are not thread-safe.
+ */
+class TileArchive {
+  public:
+    /**
+     * @brief Opens a finished archive
+     * @return The archive, or nullopt if it is missing, corrupt or was never finished
+     */
+    static std::optional<TileArchive> Open(const std::string &path);
+
+    /**
+     * @brief Returns the index entry of a tile, or nullptr if the archive doesn't hold it
+     */
+    const TileArchiveEntry *Find(const TileKey &key) const;
+
+    /**
+     * @brief Reads a tile's data
+     * @return The data, empty for an empty tile, or nullopt if the tile is missing or corrupt
+     */
+    std::optional<std::vector<std::byte>> Read(const TileKey &key) const;
+
+    /**
+     * @brief Returns the keys of all tiles in ascending order
+     */
+    const std::vector<TileKey> &Keys() const noexcept { return m_Keys; }
+
+  private:
+    TileArchive() = default;
+
+    mutable std::ifstream m_Stream;               ///< Archive file
+    std::vector<TileKey> m_Keys;                  ///< Sorted tile keys
+    std::vector<TileArchiveEntry> m_Entries;      ///< Entry of every key, same order
+};
+
+#endif
@@ -0,0 +1,133 @@
+/**
+ * @file viewport.h
+ * @brief Visible part of the map and its mapping to surface pixels
+ *
+ * This file contains BoundingBox, an axis-aligned box in normalized map
+ * coordinates, and Viewport, which places a surface of a given pixel size
+ * over the map by center and zoom. Neither depends on a graphics library, so
+ * spatial queries and tile tools can share them with Render.
+ */
+
+#ifndef VIEWPORT_H
+#define VIEWPORT_H
+
+#include <algorithm>
+#include <utility>
+
+/**
+ * @struct BoundingBox
+ * @brief Axis-aligned box in normalized map coordinates
+ */
+struct BoundingBox {
+    float min_x = 0.f;  ///< Smallest x-coordinate
+    float min_y = 0.f;  ///< Smallest y-coordinate
+    float max_x = 0.f;  ///< Largest x-coordinate
+    float max_y = 0.f;  ///< Largest y-coordinate
+
+    /**
+     * @brief Checks whether two boxes overlap, touching edges included
+     */
+    bool Intersects(const BoundingBox &other) const noexcept {
+        return min_x <= other.max_x && other.min_x <= max_x && min_y <= other.max_y && other.min_y <= max_y;
+    }
+
+    /**
+     * @brief Checks whether another box lies completely inside this one
+     */
+    bool Contains(const BoundingBox &other) const noexcept {
+        return min_x <= other.min_x && other.max_x <= max_x && min_y <= other.min_y && other.max_y <= max_y;
+    }
+
+    /**
+     * @brief Returns the box grown by a margin on every side
+     */
+    BoundingBox Expanded(float margin) const noexcept {
+        return {min_x - margin, min_y - margin, max_x + margin, max_y + margin};
+    }
+};
+
+/**
+ * @struct Viewport
+ * @brief A surface of width x height pixels centered on a map position
+ *
+ * At zoom 1 the shorter side of the surface spans one normalized unit, i.e.
+ * the whole map. Pixel y grows downwards while map y grows northwards.
+ */
+struct Viewport {
+    double center_x = 0.5;  ///< Map x-coordinate shown at the surface center
+    double center_y = 0.5;  ///< Map y-coordinate shown at the surface center
+    double zoom = 1.;       ///< Magnification; 2 shows half the map width
+    int width = 0;          ///< Surface width in pixels
+    int height = 0;         ///< Surface height in pixels
+
+    /**
+     * @brief Returns the viewport that shows the whole map on a surface
+     *
+     * The map's origin lands in the bottom-left corner, as Render has always
+     * drawn it.
+     */
+    static Viewport Fit(int width, int height) noexcept {
+        const double scale = std::min(width, height);
+        return {width / (2. * scale), height / (2. * scale), 1., width, height};
+    }
+
+    /**
+     * @brief Returns the number of pixels per normalized unit
+     */
+    double Scale() const noexcept { return zoom * std::min(width, height); }
+
+    /**
+     * @brief Returns the map area covered by the surface
+     */
+    BoundingBox Bounds() const noexcept { return Bounds(0, 0, width, height); }
+
+    /**
+     * @brief Returns the map area covered by a rectangle of surface pixels
+     */
+    BoundingBox Bounds(int x, int y, int w, int h) const noexcept {
+        const auto [min_x, max_y] = ToMap(x, y);
+        const auto [max_x, min_y] = ToMap(x + w, y + h);
+        return {static_cast<float>(min_x), static_cast<float>(min_y), static_cast<float>(max_x), static_cast<float>(max_y)};
+    }
+
+    /**
+     * @brief Converts a map position to surface pixels
+     */
+    std::pair<double, double> ToPixel(double x, double y) const noexcept {
+        return {(x - center_x) * Scale() + width / 2., (center_y - y) * Scale() + height / 2.};
+    }
+
+    /**
+     * @brief Converts surface pixels to a map position
+     */
+    std::pair<double, double> ToMap(double px, double py) const noexcept {
+        return {center_x + (px - width / 2.) / Scale(), center_y - (py - height / 2.) / Scale()};
+    }
+
+    /**
+     * @brief Moves the map content by a number of pixels, like dragging it
+     */
+    void Pan(double dx_pixels, double dy_pixels) noexcept {
+        center_x -= dx_pixels / Scale();
+        center_y += dy_pixels / Scale();
+    }
+
+    /**
+     * @brief Zooms by a factor while keeping the map position under a pixel in place
+     */
+    void ZoomAt(double factor, double px, double py) noexcept {
+        const auto [x, y] = ToMap(px, py);
+        zoom *= factor;
+        const auto [nx, ny] = ToMap(px, py);
+        center_x += x - nx;
+        center_y += y - ny;
+    }
+
+    bool operator==(const Viewport &other) const noexcept {
+        return center_x == other.center_x && center_y == other.center_y && zoom == other.zoom &&
+               width == other.width && height == other.height;
+    }
+    bool operator!=(const Viewport &other) const noexcept { return !(*this == other); }
+};
+
+#endif
@@ -0,0 +1,168 @@
+#include "gtest/gtest.h"
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../src/route_model.h"
+#include "../src/route_planner.h"
+#include "../src/route_graph.h"
+#include "../src/graph_planner.h"
+
+// Defined in utest_rp_a_star_search.cpp.
+std::vector<std::byte> ReadOSMData(const std::string &path);
+
+// Test-mode allocation hook: the test binary replaces the global operator
+// new, which counts calls on threads that have an AllocationCounter active.
+// Every replaceable allocation and deallocation function is replaced, so that
+// each delete frees memory obtained from the matching replaced new.
+static thread_local bool t_CountAllocations = false;
+static thread_local std::size_t t_Allocations = 0;
+
+static void *CountedAllocate(std::size_t size, std::size_t alignment) noexcept
+{
+    if (t_CountAllocations)
+        ++t_Allocations;
+    if (size == 0)
+        size = 1;
+    if (alignment <= alignof(std::max_align_t))
+        return std::malloc(size);
+    // aligned_alloc requires the size to be a multiple of the alignment.
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+static void *CountedAllocateOrThrow(std::size_t size, std::size_t alignment)
+{
+    if (void *p = CountedAllocate(size, alignment))
+        return p;
+    throw std::bad_alloc{};
+}
+
+static void CountedFree(void *p) noexcept { std::free(p); }
+
+void *operator new(std::size_t size) { return CountedAllocateOrThrow(size, 0); }
+void *operator new[](std::size_t size) { return CountedAllocateOrThrow(size, 0); }
+void *operator new(std::size_t size, std::align_val_t al) { return CountedAllocateOrThrow(size, std::size_t(al)); }
+void *operator new[](std::size_t size, std::align_val_t al) { return CountedAllocateOrThrow(size, std::size_t(al)); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return CountedAllocate(size, 0); }
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return CountedAllocate(size, 0); }
+void *operator new(std::size_t size, std::align_val_t al, const std::nothrow_t &) noexcept
+{
+    return CountedAllocate(size, std::size_t(al));
+}
+void *operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t &) noexcept
+{
+    return CountedAllocate(size, std::size_t(al));
+}
+
+void operator delete(void *p) noexcept { CountedFree(p); }
+void operator delete[](void *p) noexcept { CountedFree(p); }
+void operator delete(void *p, std::size_t) noexcept { CountedFree(p); }
+void operator delete[](void *p, std::size_t) noexcept { CountedFree(p); }
+void operator delete(void *p, std::align_val_t) noexcept { CountedFree(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { CountedFree(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { CountedFree(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { CountedFree(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { CountedFree(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { CountedFree(p); }
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept { CountedFree(p); }
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept { CountedFree(p); }
+
+/**
+ * @class AllocationCounter
+ * @brief Counts the heap allocations of the calling thread during its lifetime
+ */
+class AllocationCounter {
+  public:
+    AllocationCounter() {
+        t_Allocations = 0;
+        t_CountAllocations = true;
+    }
+    ~AllocationCounter() { t_CountAllocations = false; }
+
+    std::size_t Count() const noexcept { return t_Allocations; }
+};
+
+//--------------------------------//
+//   Beginning AllocationFree Tests.
+//--------------------------------//
+
+class AllocationFreeTest : public ::testing::Test {
+  protected:
+    // Runs one RoutePlanner query with the shared context and returns distance and path size.
+    std::pair<float, std::size_t> Query(float start_x, float start_y, float end_x, float end_y) {
+        model.ResetSearch();
+        RoutePlanner planner{model, context, start_x, start_y, end_x, end_y};
+        planner.AStarSearch();
+        return {planner.GetDistance(), model.path.size()};
+    }
+
+    std::vector<std::byte> osm_data = ReadOSMData("../map.osm");
+    RouteModel model{osm_data};
+    RoutePlanner::Context context{model};
+    const std::vector<std::pair<float, float>> queries[2] = {
+        {{10, 10}, {90, 90}}, {{80, 20}, {15, 70}}};
+};
+
+
+// Test that the counter sees allocations at all.
+TEST_F(AllocationFreeTest, TestCounterCountsAllocations) {
+    AllocationCounter counter;
+    std::vector<int> buffer(16);
+    EXPECT_GE(counter.Count(), 1u);
+}
+
+// Test that warmed-up RoutePlanner queries don't allocate and match the original results.
+TEST_F(AllocationFreeTest, TestRoutePlannerSteadyState) {
+    std::vector<std::pair<float, std::size_t>> warm;
+    for (const auto &q : queries)
+        warm.push_back(Query(q[0].first, q[0].second, q[1].first, q[1].second));
+    EXPECT_NEAR(warm[0].first, 873.41565, 1e-4);
+    EXPECT_EQ(warm[0].second, 33u);
+
+    for (std::size_t i = 0; i < 2; ++i) {
+        const auto &q = queries[i];
+        std::pair<float, std::size_t> result;
+        {
+            AllocationCounter counter;
+            result = Query(q[0].first, q[0].second, q[1].first, q[1].second);
+            EXPECT_EQ(counter.Count(), 0u);
+        }
+        EXPECT_EQ(result, warm[i]);
+    }
+}
+
+// Test that the in-place path matches the path built by the original overload.
+TEST_F(AllocationFreeTest, TestInPlacePathMatchesCopy) {
+    Query(10, 10, 90, 90);
+    RoutePlanner planner{model, context, 10, 10, 90, 90};
+    auto *end = &model.FindClosestNode(0.9f, 0.9f);
+    const auto copied = planner.ConstructFinalPath(end);
+    const float copied_distance = planner.GetDistance();
+    std::vector<RouteModel::Node> in_place;
+    planner.ConstructFinalPath(end, in_place);
+    ASSERT_EQ(in_place.size(), copied.size());
+    for (std::size_t i = 0; i < copied.size(); ++i) {
+        EXPECT_EQ(in_place[i].x, copied[i].x);
+        EXPECT_EQ(in_place[i].y, copied[i].y);
+        EXPECT_TRUE(in_place[i].neighbors.empty());
+    }
+    EXPECT_EQ(planner.GetDistance(), copied_distance);
+}
+
+// Test that warmed-up GraphPlanner queries read through Result() don't allocate.
+TEST_F(AllocationFreeTest, TestGraphPlannerSteadyState) {
+    const auto graph = RouteGraph::Build(model);
+    GraphPlanner planner{graph};
+    const int s = graph.ClosestNode(0.1f, 0.1f), t = graph.ClosestNode(0.9f, 0.9f);
+    planner.Start(s, t);
+    while (planner.Step() == SearchStatus::Running) {}
+    const auto warm = planner.Result().nodes;
+
+    AllocationCounter counter;
+    planner.Start(s, t);
+    while (planner.Step() == SearchStatus::Running) {}
+    EXPECT_EQ(counter.Count(), 0u);
+    EXPECT_EQ(planner.Result().nodes, warm);
+}
@@ -0,0 +1,172 @@
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iterator>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/route_model.h"
+#include "../src/route_graph.h"
+#include "../src/graph_planner.h"
+#include "../src/artifact_store.h"
+
+// Defined in utest_rp_a_star_search.cpp.
+std::vector<std::byte> ReadOSMData(const std::string &path);
+
+//--------------------------------//
+//   Beginning ArtifactStore Tests.
+//--------------------------------//
+
+class ArtifactStoreTest : public ::testing::Test {
+  protected:
+    void TearDown() override { std::remove(path.c_str()); }
+
+    std::vector<std::byte> osm_data = ReadOSMData("../map.osm");
+    RouteModel model{osm_data};
+    std::string path = "utest_artifact_store.bin";
+};
+
+
+// Test that a saved graph is mapped back with identical arrays and routes.
+TEST_F(ArtifactStoreTest, TestGraphRoundTrip) {
+    std::remove(path.c_str());
+    RouteGraph built = RouteGraph::LoadOrBuild(model, path);
+    RouteGraph loaded = RouteGraph::LoadOrBuild(model, path);
+
+    ASSERT_EQ(loaded.NumNodes(), built.NumNodes());
+    ASSERT_EQ(loaded.NumEdges(), built.NumEdges());
+    for (int v = 0; v <= loaded.NumNodes(); ++v)
+        EXPECT_EQ(loaded.FirstOut(v), built.FirstOut(v));
+    for (int e = 0; e < loaded.NumEdges(); ++e) {
+        EXPECT_EQ(loaded.Head(e), built.Head(e));
+        EXPECT_EQ(loaded.Weight(e), built.Weight(e));
+        EXPECT_EQ(loaded.IntWeight(e), built.IntWeight(e));
+    }
+
+    GraphPlanner a{built}, b{loaded};
+    const int source = built.ClosestNode(0.1f, 0.1f);
+    const int target = built.ClosestNode(0.9f, 0.9f);
+    EXPECT_EQ(a.Search(source, target).nodes, b.Search(source, target).nodes);
+}
+
+
+// Test that the graph fingerprint tells apart every metric and nearby cost units.
+TEST_F(ArtifactStoreTest, TestGraphFingerprintParameters) {
+    const auto base = RouteGraph::Fingerprint(model, EuclideanDistance::kName, 0.001);
+    EXPECT_EQ(RouteGraph::Fingerprint(model, EuclideanDistance::kName, 0.001), base);
+    EXPECT_NE(RouteGraph::Fingerprint(model, EuclideanDistance::kName, 0.0010000001), base);
+    EXPECT_NE(RouteGraph::Fingerprint(model, EuclideanDistance::kName, 1e-9), RouteGraph::Fingerprint(model, EuclideanDistance::kName, 2e-9));
+    EXPECT_NE(RouteGraph::Fingerprint(model, EquirectangularDistance::kName, 0.001), base);
+    EXPECT_NE(RouteGraph::Fingerprint(model, HaversineDistance::kName, 0.001), base);
+    EXPECT_NE(RouteGraph::Fingerprint(model, HaversineDistance::kName, 0.001),
+              RouteGraph::Fingerprint(model, EquirectangularDistance::kName, 0.001));
+}
+
+
+// Test that files with another fingerprint or corrupted sections are rejected.
+TEST_F(ArtifactStoreTest, TestStaleAndCorruptFiles) {
+    const std::vector<int> values{1, 2, 3, 4, 5};
+    ArtifactWriter writer;
+    writer.AddArray("values", values);
+    writer.AddValue("answer", 42.);
+    ASSERT_TRUE(writer.Write(path, 7));
+
+    auto file = ArtifactFile::Open(path, 7);
+    ASSERT_TRUE(file);
+    auto array = file->Array<int>("values");
+    ASSERT_TRUE(array);
+    EXPECT_TRUE(array->IsMapped());
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(array->data()) % ArtifactFile::kSectionAlignment, 0u);
+    EXPECT_EQ(std::vector<int>(array->begin(), array->end()), values);
+    EXPECT_EQ(file->Value<double>("answer"), 42.);
+    EXPECT_FALSE(file->Array<float>("answer"));
+    EXPECT_FALSE(file->Has("missing"));
+
+    EXPECT_FALSE(ArtifactFile::Open(path, 8));
+
+    // Flip one byte inside the "values" section.
+    file.reset();
+    array.reset();
+    std::vector<char> bytes;
+    {
+        std::ifstream is{path, std::ios::binary};
+        bytes.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+    }
+    const auto *first = reinterpret_cast<const char *>(values.data());
+    auto it = std::search(bytes.begin(), bytes.end(), first, first + values.size() * sizeof(int));
+    ASSERT_NE(it, bytes.end());
+    it[sizeof(int)] ^= 0x5a;
+    {
+        std::ofstream os{path, std::ios::binary | std::ios::trunc};
+        os.write(bytes.data(), bytes.size());
+    }
+    EXPECT_FALSE(ArtifactFile::Open(path, 7));
+}
+
+
+// Test that a graph file whose node map points outside the graph is rejected.
+TEST_F(ArtifactStoreTest, TestGraphNodeOutOfRange) {
+    RouteGraph graph = RouteGraph::Build(model);
+    ArtifactWriter writer;
+    graph.Save(writer);
+    ASSERT_TRUE(writer.Write(path, 1));
+    {
+        auto file = ArtifactFile::Open(path, 1);
+        ASSERT_TRUE(file);
+        EXPECT_TRUE(RouteGraph::Load(*file, model));
+    }
+
+    // Point one model node past the last graph node, then skip the checksums
+    // so the inconsistency reaches Load().
+    std::vector<int> graph_node(model.Nodes().size());
+    for (std::size_t i = 0; i < graph_node.size(); ++i)
+        graph_node[i] = graph.GraphNode(static_cast<int>(i));
+    std::vector<char> bytes;
+    {
+        std::ifstream is{path, std::ios::binary};
+        bytes.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+    }
+    const auto *first = reinterpret_cast<const char *>(graph_node.data());
+    auto it = std::search(bytes.begin(), bytes.end(), first, first + graph_node.size() * sizeof(int));
+    ASSERT_NE(it, bytes.end());
+    const int out_of_range = graph.NumNodes() + 5;
+    std::memcpy(&*it, &out_of_range, sizeof(int));
+    {
+        std::ofstream os{path, std::ios::binary | std::ios::trunc};
+        os.write(bytes.data(), bytes.size());
+    }
+    auto file = ArtifactFile::Open(path, 1, false);
+    ASSERT_TRUE(file);
+    EXPECT_FALSE(RouteGraph::Load(*file, model));
+}
+
+
+// Test that concurrent writers of one artifact leave a complete file and no temporaries.
+TEST_F(ArtifactStoreTest, TestConcurrentWriters) {
+    constexpr int kWriters = 8;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kWriters; ++i)
+        threads.emplace_back([this, i] {
+            const std::vector<int> values(4096, i);
+            ArtifactWriter writer;
+            writer.AddArray("values", values);
+            for (int round = 0; round < 10; ++round)
+                EXPECT_TRUE(writer.Write(path, 7));
+        });
+    for (auto &thread : threads)
+        thread.join();
+
+    auto file = ArtifactFile::Open(path, 7);
+    ASSERT_TRUE(file);
+    auto array = file->Array<int>("values");
+    ASSERT_TRUE(array);
+    ASSERT_EQ(array->size(), 4096u);
+    EXPECT_TRUE(std::all_of(array->begin(), array->end(), [&](int v) { return v == (*array)[0]; }));
+
+    for (const auto &entry : std::filesystem::directory_iterator{"."}) {
+        const auto name = entry.path().filename().string();
+        EXPECT_FALSE(name != path && name.rfind(path, 0) == 0) << "left behind " << name;
+    }
+}
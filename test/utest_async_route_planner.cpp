@@ -0,0 +1,76 @@
+#include "gtest/gtest.h"
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+#include "../src/route_model.h"
+#include "../src/route_graph.h"
+#include "../src/graph_planner.h"
+#include "../src/async_route_planner.h"
+
+// Defined in utest_rp_a_star_search.cpp.
+std::vector<std::byte> ReadOSMData(const std::string &path);
+
+// Executor that runs jobs only when the test asks it to.
+class ManualExecutor {
+  public:
+    void Post(std::function<void()> job) { m_Jobs.push_back(std::move(job)); }
+    bool RunOne() {
+        if (m_Jobs.empty())
+            return false;
+        auto job = std::move(m_Jobs.front());
+        m_Jobs.pop_front();
+        job();
+        return true;
+    }
+
+  private:
+    std::deque<std::function<void()>> m_Jobs;
+};
+
+//--------------------------------//
+//   Beginning RouteAsync Tests.
+//--------------------------------//
+
+class AsyncRoutePlannerTest : public ::testing::Test {
+  protected:
+    std::vector<std::byte> osm_data = ReadOSMData("../map.osm");
+    RouteModel model{osm_data};
+    RouteGraph graph = RouteGraph::Build(model);
+    int source = graph.ClosestNode(0.1f, 0.1f);
+    int target = graph.ClosestNode(0.9f, 0.9f);
+};
+
+
+// Test that an asynchronous query returns the synchronous result.
+TEST_F(AsyncRoutePlannerTest, TestMatchesSynchronousSearch) {
+    GraphPlanner planner{graph};
+    GraphPath expected = planner.Search(source, target);
+
+    ThreadPoolExecutor executor{2};
+    RouteResult result = SyncWait(RouteAsync(executor, graph, source, target, {}, 16));
+    EXPECT_EQ(result.status, RouteStatus::Found);
+    EXPECT_EQ(result.path.nodes, expected.nodes);
+    EXPECT_FLOAT_EQ(result.path.distance, expected.distance);
+    EXPECT_EQ(result.expansions, planner.Expansions());
+}
+
+
+// Test that a query yields every slice and stops once cancelled.
+TEST_F(AsyncRoutePlannerTest, TestCancellation) {
+    ManualExecutor executor;
+    CancellationToken token;
+    std::optional<RouteResult> result;
+    Spawn(RouteAsync(executor, graph, source, target, token, 1), [&](RouteResult r) { result = std::move(r); });
+
+    for (int i = 0; i < 5; ++i)
+        ASSERT_TRUE(executor.RunOne());
+    EXPECT_FALSE(result.has_value());
+
+    token.Cancel();
+    while (executor.RunOne()) {}
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->status, RouteStatus::Cancelled);
+    EXPECT_TRUE(result->path.nodes.empty());
+    EXPECT_LE(result->expansions, 5u);
+}
@@ -0,0 +1,125 @@
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "../src/model.h"
+#include "../src/feature_index.h"
+#include "../src/viewport.h"
+
+// Defined in utest_rp_a_star_search.cpp.
+std::vector<std::byte> ReadOSMData(const std::string &path);
+
+//--------------------------------//
+//   Beginning FeatureIndex Tests.
+//--------------------------------//
+
+class FeatureIndexTest : public ::testing::Test {
+  protected:
+    // Features of a layer intersecting a box, by brute force.
+    std::vector<int> Intersecting(FeatureLayer layer, const BoundingBox &box) const {
+        std::vector<int> features;
+        for (int f = 0; f < index.Size(layer); ++f)
+            if (index.Bounds(layer, f).Intersects(box))
+                features.push_back(f);
+        return features;
+    }
+
+    std::vector<std::byte> osm_data = ReadOSMData("../map.osm");
+    Model model{osm_data};
+    FeatureIndex index{model};
+};
+
+
+// Test that every layer is indexed and each box encloses its feature.
+TEST_F(FeatureIndexTest, TestBoundsEncloseFeatures) {
+    EXPECT_EQ(index.Size(FeatureLayer::Road), static_cast<int>(model.Roads().size()));
+    EXPECT_EQ(index.Size(FeatureLayer::Building), static_cast<int>(model.Buildings().size()));
+    EXPECT_EQ(index.Size(FeatureLayer::Landuse), static_cast<int>(model.Landuses().size()));
+    for (int r = 0; r < index.Size(FeatureLayer::Road); ++r) {
+        const auto &box = index.Bounds(FeatureLayer::Road, r);
+        for (auto n : model.Ways()[model.Roads()[r].way].nodes) {
+            const auto &node = model.Nodes()[n];
+            EXPECT_TRUE(box.Contains({float(node.x), float(node.y), float(node.x), float(node.y)}));
+        }
+        EXPECT_TRUE(index.Extent().Contains(box));
+    }
+}
+
+// Test that queries match brute force in drawing order.
+TEST_F(FeatureIndexTest, TestQueryMatchesBruteForce) {
+    std::mt19937 rng{7};
+    std::uniform_real_distribution<float> coordinate{-0.1f, 1.1f};
+    std::uniform_real_distribution<float> size{0.f, 0.3f};
+    std::vector<int> features;
+    for (int i = 0; i < 100; ++i) {
+        const float x = coordinate(rng), y = coordinate(rng);
+        const BoundingBox box{x, y, x + size(rng), y + size(rng)};
+        for (int layer = 0; layer < kFeatureLayers; ++layer) {
+            index.Query(static_cast<FeatureLayer>(layer), box, features);
+            EXPECT_EQ(features, Intersecting(static_cast<FeatureLayer>(layer), box));
+        }
+    }
+
+    // A box around the whole map returns every feature.
+    index.Query(FeatureLayer::Building, index.Extent().Expanded(1.f), features);
+    EXPECT_EQ(static_cast<int>(features.size()), index.Size(FeatureLayer::Building));
+    index.Query(FeatureLayer::Building, {2.f, 2.f, 3.f, 3.f}, features);
+    EXPECT_TRUE(features.empty());
+}
+
+// Test that visible queries widen the view by the stroke margin and drop sub-pixel features.
+TEST_F(FeatureIndexTest, TestQueryVisible) {
+    const BoundingBox view{0.4f, 0.4f, 0.6f, 0.6f};
+    const double scale = 1000., metric_scale = 2000.;
+    const float widest = 6.f, pixel = 1.f / 1000.f;
+    // Half of 6 m at 0.5 px/m is 1.5 px, plus one pixel for antialiasing.
+    const auto margin = 2.5f * pixel;
+    std::vector<int> features;
+    for (int layer = 0; layer < kFeatureLayers; ++layer) {
+        index.QueryVisible(static_cast<FeatureLayer>(layer), view, scale, metric_scale, widest, 0.f, features);
+        EXPECT_EQ(features, Intersecting(static_cast<FeatureLayer>(layer), view.Expanded(margin)));
+    }
+
+    index.QueryVisible(FeatureLayer::Building, view, scale, metric_scale, widest, 20.f, features);
+    auto expected = Intersecting(FeatureLayer::Building, view.Expanded(margin));
+    expected.erase(std::remove_if(expected.begin(), expected.end(), [&](int f) {
+        const auto &box = index.Bounds(FeatureLayer::Building, f);
+        return box.max_x - box.min_x < 20.f * pixel && box.max_y - box.min_y < 20.f * pixel;
+    }), expected.end());
+    EXPECT_EQ(features, expected);
+    EXPECT_LT(features.size(), Intersecting(FeatureLayer::Building, view.Expanded(margin)).size());
+}
+
+// Test that the fitted viewport reproduces the original map transform.
+TEST(ViewportTest, TestFitMatchesOriginalTransform) {
+    const auto viewport = Viewport::Fit(400, 300);
+    for (auto [x, y] : {std::pair{0., 0.}, {1., 1.}, {0.25, 0.8}}) {
+        const auto [px, py] = viewport.ToPixel(x, y);
+        EXPECT_NEAR(px, x * 300, 1e-9);
+        EXPECT_NEAR(py, 300 - y * 300, 1e-9);
+    }
+    const auto bounds = viewport.Bounds();
+    EXPECT_NEAR(bounds.min_x, 0.f, 1e-6f);
+    EXPECT_NEAR(bounds.min_y, 0.f, 1e-6f);
+    EXPECT_NEAR(bounds.max_x, 4.f / 3.f, 1e-6f);
+    EXPECT_NEAR(bounds.max_y, 1.f, 1e-6f);
+}
+
+// Test that panning moves the content with the pointer and zooming keeps the pointed position.
+TEST(ViewportTest, TestPanAndZoom) {
+    auto viewport = Viewport::Fit(400, 400);
+    const auto [x, y] = viewport.ToMap(100, 50);
+    viewport.Pan(20, -10);
+    auto [px, py] = viewport.ToPixel(x, y);
+    EXPECT_NEAR(px, 120, 1e-9);
+    EXPECT_NEAR(py, 40, 1e-9);
+
+    viewport.ZoomAt(4, 120, 40);
+    std::tie(px, py) = viewport.ToPixel(x, y);
+    EXPECT_NEAR(px, 120, 1e-9);
+    EXPECT_NEAR(py, 40, 1e-9);
+    EXPECT_NEAR(viewport.Bounds().max_x - viewport.Bounds().min_x, 0.25f, 1e-6f);
+}
@@ -0,0 +1,120 @@
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include "../src/model.h"
+#include "../src/geometry_lod.h"
+
+// Defined in utest_rp_a_star_search.cpp.
+std::vector<std::byte> ReadOSMData(const std::string &path);
+
+//--------------------------------//
+//   Beginning GeometryLod Tests.
+//--------------------------------//
+
+class GeometryLodTest : public ::testing::Test {
+  protected:
+    // Distance from a node to the nearest segment of a simplified way.
+    double Deviation(const Model::Node &p, GeometryLod::NodeRange way) const {
+        const auto &nodes = model.Nodes();
+        double best = std::numeric_limits<double>::max();
+        for (auto it = way.begin(); it + 1 != way.end(); ++it) {
+            const auto &a = nodes[*it], &b = nodes[*(it + 1)];
+            const double dx = b.x - a.x, dy = b.y - a.y, length2 = dx * dx + dy * dy;
+            const double t = length2 > 0. ? std::clamp(((p.x - a.x) * dx + (p.y - a.y) * dy) / length2, 0., 1.) : 0.;
+            best = std::min(best, std::hypot(a.x + t * dx - p.x, a.y + t * dy - p.y));
+        }
+        return best;
+    }
+
+    std::vector<std::byte> osm_data = ReadOSMData("../map.osm");
+    Model model{osm_data};
+    GeometryLod lod{model};
+};
+
+
+// Test that band 0 is the original geometry and coarser bands never add nodes.
+TEST_F(GeometryLodTest, TestBandsShrinkMonotonically) {
+    ASSERT_EQ(lod.Bands(), 6);
+    std::size_t original = 0, coarsest = 0;
+    for (int w = 0; w < static_cast<int>(model.Ways().size()); ++w) {
+        const auto &nodes = model.Ways()[w].nodes;
+        const auto band0 = lod.Nodes(0, w);
+        ASSERT_TRUE(std::equal(band0.begin(), band0.end(), nodes.begin(), nodes.end()));
+        for (int b = 1; b < lod.Bands(); ++b)
+            EXPECT_LE(lod.Nodes(b, w).size(), lod.Nodes(b - 1, w).size());
+        original += nodes.size();
+        coarsest += lod.Nodes(lod.Bands() - 1, w).size();
+    }
+    EXPECT_LT(coarsest, original);
+    EXPECT_LT(lod.StoredNodes(), original * (lod.Bands() - 1));
+}
+
+// Test that simplified ways stay within tolerance and keep endpoints, junctions and ring shape.
+TEST_F(GeometryLodTest, TestSimplificationIsTopologySafe) {
+    std::vector<int> uses(model.Nodes().size(), 0);
+    for (const auto &way : model.Ways())
+        for (std::size_t i = 0; i < way.nodes.size(); ++i)
+            if (i + 1 < way.nodes.size() || way.nodes.front() != way.nodes.back())
+                ++uses[way.nodes[i]];
+
+    for (int b = 1; b < lod.Bands(); ++b)
+        for (int w = 0; w < static_cast<int>(model.Ways().size()); ++w) {
+            const auto &nodes = model.Ways()[w].nodes;
+            if (nodes.empty())
+                continue;
+            const auto simplified = lod.Nodes(b, w);
+            ASSERT_FALSE(simplified.empty());
+            EXPECT_EQ(simplified.front(), nodes.front());
+            EXPECT_EQ(simplified.back(), nodes.back());
+            if (nodes.size() >= 4 && nodes.front() == nodes.back()) {
+                EXPECT_GE(simplified.size(), 4u);
+            }
+            for (auto n : nodes) {
+                if (uses[n] > 1) {
+                    EXPECT_NE(std::find(simplified.begin(), simplified.end(), n), simplified.end());
+                }
+                if (simplified.size() > 1) {
+                    EXPECT_LE(Deviation(model.Nodes()[n], simplified), lod.Tolerance(b) * (1 + 1e-9));
+                }
+            }
+        }
+}
+
+// Test that the band selection picks the coarsest band within a tolerance.
+TEST_F(GeometryLodTest, TestBandSelection) {
+    EXPECT_EQ(lod.Band(0.), 0);
+    EXPECT_EQ(lod.Band(lod.Tolerance(1) / 2), 0);
+    EXPECT_EQ(lod.Band(lod.Tolerance(2)), 2);
+    EXPECT_EQ(lod.Band(lod.Tolerance(3) * 1.5), 3);
+    EXPECT_EQ(lod.Band(1.), lod.Bands() - 1);
+}
+
+// Test that rings are visited in the requested orientation.
+TEST_F(GeometryLodTest, TestVisitRingOrientation) {
+    const auto &nodes = model.Nodes();
+    auto area = [&](const std::vector<int> &ring) {
+        double twice = 0.;
+        for (std::size_t i = 0; i < ring.size(); ++i) {
+            const auto &a = nodes[ring[i]], &b = nodes[ring[(i + 1) % ring.size()]];
+            twice += a.x * b.y - b.x * a.y;
+        }
+        return twice;
+    };
+    int rings = 0;
+    for (const auto &building : model.Buildings())
+        for (auto way : building.outer) {
+            for (bool counterclockwise : {true, false}) {
+                std::vector<int> visited;
+                lod.VisitRing(0, way, counterclockwise, [&](int n) { visited.push_back(n); });
+                ASSERT_EQ(visited.size(), model.Ways()[way].nodes.size());
+                if (area(visited) != 0.) {
+                    EXPECT_EQ(area(visited) > 0., counterclockwise);
+                }
+            }
+            ++rings;
+        }
+    EXPECT_GT(rings, 0);
+}
@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+#include <cmath>
+#include <string>
+#include <vector>
+#include "../src/route_model.h"
+#include "../src/route_graph.h"
+#include "../src/graph_planner.h"
+
+// Defined in utest_rp_a_star_search.cpp.
+std::vector<std::byte> ReadOSMData(const std::string &path);
+
+//--------------------------------//
+//   Beginning GraphPlanner Tests.
+//--------------------------------//
+
+class GraphPlannerTest : public ::testing::Test {
+  protected:
+    std::vector<std::byte> osm_data = ReadOSMData("../map.osm");
+    RouteModel model{osm_data};
+    RouteGraph graph = RouteGraph::Build(model);
+};
+
+
+// Test that the graph mirrors the model's road network.
+TEST_F(GraphPlannerTest, TestGraphStructure) {
+    ASSERT_GT(graph.NumNodes(), 0);
+    EXPECT_EQ(graph.NumEdges() % 2, 0);
+    for (int v = 0; v < graph.NumNodes(); ++v) {
+        EXPECT_EQ(graph.GraphNode(graph.ModelIndex(v)), v);
+        EXPECT_FLOAT_EQ(graph.X(v), model.Nodes()[graph.ModelIndex(v)].x);
+        for (auto e = graph.FirstOut(v); e < graph.FirstOut(v + 1); ++e)
+            EXPECT_GT(graph.Weight(e), 0.f);
+    }
+}
+
+
+// Test that A* finds a connected path as short as Dijkstra's.
+TEST_F(GraphPlannerTest, TestSearchMatchesDijkstra) {
+    GraphPlanner a_star{graph};
+    BasicGraphPlanner<ZeroDistance> dijkstra{graph};
+    const int source = graph.ClosestNode(0.1f, 0.1f);
+    const int target = graph.ClosestNode(0.9f, 0.9f);
+
+    GraphPath path = a_star.Search(source, target);
+    ASSERT_FALSE(path.nodes.empty());
+    EXPECT_EQ(path.nodes.front(), source);
+    EXPECT_EQ(path.nodes.back(), target);
+    for (std::size_t i = 1; i < path.nodes.size(); ++i) {
+        bool adjacent = false;
+        for (auto e = graph.FirstOut(path.nodes[i - 1]); e < graph.FirstOut(path.nodes[i - 1] + 1); ++e)
+            adjacent |= graph.Head(e) == path.nodes[i];
+        EXPECT_TRUE(adjacent);
+    }
+
+    GraphPath reference = dijkstra.Search(source, target);
+    EXPECT_NEAR(path.distance, reference.distance, 1e-3f * reference.distance);
+    EXPECT_LE(a_star.Expansions(), dijkstra.Expansions());
+
+    // Reusing the planner must give the same answer.
+    GraphPath again = a_star.Search(source, target);
+    EXPECT_EQ(again.nodes, path.nodes);
+}
+
+
+// Test that the radix heap pops in key order.
+TEST(RadixHeapQueueTest, TestPopOrder) {
+    RadixHeapQueue<int, std::uint32_t> queue;
+    const std::vector<std::uint32_t> keys{7, 3, 3, 1000000, 12, 0, 65536, 12};
+    for (std::size_t i = 0; i < keys.size(); ++i)
+        queue.push(static_cast<int>(i), keys[i]);
+    std::uint32_t last = 0;
+    while (!queue.empty()) {
+        auto top = queue.pop();
+        EXPECT_GE(top.first, last);
+        EXPECT_EQ(top.second < 0 ? 20u : keys[top.second], top.first);
+        last = top.first;
+        if (top.first == 12)
+            queue.push(-1, 20);  // monotone insert between pops
+    }
+}
+
+
+// Test that the integer-cost radix planner agrees with the float planner.
+TEST_F(GraphPlannerTest, TestIntegerCostsMatchFloat) {
+    GraphPlanner float_planner{graph};
+    RadixGraphPlanner radix_planner{graph};
+    const int source = graph.ClosestNode(0.05f, 0.1f);
+    const int target = graph.ClosestNode(0.95f, 0.85f);
+
+    GraphPath expected = float_planner.Search(source, target);
+    GraphPath actual = radix_planner.Search(source, target);
+    ASSERT_FALSE(actual.nodes.empty());
+    EXPECT_EQ(actual.nodes.front(), source);
+    EXPECT_EQ(actual.nodes.back(), target);
+    // Every edge is rounded up by less than one cost unit.
+    const float tolerance = actual.nodes.size() * graph.CostUnit() + 1e-4f * expected.distance;
+    EXPECT_NEAR(actual.distance, expected.distance, tolerance);
+}
@@ -0,0 +1,81 @@
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+#include "../src/route_model.h"
+#include "../src/route_graph.h"
+#include "../src/graph_planner.h"
+#include "../src/incremental_planner.h"
+
+// Defined in utest_rp_a_star_search.cpp.
+std::vector<std::byte> ReadOSMData(const std::string &path);
+
+//--------------------------------//
+//   Beginning IncrementalPlanner Tests.
+//--------------------------------//
+
+class IncrementalPlannerTest : public ::testing::Test {
+  protected:
+    // Closes the road between two adjacent nodes in both directions.
+    static void CloseRoad(IncrementalPlanner &planner, int u, int v) {
+        planner.SetEdgeCost(planner.FindEdge(u, v), IncrementalPlanner::kInfinity);
+        planner.SetEdgeCost(planner.FindEdge(v, u), IncrementalPlanner::kInfinity);
+    }
+
+    std::vector<std::byte> osm_data = ReadOSMData("../map.osm");
+    RouteModel model{osm_data};
+    RouteGraph graph = RouteGraph::Build(model);
+    int source = graph.ClosestNode(0.1f, 0.1f);
+    int target = graph.ClosestNode(0.9f, 0.9f);
+};
+
+
+// Test that the first plan is a shortest path.
+TEST_F(IncrementalPlannerTest, TestInitialPlanMatchesAStar) {
+    GraphPlanner a_star{graph};
+    IncrementalPlanner planner{graph};
+    planner.Start(source, target);
+
+    GraphPath expected = a_star.Search(source, target);
+    GraphPath path = planner.Plan();
+    ASSERT_FALSE(path.nodes.empty());
+    EXPECT_EQ(path.nodes.front(), source);
+    EXPECT_EQ(path.nodes.back(), target);
+    EXPECT_NEAR(path.distance, expected.distance, 1e-3f * expected.distance);
+}
+
+
+// Test that a road closure ahead of the vehicle is repaired with fewer expansions than a fresh search.
+TEST_F(IncrementalPlannerTest, TestRepairAfterClosure) {
+    IncrementalPlanner planner{graph};
+    planner.Start(source, target);
+    GraphPath before = planner.Plan();
+    ASSERT_GE(before.nodes.size(), 4u);
+
+    // The vehicle advances one node, then the next road on its route closes.
+    const int position = before.nodes[1];
+    planner.MoveStart(position);
+    CloseRoad(planner, before.nodes[2], before.nodes[3]);
+    GraphPath repaired = planner.Plan();
+    const auto repair_expansions = planner.Expansions();
+
+    IncrementalPlanner fresh{graph};
+    CloseRoad(fresh, before.nodes[2], before.nodes[3]);
+    fresh.Start(position, target);
+    GraphPath expected = fresh.Plan();
+
+    ASSERT_FALSE(expected.nodes.empty());
+    ASSERT_FALSE(repaired.nodes.empty());
+    EXPECT_EQ(repaired.nodes.front(), position);
+    EXPECT_EQ(repaired.nodes.back(), target);
+    EXPECT_NEAR(repaired.distance, expected.distance, 1e-3f * expected.distance);
+    for (std::size_t i = 1; i < repaired.nodes.size(); ++i)
+        EXPECT_FALSE(repaired.nodes[i - 1] == before.nodes[2] && repaired.nodes[i] == before.nodes[3]);
+    EXPECT_LT(repair_expansions, fresh.Expansions());
+
+    // Reopening the road restores the original route from the new position.
+    for (auto e : {planner.FindEdge(before.nodes[2], before.nodes[3]), planner.FindEdge(before.nodes[3], before.nodes[2])})
+        planner.SetEdgeCost(e, graph.Weight(e));
+    GraphPath reopened = planner.Plan();
+    const float first_leg = graph.Weight(planner.FindEdge(before.nodes[0], before.nodes[1])) * graph.MetricScale();
+    EXPECT_NEAR(reopened.distance, before.distance - first_leg, 1e-3f * before.distance);
+}
@@ -0,0 +1,127 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <png.h>
+#include "../src/png_writer.h"
+
+//--------------------------------//
+//   Beginning PngWriter Tests.
+//--------------------------------//
+
+class PngWriterTest : public ::testing::Test {
+  protected:
+    // A gradient with a transparent corner, compressible but not trivially.
+    static RgbaImage Gradient(int width, int height, int seed = 0) {
+        RgbaImage image{width, height, std::vector<std::uint8_t>(static_cast<std::size_t>(width) * height * 4)};
+        auto p = image.pixels.data();
+        for (int y = 0; y < height; ++y)
+            for (int x = 0; x < width; ++x, p += 4) {
+                p[0] = static_cast<std::uint8_t>(x + seed);
+                p[1] = static_cast<std::uint8_t>(y * 3);
+                p[2] = static_cast<std::uint8_t>((x ^ y) + seed);
+                p[3] = x < 8 && y < 8 ? 0 : 255;
+            }
+        return image;
+    }
+
+    // Decodes a PNG with libpng's simplified API; empty on failure.
+    static RgbaImage Decode(const std::vector<std::uint8_t> &png) {
+        png_image decoded{};
+        decoded.version = PNG_IMAGE_VERSION;
+        if (!png_image_begin_read_from_memory(&decoded, png.data(), png.size()))
+            return {};
+        decoded.format = PNG_FORMAT_RGBA;
+        RgbaImage image{static_cast<int>(decoded.width), static_cast<int>(decoded.height),
+                        std::vector<std::uint8_t>(PNG_IMAGE_SIZE(decoded))};
+        if (!png_image_finish_read(&decoded, nullptr, image.pixels.data(), 0, nullptr))
+            return {};
+        return image;
+    }
+};
+
+
+// Test that encoded images decode to the same pixels at every compression level.
+TEST_F(PngWriterTest, TestEncodeRoundTrip) {
+    const auto image = Gradient(67, 41);
+    std::size_t previous_size = 0;
+    for (int level : {0, 1, 6, 9}) {
+        const auto png = EncodePng(image, level);
+        ASSERT_GT(png.size(), 8u);
+        const auto decoded = Decode(png);
+        EXPECT_EQ(decoded.width, image.width);
+        EXPECT_EQ(decoded.height, image.height);
+        EXPECT_EQ(decoded.pixels, image.pixels) << "level " << level;
+        if (level == 0) {
+            EXPECT_GE(png.size(), image.pixels.size());
+        } else if (level == 9) {
+            EXPECT_LT(png.size(), previous_size);
+        }
+        previous_size = png.size();
+    }
+}
+
+// Test that malformed images are rejected instead of read out of bounds.
+TEST_F(PngWriterTest, TestRejectsMalformedImages) {
+    EXPECT_TRUE(EncodePng({}).empty());
+    auto image = Gradient(16, 16);
+    image.pixels.pop_back();
+    EXPECT_TRUE(EncodePng(image).empty());
+}
+
+// Test that every submitted image reaches its sink, and that failing sinks are counted.
+TEST_F(PngWriterTest, TestAsyncWriterDeliversAll) {
+    constexpr int kImages = 24;
+    std::mutex mutex;
+    std::vector<std::vector<std::uint8_t>> delivered(kImages);
+    {
+        AsyncPngWriter writer{3, 2, 1};
+        for (int i = 0; i < kImages; ++i)
+            ASSERT_TRUE(writer.Submit(Gradient(32, 32, i), [&, i](std::vector<std::uint8_t> &&png) {
+                std::lock_guard<std::mutex> lock{mutex};
+                delivered[i] = std::move(png);
+                return i % 8 != 7;
+            }));
+        writer.Close();
+        EXPECT_EQ(writer.Written(), kImages - kImages / 8u);
+        EXPECT_EQ(writer.Failed(), kImages / 8u);
+        EXPECT_FALSE(writer.Submit(Gradient(4, 4), [](std::vector<std::uint8_t> &&) { return true; }));
+    }
+    for (int i = 0; i < kImages; ++i)
+        EXPECT_EQ(Decode(delivered[i]).pixels, Gradient(32, 32, i).pixels) << i;
+}
+
+// Test that the queue never holds more than its capacity while workers are busy.
+TEST_F(PngWriterTest, TestAsyncWriterQueueIsBounded) {
+    std::atomic<int> submitted{0}, finished{0}, backlog{0};
+    AsyncPngWriter writer{1, 2, 0};
+    for (int i = 0; i < 12; ++i) {
+        writer.Submit(Gradient(64, 64), [&](std::vector<std::uint8_t> &&) {
+            ++finished;
+            return true;
+        });
+        ++submitted;
+        // At most one image in the worker, two queued and none beyond.
+        backlog = std::max(backlog.load(), submitted - finished);
+    }
+    writer.Close();
+    EXPECT_EQ(finished, 12);
+    EXPECT_LE(backlog, 1 + 2 + 1);
+}
+
+// Test that the file sink writes a decodable PNG.
+TEST_F(PngWriterTest, TestAsyncWriterWritesFiles) {
+    const std::string path = "utest_png_writer.png";
+    {
+        AsyncPngWriter writer;
+        ASSERT_TRUE(writer.Submit(path, Gradient(20, 10)));
+    }
+    std::ifstream is{path, std::ios::binary};
+    const std::vector<std::uint8_t> png{std::istreambuf_iterator<char>{is}, std::istreambuf_iterator<char>{}};
+    EXPECT_EQ(Decode(png).pixels, Gradient(20, 10).pixels);
+    std::remove(path.c_str());
+}
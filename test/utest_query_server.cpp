@@ -0,0 +1,251 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+#include "../src/route_model.h"
+#include "../src/route_graph.h"
+#include "../src/graph_planner.h"
+#include "../src/segment_index.h"
+#include "../src/query_server.h"
+
+// Defined in utest_rp_a_star_search.cpp.
+std::vector<std::byte> ReadOSMData(const std::string &path);
+
+//--------------------------------//
+//   Beginning QueryServer Tests.
+//--------------------------------//
+
+class QueryServerTest : public ::testing::Test {
+  protected:
+    std::vector<std::byte> osm_data = ReadOSMData("../map.osm");
+    RouteModel model{osm_data};
+    QueryServer server{model, 4};
+
+    // Extracts the number after "key": in a response.
+    static double Field(const std::string &response, const std::string &key) {
+        const auto pos = response.find("\"" + key + "\":");
+        EXPECT_NE(pos, std::string::npos) << key << " in " << response;
+        return pos == std::string::npos ? 0. : std::stod(response.substr(pos + key.size() + 3));
+    }
+
+    static std::string Route(int id, float x0, float y0, float x1, float y1, const char *op = "route") {
+        std::ostringstream os;
+        os << "{\"id\": " << id << ", \"op\": \"" << op << "\", \"from\": [" << x0 << ", " << y0
+           << "], \"to\": [" << x1 << ", " << y1 << "]}";
+        return os.str();
+    }
+};
+
+
+// Test that route and distance answers match a direct snapped search.
+TEST_F(QueryServerTest, TestRouteMatchesPlanner) {
+    RouteGraph graph = RouteGraph::Build(model);
+    SegmentIndex index{graph};
+    GraphPlanner planner{graph};
+    const auto from = index.Snap(0.1f, 0.1f), to = index.Snap(0.9f, 0.9f);
+    ASSERT_TRUE(from && to);
+    const GraphPath path = planner.Search(*from, *to);
+    ASSERT_TRUE(path.found);
+
+    const auto route = server.Handle(Route(7, 0.1f, 0.1f, 0.9f, 0.9f));
+    EXPECT_EQ(route.rfind("{\"id\":7,\"ok\":true,", 0), 0u) << route;
+    EXPECT_NEAR(Field(route, "distance"), path.distance, 1e-3 * path.distance);
+    // Snapped start, every graph node, snapped goal.
+    std::size_t points = 0;
+    for (auto pos = route.find("[", route.find("\"path\":") + 8); pos != std::string::npos; pos = route.find('[', pos + 1))
+        ++points;
+    EXPECT_EQ(points, path.nodes.size() + 2);
+
+    const auto distance = server.Handle(Route(8, 0.1f, 0.1f, 0.9f, 0.9f, "distance"));
+    EXPECT_EQ(distance.find("\"path\""), std::string::npos);
+    EXPECT_DOUBLE_EQ(Field(distance, "distance"), Field(route, "distance"));
+}
+
+// Test that snap answers match the segment index.
+TEST_F(QueryServerTest, TestSnap) {
+    RouteGraph graph = RouteGraph::Build(model);
+    SegmentIndex index{graph};
+    const auto snap = index.Snap(0.37f, 0.61f);
+    ASSERT_TRUE(snap);
+
+    const auto response = server.Handle(R"({"op":"snap","at":[0.37,0.61],"id":"abc"})");
+    EXPECT_EQ(response.rfind("{\"id\":\"abc\",\"ok\":true,", 0), 0u) << response;
+    EXPECT_NEAR(Field(response, "x"), snap->x, 1e-6);
+    EXPECT_NEAR(Field(response, "y"), snap->y, 1e-6);
+    EXPECT_NEAR(Field(response, "offset"), snap->distance * graph.MetricScale(), 1e-3);
+}
+
+// Test that bad requests are answered with an error carrying their id.
+TEST_F(QueryServerTest, TestErrors) {
+    EXPECT_EQ(server.Handle("not json"), R"({"id":null,"ok":false,"error":"malformed request"})");
+    EXPECT_EQ(server.Handle(R"({"id":1,"op":"route","from":[0.1,0.1]} trailing)"),
+              R"({"id":null,"ok":false,"error":"malformed request"})");
+    EXPECT_EQ(server.Handle(R"({"id":2,"op":"fly"})"), R"({"id":2,"ok":false,"error":"unknown op"})");
+    EXPECT_EQ(server.Handle(R"({"id":3})"), R"({"id":3,"ok":false,"error":"missing op"})");
+    EXPECT_EQ(server.Handle(R"({"id":"x\"y","op":"snap","at":[1]})").rfind(R"({"id":"x\"y","ok":false,)", 0), 0u);
+    EXPECT_EQ(server.Handle(R"({"id":[1],"op":"snap","at":[0.5,0.5]})").rfind(R"({"id":null,"ok":false,)", 0), 0u);
+    // Nesting deeper than the parser's limit is rejected, not recursed into.
+    EXPECT_EQ(server.Handle(std::string(100, '[') + std::string(100, ']')),
+              R"({"id":null,"ok":false,"error":"malformed request"})");
+}
+
+// Test that a stream of concurrent requests gets exactly one response per id.
+TEST_F(QueryServerTest, TestServeAnswersEveryRequest) {
+    constexpr int kRequests = 60;
+    std::stringstream in, out;
+    std::map<int, std::string> expected;
+    for (int i = 0; i < kRequests; ++i) {
+        const float a = (i % 10) / 10.f + 0.05f, b = (i / 10) / 6.f + 0.05f;
+        const auto request = Route(i, a, b, 1.f - b, 1.f - a, i % 3 ? "route" : "distance");
+        expected[i] = server.Handle(request);
+        in << request << (i % 2 ? "\r\n" : "\n");
+        if (i % 7 == 0)
+            in << "\n";
+    }
+
+    EXPECT_EQ(server.Serve(in, out), static_cast<std::size_t>(kRequests));
+    std::map<int, std::string> answered;
+    for (std::string line; std::getline(out, line);) {
+        const int id = static_cast<int>(Field(line, "id"));
+        EXPECT_TRUE(answered.emplace(id, line).second) << "duplicate response " << id;
+    }
+    EXPECT_EQ(answered, expected);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+class QueryServerSocketTest : public QueryServerTest {
+  protected:
+    std::string path = ::testing::TempDir() + "query_server_" + std::to_string(::getpid()) + ".sock";
+    std::thread serving;
+
+    void SetUp() override {
+        serving = std::thread([this] { EXPECT_TRUE(server.ServeSocket(path)); });
+    }
+
+    void TearDown() override {
+        server.StopSocket();
+        serving.join();
+        ::unlink(path.c_str());
+    }
+
+    // Connects to the server, retrying while it starts listening.
+    int Connect() const {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::copy(path.begin(), path.end(), address.sun_path);
+        for (int attempt = 0; attempt < 500; ++attempt) {
+            const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (::connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0)
+                return fd;
+            ::close(fd);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        ADD_FAILURE() << "can't connect to " << path;
+        return -1;
+    }
+
+    static bool Send(int fd, const std::string &data) {
+        for (std::size_t sent = 0; sent < data.size();) {
+            const auto n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0)
+                return false;
+            sent += static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    // Reads one response line, or returns an empty string after a timeout or on close.
+    static std::string ReadLine(int fd, std::chrono::milliseconds timeout) {
+        std::string line;
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (char c; line.empty() || line.back() != '\n';) {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            pollfd ready{fd, POLLIN, 0};
+            if (left.count() <= 0 || ::poll(&ready, 1, static_cast<int>(left.count())) <= 0 || ::recv(fd, &c, 1, 0) != 1)
+                return {};
+            line += c;
+        }
+        line.pop_back();
+        return line;
+    }
+};
+
+// Test that socket clients get one response per request.
+TEST_F(QueryServerSocketTest, TestSocketAnswersRequests) {
+    const int fd = Connect();
+    ASSERT_GE(fd, 0);
+    ASSERT_TRUE(Send(fd, R"({"id":"s","op":"snap","at":[0.37,0.61]})" "\n\n" + Route(5, 0.1f, 0.1f, 0.9f, 0.9f, "distance") + "\r\n"));
+    std::map<std::string, std::string> answered;
+    for (int i = 0; i < 2; ++i) {
+        const auto line = ReadLine(fd, std::chrono::seconds(5));
+        answered[line.substr(0, line.find(','))] = line;
+    }
+    ::close(fd);
+    EXPECT_EQ(answered["{\"id\":\"s\""], server.Handle(R"({"id":"s","op":"snap","at":[0.37,0.61]})"));
+    EXPECT_EQ(answered["{\"id\":5"], server.Handle(Route(5, 0.1f, 0.1f, 0.9f, 0.9f, "distance")));
+}
+
+// Test that a client that never reads its responses doesn't stall other clients,
+// and is disconnected once its unsent responses pile up.
+TEST_F(QueryServerSocketTest, TestStalledClientDoesNotBlockOthers) {
+    const int stalled = Connect();
+    ASSERT_GE(stalled, 0);
+    std::atomic<int> sent{0};
+    std::atomic<bool> dropped{false};
+    std::thread flood([&] {
+        const auto request = Route(1, 0.1f, 0.1f, 0.9f, 0.9f) + "\n";
+        for (int i = 0; i < 50000; ++i) {
+            if (!Send(stalled, request)) {
+                dropped = true;
+                return;
+            }
+            ++sent;
+        }
+    });
+    while (sent < 500 && !dropped)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    const int fd = Connect();
+    ASSERT_GE(fd, 0);
+    ASSERT_TRUE(Send(fd, R"({"id":2,"op":"snap","at":[0.5,0.5]})" "\n"));
+    EXPECT_EQ(ReadLine(fd, std::chrono::seconds(5)), server.Handle(R"({"id":2,"op":"snap","at":[0.5,0.5]})"));
+    ::close(fd);
+
+    flood.join();
+    EXPECT_TRUE(dropped);
+    ::close(stalled);
+}
+
+// Test that an over-long request line is answered with an error before the connection closes.
+TEST_F(QueryServerSocketTest, TestSocketRejectsLongRequest) {
+    const int fd = Connect();
+    ASSERT_GE(fd, 0);
+    Send(fd, std::string(100000, ' '));
+    EXPECT_EQ(ReadLine(fd, std::chrono::seconds(5)), R"({"id":null,"ok":false,"error":"request too long"})");
+    EXPECT_EQ(ReadLine(fd, std::chrono::seconds(5)), "");
+    ::close(fd);
+}
+
+// Test that serving on the path of a file that isn't a socket fails and keeps the file.
+TEST_F(QueryServerTest, TestServeSocketKeepsOtherFiles) {
+    const auto path = ::testing::TempDir() + "query_server_" + std::to_string(::getpid()) + ".txt";
+    std::ofstream{path} << "data";
+    EXPECT_FALSE(server.ServeSocket(path));
+    std::ifstream in{path};
+    std::string content;
+    in >> content;
+    EXPECT_EQ(content, "data");
+    ::unlink(path.c_str());
+}
+#endif
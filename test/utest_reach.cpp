@@ -0,0 +1,83 @@
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "../src/route_model.h"
+#include "../src/route_graph.h"
+#include "../src/graph_planner.h"
+#include "../src/reach.h"
+#include "../src/segment_index.h"
+
+// Defined in utest_rp_a_star_search.cpp.
+std::vector<std::byte> ReadOSMData(const std::string &path);
+
+//--------------------------------//
+//   Beginning Reach Tests.
+//--------------------------------//
+
+class ReachTest : public ::testing::Test {
+  protected:
+    std::vector<std::byte> osm_data = ReadOSMData("../map.osm");
+    RouteModel model{osm_data};
+    RouteGraph graph = RouteGraph::Build(model);
+    ReachBounds bounds = ReachBounds::Compute(graph);
+};
+
+
+// Test that pruned queries keep shortest distances and expand no more nodes than A*.
+TEST_F(ReachTest, TestPrunedSearchMatchesAStar) {
+    GraphPlanner a_star{graph};
+    ReachGraphPlanner pruned{graph, ReachPruning{&bounds}};
+    const std::vector<std::pair<float, float>> corners{{0.05f, 0.1f}, {0.9f, 0.9f}, {0.1f, 0.95f}, {0.95f, 0.05f}, {0.5f, 0.5f}};
+
+    std::size_t a_star_expansions = 0, pruned_expansions = 0;
+    for (const auto &from : corners)
+        for (const auto &to : corners) {
+            const int source = graph.ClosestNode(from.first, from.second);
+            const int target = graph.ClosestNode(to.first, to.second);
+            GraphPath expected = a_star.Search(source, target);
+            GraphPath actual = pruned.Search(source, target);
+            ASSERT_EQ(actual.nodes.empty(), expected.nodes.empty());
+            EXPECT_NEAR(actual.distance, expected.distance, 1e-3f * expected.distance + 1e-3f);
+            a_star_expansions += a_star.Expansions();
+            pruned_expansions += pruned.Expansions();
+        }
+    EXPECT_LT(pruned_expansions, a_star_expansions);
+}
+
+
+// Test that pruning keeps shortest distances when both ends are snapped onto road segments.
+TEST_F(ReachTest, TestSnappedPrunedSearchMatchesNoPruning) {
+    SegmentIndex index{graph};
+    GraphPlanner unpruned{graph};
+    ReachGraphPlanner pruned{graph, ReachPruning{&bounds}};
+    std::mt19937 rng{11};
+    std::uniform_real_distribution<float> coordinate{0.f, 1.f};
+    for (int i = 0; i < 400; ++i) {
+        const auto from = index.Snap(coordinate(rng), coordinate(rng));
+        const auto to = index.Snap(coordinate(rng), coordinate(rng));
+        ASSERT_TRUE(from && to);
+        GraphPath expected = unpruned.Search(*from, *to);
+        GraphPath actual = pruned.Search(*from, *to);
+        ASSERT_EQ(actual.found, expected.found) << "query " << i;
+        EXPECT_NEAR(actual.distance, expected.distance, 1e-3f * expected.distance + 1e-3f) << "query " << i;
+    }
+}
+
+
+// Test that bounds survive a round trip through an artifact file.
+TEST_F(ReachTest, TestSaveLoad) {
+    const std::string path = "utest_reach.bin";
+    ArtifactWriter writer;
+    bounds.Save(writer);
+    ASSERT_TRUE(writer.Write(path, 1));
+    auto file = ArtifactFile::Open(path, 1);
+    ASSERT_TRUE(file);
+    auto loaded = ReachBounds::Load(*file, graph);
+    ASSERT_TRUE(loaded);
+    ASSERT_EQ(loaded->Size(), graph.NumNodes());
+    for (int v = 0; v < graph.NumNodes(); ++v)
+        EXPECT_EQ(loaded->Reach(v), bounds.Reach(v));
+    std::remove(path.c_str());
+}
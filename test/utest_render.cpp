@@ -0,0 +1,158 @@
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <io2d.h>
+#include "../src/feature_index.h"
+#include "../src/map_style.h"
+#include "../src/render.h"
+#include "../src/route_model.h"
+
+namespace {
+
+std::vector<std::byte> ReadOSMData(const std::string &path) {
+    std::ifstream is{path, std::ios::binary | std::ios::ate};
+    if (!is)
+        return {};
+    auto size = is.tellg();
+    std::vector<std::byte> contents(size);
+    is.seekg(0);
+    is.read((char *)contents.data(), size);
+    return contents;
+}
+
+std::vector<std::byte> ToBytes(const std::string &text) {
+    std::vector<std::byte> bytes(text.size());
+    std::memcpy(bytes.data(), text.data(), text.size());
+    return bytes;
+}
+
+// Records the drawing calls Render makes instead of rasterizing them.
+struct CountingSurface {
+    int paints = 0;
+    std::vector<const io2d::brush *> fills;    // Brush of every fill
+    std::vector<const io2d::brush *> strokes;  // Brush of every stroke
+
+    template <typename... Args>
+    void paint(const io2d::brush &, const Args &...) { ++paints; }
+
+    template <typename Path, typename... Args>
+    void fill(const io2d::brush &brush, const Path &, const Args &...) { fills.push_back(&brush); }
+
+    template <typename Path, typename... Args>
+    void stroke(const io2d::brush &brush, const Path &, const Args &...) { strokes.push_back(&brush); }
+};
+
+// Four nodes of a square centered on the middle of a 0.01 by 0.01 degree map.
+void AppendSquare(std::ostringstream &os, int first_id, double half_size, bool counterclockwise) {
+    const double corners[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+    for (int i = 0; i < 4; ++i) {
+        const auto &c = corners[counterclockwise ? i : 3 - i];
+        os << "<node id=\"" << first_id + i << "\" lat=\"" << 0.005 + c[1] * half_size << "\" lon=\""
+           << 0.005 + c[0] * half_size << "\"/>\n";
+    }
+}
+
+}  // namespace
+
+//--------------------------------//
+//   Beginning Render Tests.
+//--------------------------------//
+
+// Test that a frame draws one fill or stroke per style, not per feature.
+TEST(RenderTest, TestBatchesOneDrawPerStyle) {
+    auto osm_data = ReadOSMData("../map.osm");
+    ASSERT_FALSE(osm_data.empty());
+    RouteModel model{osm_data};
+    Render render{model};
+    const auto viewport = Viewport::Fit(400, 400);
+    CountingSurface surface;
+    render.DisplayUncached(surface, viewport);
+
+    // Expected calls, from the same culling Render uses.
+    FeatureIndex index{model};
+    std::vector<int> visible;
+    std::size_t features = 0;
+    auto query = [&](FeatureLayer layer) -> const std::vector<int> & {
+        index.QueryVisible(layer, viewport.Bounds(), viewport.Scale(), model.MetricScale(), WidestMetricWidth(), 1.f, visible);
+        features += visible.size();
+        return visible;
+    };
+    std::size_t fills = 0, strokes = 0;
+    std::optional<Model::Landuse::Type> landuse;
+    for (auto i : query(FeatureLayer::Landuse)) {
+        const auto type = model.Landuses()[i].type;
+        if (LanduseColor(type) && type != landuse) {
+            ++fills;
+            landuse = type;
+        }
+    }
+    const bool leisures = !query(FeatureLayer::Leisure).empty();
+    const bool waters = !query(FeatureLayer::Water).empty();
+    const bool railways = !query(FeatureLayer::Railway).empty();
+    std::set<Model::Road::Type> road_types;
+    for (auto i : query(FeatureLayer::Road))
+        road_types.insert(model.Roads()[i].type);
+    const bool buildings = !query(FeatureLayer::Building).empty();
+    ASSERT_TRUE(leisures && waters && railways && buildings);
+
+    fills += leisures + waters + buildings;
+    // Leisure outlines, railway casing and dashes, one per road type, building outlines,
+    // and the route, which is stroked even when there is none.
+    strokes += leisures + 2 * railways + road_types.size() + buildings + 1;
+    EXPECT_EQ(surface.paints, 1);
+    EXPECT_EQ(surface.fills.size(), fills);
+    EXPECT_EQ(surface.strokes.size(), strokes);
+    // Every style, including every road type, is stroked once.
+    EXPECT_EQ(std::set<const io2d::brush *>(surface.strokes.begin(), surface.strokes.end()).size(), strokes);
+    EXPECT_LT(surface.fills.size() + surface.strokes.size(), features / 10);
+}
+
+// Test that merged multipolygons keep their holes whatever the orientation of their rings.
+TEST(RenderTest, TestMergedPolygonsKeepHoles) {
+    for (bool outer_ccw : {true, false})
+        for (bool inner_ccw : {true, false}) {
+            std::ostringstream os;
+            os << "<osm>\n<bounds minlat=\"0\" minlon=\"0\" maxlat=\"0.01\" maxlon=\"0.01\"/>\n";
+            AppendSquare(os, 1, 0.003, outer_ccw);
+            AppendSquare(os, 5, 0.001, inner_ccw);
+            os << "<way id=\"10\"><nd ref=\"1\"/><nd ref=\"2\"/><nd ref=\"3\"/><nd ref=\"4\"/><nd ref=\"1\"/></way>\n"
+                  "<way id=\"11\"><nd ref=\"5\"/><nd ref=\"6\"/><nd ref=\"7\"/><nd ref=\"8\"/><nd ref=\"5\"/></way>\n"
+                  "<relation id=\"20\"><member type=\"way\" ref=\"10\" role=\"outer\"/>"
+                  "<member type=\"way\" ref=\"11\" role=\"inner\"/>"
+                  "<tag k=\"type\" v=\"multipolygon\"/><tag k=\"building\" v=\"yes\"/></relation>\n"
+                  "</osm>\n";
+            RouteModel model{ToBytes(os.str())};
+            ASSERT_EQ(model.Buildings().size(), 1u);
+            Render render{model};
+            const auto viewport = Viewport::Fit(200, 200);
+            io2d::image_surface surface{io2d::format::argb32, viewport.width, viewport.height};
+            render.DisplayUncached(surface, viewport);
+            const auto image = Render::ReadPixels(surface);
+
+            auto expect_color = [&](double x, double y, const MapColor &color, const char *where) {
+                const auto [px, py] = viewport.ToPixel(x, y);
+                const auto pixel = image.pixels.data() + (static_cast<std::size_t>(py) * image.width + static_cast<std::size_t>(px)) * 4;
+                EXPECT_LE(std::abs(pixel[0] - color.r) + std::abs(pixel[1] - color.g) + std::abs(pixel[2] - color.b), 6)
+                    << where << ", outer " << (outer_ccw ? "ccw" : "cw") << ", inner " << (inner_ccw ? "ccw" : "cw");
+            };
+            const auto &nodes = model.Nodes();
+            double outer_x = nodes[0].x, inner_x = nodes[4].x, center_x = 0., center_y = 0.;
+            for (int i = 4; i < 8; ++i) {
+                center_x += nodes[i].x / 4.;
+                center_y += nodes[i].y / 4.;
+                inner_x = std::min(inner_x, nodes[i].x);
+            }
+            for (int i = 0; i < 4; ++i)
+                outer_x = std::min(outer_x, nodes[i].x);
+            expect_color(center_x, center_y, kBackgroundColor, "hole");
+            expect_color((outer_x + inner_x) / 2., center_y, kBuildingFillColor, "ring");
+        }
+}
@@ -0,0 +1,71 @@
+#include "gtest/gtest.h"
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../src/model.h"
+#include "../src/reach.h"
+#include "../src/route_graph.h"
+#include "../src/route_verifier.h"
+#include "../src/segment_index.h"
+#include "../src/synthetic_map.h"
+
+// Defined in utest_rp_a_star_search.cpp.
+std::vector<std::byte> ReadOSMData(const std::string &path);
+
+//--------------------------------//
+//   Beginning RouteVerifier Tests.
+//--------------------------------//
+
+// Runs every mode on a graph and reports the table on failure.
+static void ExpectAllModesAgree(const RouteGraph &graph, std::size_t queries)
+{
+    const auto reach = ReachBounds::Compute(graph);
+    const SegmentIndex index{graph};
+    DifferentialOptions options;
+    options.queries = queries;
+    options.reach = &reach;
+    options.index = &index;
+    const auto report = RunDifferential(graph, options);
+
+    std::ostringstream table;
+    report.Print(table);
+    ASSERT_EQ(report.modes.size(), 6u) << table.str();
+    for (const auto &mode : report.modes) {
+        EXPECT_GT(mode.queries, 0u) << mode.name;
+        EXPECT_EQ(mode.mismatches, 0u) << table.str();
+    }
+    EXPECT_TRUE(report.Ok());
+}
+
+// Test that the reference agrees with itself on trivial queries.
+TEST(ReferenceDijkstraTest, TestTrivialQueries) {
+    Model model{ReadOSMData("../map.osm")};
+    auto graph = RouteGraph::Build(model);
+    ReferenceDijkstra reference{graph};
+    EXPECT_EQ(reference.Distance(0, 0), 0.);
+    EXPECT_TRUE(std::isinf(reference.Distance(-1, 0)));
+
+    // Neighbors are one edge apart, and distances are symmetric on the bidirectional graph.
+    const int u = graph.ClosestNode(0.5f, 0.5f);
+    const auto e = graph.FirstOut(u);
+    EXPECT_NEAR(reference.Distance(u, graph.Head(e)), graph.Weight(e) * graph.MetricScale(), 1e-6);
+    const int v = graph.ClosestNode(0.1f, 0.9f);
+    EXPECT_DOUBLE_EQ(reference.Distance(u, v), reference.Distance(v, u));
+}
+
+// Test that every accelerated mode matches the reference on map.osm.
+TEST(RouteVerifierTest, TestModesMatchOnMap) {
+    Model model{ReadOSMData("../map.osm")};
+    ExpectAllModesAgree(RouteGraph::Build(model), 300);
+}
+
+// Test that every accelerated mode matches the reference on a perturbed synthetic grid.
+TEST(RouteVerifierTest, TestModesMatchOnSyntheticMap) {
+    SyntheticMapOptions options;
+    options.seed = 3;
+    options.grid = 16;
+    options.perturbation = 0.2;
+    Model model{GenerateSyntheticOsm(options)};
+    ExpectAllModesAgree(RouteGraph::Build(model), 200);
+}
@@ -133,3 +133,21 @@ TEST_F(RoutePlannerTest, TestAStarSearch) {
     EXPECT_FLOAT_EQ(end_node->y, path_end.y);
     EXPECT_FLOAT_EQ(route_planner.GetDistance(), 873.41565);
 }
+
+
+// Test that other policy combinations plan between the same endpoints.
+TEST_F(RoutePlannerTest, TestPolicyInstantiations) {
+    BasicRoutePlanner<HaversineDistance, BinaryHeapQueue, HaversineDistance> haversine_planner{model, 10, 10, 90, 90};
+    haversine_planner.AStarSearch();
+    ASSERT_FALSE(model.path.empty());
+    EXPECT_FLOAT_EQ(start_node->x, model.path.front().x);
+    EXPECT_FLOAT_EQ(end_node->y, model.path.back().y);
+    EXPECT_GT(haversine_planner.GetDistance(), 0.f);
+
+    // A zero expansion budget must stop before reaching the goal.
+    RouteModel fresh_model{osm_data};
+    BasicRoutePlanner<EuclideanDistance, SortedVectorQueue, EuclideanDistance, StopAtGoalOrBudget<0>> budget_planner{fresh_model, 10, 10, 90, 90};
+    budget_planner.AStarSearch();
+    EXPECT_TRUE(fresh_model.path.empty());
+    EXPECT_FLOAT_EQ(budget_planner.GetDistance(), 0.f);
+}
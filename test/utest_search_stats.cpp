@@ -0,0 +1,111 @@
+#include "gtest/gtest.h"
+#include <set>
+#include <string>
+#include <vector>
+#include "../src/route_model.h"
+#include "../src/route_planner.h"
+#include "../src/route_graph.h"
+#include "../src/graph_planner.h"
+#include "../src/search_stats.h"
+#include "../src/search_trace.h"
+
+// Defined in utest_rp_a_star_search.cpp.
+std::vector<std::byte> ReadOSMData(const std::string &path);
+
+//--------------------------------//
+//   Beginning SearchStats Tests.
+//--------------------------------//
+
+class SearchStatsTest : public ::testing::Test {
+  protected:
+    std::vector<std::byte> osm_data = ReadOSMData("../map.osm");
+    RouteModel model{osm_data};
+};
+
+
+// Test that the counters are consistent when enabled and zero when compiled out.
+TEST_F(SearchStatsTest, TestPlannerCounters) {
+    RoutePlanner route_planner{model, 10, 10, 90, 90};
+    route_planner.AStarSearch();
+    RouteGraph graph = RouteGraph::Build(model);
+    GraphPlanner graph_planner{graph};
+    graph_planner.Search(0.1f, 0.1f, 0.9f, 0.9f);
+
+    for (const SearchStats &stats : {route_planner.Stats(), graph_planner.Stats()}) {
+        if (kSearchStatsEnabled) {
+            EXPECT_GT(stats.expansions, 0u);
+            EXPECT_GE(stats.pops, stats.expansions);
+            EXPECT_GE(stats.pushes, stats.pops);
+            EXPECT_LE(stats.peak_open, stats.pushes);
+            EXPECT_GE(stats.neighbor_scans, stats.pushes);
+            EXPECT_GT(stats.search_seconds, 0.);
+        } else {
+            EXPECT_EQ(stats.expansions, 0u);
+            EXPECT_EQ(stats.pushes, 0u);
+            EXPECT_EQ(stats.search_seconds, 0.);
+        }
+    }
+    if (kSearchStatsEnabled) {
+        EXPECT_EQ(graph_planner.Stats().expansions, graph_planner.Expansions());
+    }
+}
+
+
+// Test that a trace lists every expansion once, from the start node to the goal.
+TEST_F(SearchStatsTest, TestRoutePlannerTrace) {
+    RoutePlanner route_planner{model, 10, 10, 90, 90};
+    SearchTrace trace;
+    trace.Record(-1, 0.f, 0.f);  // left over from an earlier query
+    route_planner.SetTrace(&trace);
+    route_planner.AStarSearch();
+    ASSERT_GE(model.path.size(), 2u);
+    ASSERT_GE(trace.Size(), model.path.size());
+
+    const auto &nodes = model.SNodes();
+    std::set<int> seen;
+    for (const auto &e : trace.expansions) {
+        ASSERT_GE(e.node, 0);
+        ASSERT_LT(e.node, static_cast<int>(nodes.size()));
+        EXPECT_TRUE(seen.insert(e.node).second);
+        EXPECT_FLOAT_EQ(e.x, static_cast<float>(nodes[e.node].x));
+        EXPECT_FLOAT_EQ(e.y, static_cast<float>(nodes[e.node].y));
+    }
+    EXPECT_FLOAT_EQ(trace.expansions.front().x, static_cast<float>(model.path.front().x));
+    EXPECT_FLOAT_EQ(trace.expansions.back().x, static_cast<float>(model.path.back().x));
+    EXPECT_FLOAT_EQ(trace.expansions.back().y, static_cast<float>(model.path.back().y));
+}
+
+// Test that the graph planner records one entry per expansion and restarts the trace per query.
+TEST_F(SearchStatsTest, TestGraphPlannerTrace) {
+    RouteGraph graph = RouteGraph::Build(model);
+    GraphPlanner graph_planner{graph};
+    SearchTrace trace;
+    graph_planner.SetTrace(&trace);
+    for (int query = 0; query < 2; ++query) {
+        const auto path = graph_planner.Search(0.1f, 0.1f, 0.9f - query * 0.3f, 0.9f);
+        ASSERT_TRUE(path.found);
+        EXPECT_EQ(trace.Size(), graph_planner.Expansions());
+        EXPECT_EQ(trace.expansions.front().node, path.nodes.front());
+        EXPECT_EQ(trace.expansions.back().node, path.nodes.back());
+    }
+
+    graph_planner.SetTrace(nullptr);
+    graph_planner.Search(0.1f, 0.1f, 0.9f, 0.9f);
+    EXPECT_NE(trace.Size(), graph_planner.Expansions());
+}
+
+// Test that histogram quantiles land in the right power-of-two bucket.
+TEST(LogHistogramTest, TestQuantiles) {
+    LogHistogram histogram;
+    for (int i = 0; i < 90; ++i)
+        histogram.Add(5.);      // bucket [4, 8)
+    for (int i = 0; i < 10; ++i)
+        histogram.Add(1000.);   // bucket [512, 1024)
+    histogram.Add(0.25);        // bucket [0, 1)
+
+    EXPECT_EQ(histogram.Count(), 101u);
+    EXPECT_EQ(histogram.Bucket(0), 1u);
+    EXPECT_EQ(histogram.Bucket(3), 90u);
+    EXPECT_EQ(histogram.Quantile(0.5), 8.);
+    EXPECT_EQ(histogram.Quantile(0.99), 1024.);
+}
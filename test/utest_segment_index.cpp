@@ -0,0 +1,94 @@
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include "../src/route_model.h"
+#include "../src/route_graph.h"
+#include "../src/graph_planner.h"
+#include "../src/segment_index.h"
+
+// Defined in utest_rp_a_star_search.cpp.
+std::vector<std::byte> ReadOSMData(const std::string &path);
+
+//--------------------------------//
+//   Beginning SegmentIndex Tests.
+//--------------------------------//
+
+class SegmentIndexTest : public ::testing::Test {
+  protected:
+    // Distance from a position to the nearest segment, by brute force.
+    float NearestSegment(float x, float y) const {
+        float best = std::numeric_limits<float>::max();
+        for (int u = 0; u < graph.NumNodes(); ++u)
+            for (auto e = graph.FirstOut(u); e < graph.FirstOut(u + 1); ++e) {
+                const int v = graph.Head(e);
+                const float dx = graph.X(v) - graph.X(u), dy = graph.Y(v) - graph.Y(u);
+                const float t = std::clamp(((x - graph.X(u)) * dx + (y - graph.Y(u)) * dy) / (dx * dx + dy * dy), 0.f, 1.f);
+                best = std::min(best, std::hypot(graph.X(u) + t * dx - x, graph.Y(u) + t * dy - y));
+            }
+        return best;
+    }
+
+    std::vector<std::byte> osm_data = ReadOSMData("../map.osm");
+    RouteModel model{osm_data};
+    RouteGraph graph = RouteGraph::Build(model);
+    SegmentIndex index{graph};
+};
+
+
+// Test that the index finds the nearest segment.
+TEST_F(SegmentIndexTest, TestSnapMatchesBruteForce) {
+    std::mt19937 rng{42};
+    std::uniform_real_distribution<float> coordinate{-0.1f, 1.1f};
+    for (int i = 0; i < 200; ++i) {
+        const float x = coordinate(rng), y = coordinate(rng);
+        auto snap = index.Snap(x, y);
+        ASSERT_TRUE(snap);
+        EXPECT_NEAR(snap->distance, NearestSegment(x, y), 1e-6f);
+        EXPECT_EQ(graph.Head(snap->edge), snap->v);
+    }
+
+    // A point in the middle of a segment snaps onto it.
+    const int u = graph.ClosestNode(0.5f, 0.5f);
+    const int v = graph.Head(graph.FirstOut(u));
+    auto snap = index.Snap((graph.X(u) + graph.X(v)) / 2, (graph.Y(u) + graph.Y(v)) / 2);
+    ASSERT_TRUE(snap);
+    EXPECT_NEAR(snap->distance, 0.f, 1e-6f);
+    EXPECT_NEAR(snap->t, 0.5f, 1e-3f);
+}
+
+
+// Test that a snapped search costs the best combination of partial edges and node-to-node paths.
+TEST_F(SegmentIndexTest, TestSnappedSearch) {
+    GraphPlanner planner{graph};
+    auto from = index.Snap(0.12f, 0.13f);
+    auto to = index.Snap(0.87f, 0.91f);
+    ASSERT_TRUE(from && to);
+
+    GraphPath path = planner.Search(*from, *to);
+    ASSERT_TRUE(path.found);
+    ASSERT_FALSE(path.nodes.empty());
+    EXPECT_TRUE(path.nodes.front() == from->u || path.nodes.front() == from->v);
+    EXPECT_TRUE(path.nodes.back() == to->u || path.nodes.back() == to->v);
+
+    const double scale = graph.MetricScale();
+    float expected = std::numeric_limits<float>::max();
+    for (int a : {from->u, from->v})
+        for (int b : {to->u, to->v}) {
+            const float head = graph.Weight(from->edge) * (a == from->u ? from->t : 1.f - from->t) * scale;
+            const float tail = graph.Weight(to->edge) * (b == to->u ? to->t : 1.f - to->t) * scale;
+            expected = std::min(expected, head + planner.Search(a, b).distance + tail);
+        }
+    EXPECT_NEAR(path.distance, expected, 1e-3f * expected);
+
+    // Two points on the same segment are joined directly.
+    EdgeSnap near = *from, far = *from;
+    near.t = 0.25f;
+    far.t = 0.75f;
+    GraphPath direct = planner.Search(near, far);
+    ASSERT_TRUE(direct.found);
+    EXPECT_NEAR(direct.distance, graph.Weight(from->edge) * 0.5f * scale, 1e-3f);
+}
@@ -0,0 +1,100 @@
+#include "gtest/gtest.h"
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../src/route_model.h"
+#include "../src/route_planner.h"
+#include "../src/svg_writer.h"
+#include "../src/viewport.h"
+
+// Defined in utest_rp_a_star_search.cpp.
+std::vector<std::byte> ReadOSMData(const std::string &path);
+
+//--------------------------------//
+//   Beginning SvgWriter Tests.
+//--------------------------------//
+
+class SvgWriterTest : public ::testing::Test {
+  protected:
+    std::string Write(const SvgOptions &options, const Viewport &viewport) const {
+        std::ostringstream os;
+        EXPECT_TRUE(SvgWriter(model, options).Write(os, viewport));
+        return os.str();
+    }
+
+    // Returns the path data of all <path> elements.
+    static std::vector<std::string> PathData(const std::string &svg) {
+        std::vector<std::string> data;
+        for (auto pos = svg.find(" d=\""); pos != std::string::npos; pos = svg.find(" d=\"", pos)) {
+            pos += 4;
+            data.push_back(svg.substr(pos, svg.find('"', pos) - pos));
+        }
+        return data;
+    }
+
+    std::vector<std::byte> osm_data = ReadOSMData("../map.osm");
+    RouteModel model{osm_data};
+    Viewport full = Viewport::Fit(400, 400);
+};
+
+
+// Test that the document holds every layer group in Render's order.
+TEST_F(SvgWriterTest, TestLayersInDrawingOrder) {
+    const auto svg = Write({}, full);
+    EXPECT_EQ(svg.rfind("<svg ", 0), 0u);
+    EXPECT_EQ(svg.substr(svg.size() - 7), "</svg>\n");
+    std::size_t pos = 0;
+    for (auto layer : {"landuse", "leisure", "water", "railways", "roads", "buildings", "route"}) {
+        const auto next = svg.find("<g id=\"" + std::string{layer} + "\">", pos);
+        ASSERT_NE(next, std::string::npos) << layer;
+        pos = next;
+    }
+    EXPECT_FALSE(PathData(svg).empty());
+
+    const auto flat = Write({1, false}, full);
+    EXPECT_EQ(flat.find("<g"), std::string::npos);
+    EXPECT_EQ(PathData(flat), PathData(svg));
+}
+
+// Test that coordinates are quantized and fewer decimals give a smaller document.
+TEST_F(SvgWriterTest, TestQuantization) {
+    const auto coarse = Write({0, true}, full);
+    for (const auto &d : PathData(coarse))
+        EXPECT_EQ(d.find('.'), std::string::npos);
+    const auto fine = Write({2, true}, full);
+    EXPECT_LT(coarse.size(), fine.size());
+}
+
+// Test that the route starts at its first node and relative coordinates add up to its last one.
+TEST_F(SvgWriterTest, TestRouteCoordinates) {
+    RoutePlanner route_planner{model, 10, 10, 90, 90};
+    route_planner.AStarSearch();
+    ASSERT_GE(model.path.size(), 2u);
+
+    const auto svg = Write({1, true}, full);
+    const auto route = svg.substr(svg.find("<g id=\"route\">"));
+    const auto data = PathData(route);
+    ASSERT_EQ(data.size(), 3u);  // route, start and end markers
+
+    std::istringstream is{data[0].substr(1)};
+    double x = 0., y = 0., dx, dy;
+    is >> x >> y;
+    const auto [first_x, first_y] = full.ToPixel(model.path.front().x, model.path.front().y);
+    EXPECT_NEAR(x, first_x, 0.05);
+    EXPECT_NEAR(y, first_y, 0.05);
+    while (is >> dx >> dy) {
+        x += dx;
+        y += dy;
+    }
+    const auto [last_x, last_y] = full.ToPixel(model.path.back().x, model.path.back().y);
+    EXPECT_NEAR(x, last_x, 0.05);
+    EXPECT_NEAR(y, last_y, 0.05);
+}
+
+// Test that zooming in culls features outside the viewport.
+TEST_F(SvgWriterTest, TestViewportCulling) {
+    auto zoomed = full;
+    zoomed.zoom = 16.;
+    EXPECT_LT(Write({}, zoomed).size(), Write({}, full).size() / 4);
+}
@@ -0,0 +1,116 @@
+#include "gtest/gtest.h"
+#include <cmath>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../src/model.h"
+#include "../src/route_graph.h"
+#include "../src/graph_planner.h"
+#include "../src/synthetic_map.h"
+
+//--------------------------------//
+//   Beginning SyntheticMap Tests.
+//--------------------------------//
+
+class SyntheticMapTest : public ::testing::Test {
+  protected:
+    SyntheticMapOptions Options() const {
+        SyntheticMapOptions options;
+        options.seed = 7;
+        options.grid = 12;
+        options.perturbation = 0.2;
+        return options;
+    }
+};
+
+
+// Test that Model parses every generated feature.
+TEST_F(SyntheticMapTest, TestModelLoadsMap) {
+    std::ostringstream os;
+    const auto stats = WriteSyntheticOsm(os, Options());
+    EXPECT_GT(stats.relations, 0u);
+
+    Model model{GenerateSyntheticOsm(Options())};
+    EXPECT_EQ(model.Nodes().size(), stats.nodes);
+    EXPECT_EQ(model.Ways().size(), stats.ways);
+    EXPECT_EQ(model.Roads().size(), 2u * Options().grid);
+    EXPECT_FALSE(model.Landuses().empty() && model.Leisures().empty());
+
+    // Courtyard relations become buildings with an inner ring.
+    std::size_t courtyards = 0;
+    for (auto &building: model.Buildings())
+        courtyards += !building.inner.empty();
+    EXPECT_EQ(courtyards, stats.relations);
+
+    // All generated nodes fall inside the declared bounds.
+    for (auto &node: model.Nodes()) {
+        EXPECT_GE(node.x, 0.);
+        EXPECT_LE(node.x, 1.);
+        EXPECT_GE(node.y, 0.);
+        EXPECT_LE(node.y, 1.);
+    }
+}
+
+// Test that the street grid is connected from corner to corner.
+TEST_F(SyntheticMapTest, TestStreetGridIsConnected) {
+    Model model{GenerateSyntheticOsm(Options())};
+    auto graph = RouteGraph::Build(model);
+    GraphPlanner planner{graph};
+    const int s = graph.ClosestNode(0.f, 0.f), t = graph.ClosestNode(1.f, 1.f);
+    auto path = planner.Search(s, t);
+    ASSERT_TRUE(path.found);
+
+    // On a grid the shortest route is about the Manhattan distance; jitter bends it a little.
+    const double manhattan = (std::abs(graph.X(t) - graph.X(s)) + std::abs(graph.Y(t) - graph.Y(s))) * model.MetricScale();
+    EXPECT_GT(path.distance, manhattan * 0.95);
+    EXPECT_LT(path.distance, manhattan * 1.2);
+}
+
+// Test that the output depends only on the options.
+TEST_F(SyntheticMapTest, TestDeterministic) {
+    auto options = Options();
+    EXPECT_EQ(GenerateSyntheticOsm(options), GenerateSyntheticOsm(options));
+    options.seed = 8;
+    EXPECT_NE(GenerateSyntheticOsm(options), GenerateSyntheticOsm(Options()));
+
+    // Sizing by node count lands near the target.
+    const std::size_t target = 20000;
+    options.grid = SyntheticGridForNodes(options, target);
+    std::ostringstream os;
+    const auto stats = WriteSyntheticOsm(os, options);
+    EXPECT_GT(stats.nodes, target * 8 / 10);
+    EXPECT_LT(stats.nodes, target * 12 / 10);
+}
+
+// Test that elements come in OSM order (nodes, ways, relations) and relations refer to earlier ways.
+TEST_F(SyntheticMapTest, TestElementOrder) {
+    // Enough courtyards for more than 1 MB of relations.
+    auto options = Options();
+    options.grid = 150;
+    options.relation_density = 0.5;
+    std::stringstream os;
+    const auto stats = WriteSyntheticOsm(os, options);
+    ASSERT_GT(stats.relations, 8000u);
+
+    int section = 0;  // 0 nodes, 1 ways, 2 relations
+    std::set<std::string> ways;
+    std::size_t relations = 0;
+    for (std::string line; std::getline(os, line);) {
+        const auto element = line.find_first_not_of(' ');
+        if (line.compare(element, 6, "<node ") == 0) {
+            EXPECT_EQ(section, 0) << line;
+        } else if (line.compare(element, 5, "<way ") == 0) {
+            EXPECT_LE(section, 1) << line;
+            section = 1;
+            ways.insert(line.substr(line.find('"') + 1, line.find('"', line.find('"') + 1) - line.find('"') - 1));
+        } else if (line.compare(element, 10, "<relation ") == 0) {
+            section = 2;
+            ++relations;
+        } else if (line.compare(element, 8, "<member ") == 0) {
+            const auto ref = line.find("ref=\"") + 5;
+            EXPECT_TRUE(ways.count(line.substr(ref, line.find('"', ref) - ref))) << line;
+        }
+    }
+    EXPECT_EQ(relations, stats.relations);
+}
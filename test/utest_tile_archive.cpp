@@ -0,0 +1,125 @@
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../src/tile_archive.h"
+
+//--------------------------------//
+//   Beginning TileArchive Tests.
+//--------------------------------//
+
+class TileArchiveTest : public ::testing::Test {
+  protected:
+    void SetUp() override { std::remove(path.c_str()); }
+    void TearDown() override { std::remove(path.c_str()); }
+
+    // Tile contents that differ per key.
+    static std::vector<std::byte> Contents(const TileKey &key, std::size_t size) {
+        std::vector<std::byte> data(size);
+        for (std::size_t i = 0; i < size; ++i)
+            data[i] = static_cast<std::byte>(key.z * 31 + key.x * 7 + key.y + i);
+        return data;
+    }
+
+    static bool Add(TileArchiveWriter &writer, const TileKey &key, std::size_t size) {
+        const auto data = Contents(key, size);
+        return writer.Add(key, data.data(), data.size());
+    }
+
+    std::string path = "utest_tile_archive.pack";
+};
+
+
+// Test that finished archives return every tile, including empty ones.
+TEST_F(TileArchiveTest, TestRoundTrip) {
+    const std::vector<std::pair<TileKey, std::size_t>> tiles = {
+        {{3, 4, 2}, 100}, {{0, 0, 0}, 10}, {{3, 1, 7}, 0}, {{12, 1000, 2000}, 5000}};
+    {
+        auto writer = TileArchiveWriter::Open(path);
+        ASSERT_TRUE(writer);
+        for (const auto &[key, size] : tiles)
+            ASSERT_TRUE(Add(*writer, key, size));
+        EXPECT_EQ(writer->Size(), tiles.size());
+        ASSERT_TRUE(writer->Finish());
+        EXPECT_FALSE(Add(*writer, {1, 1, 1}, 1));
+    }
+
+    auto archive = TileArchive::Open(path);
+    ASSERT_TRUE(archive);
+    ASSERT_EQ(archive->Keys().size(), tiles.size());
+    EXPECT_TRUE(std::is_sorted(archive->Keys().begin(), archive->Keys().end()));
+    for (const auto &[key, size] : tiles) {
+        auto data = archive->Read(key);
+        ASSERT_TRUE(data);
+        EXPECT_EQ(*data, Contents(key, size));
+    }
+    EXPECT_EQ(archive->Find({3, 4, 3}), nullptr);
+    EXPECT_FALSE(archive->Read({3, 4, 3}));
+}
+
+// Test that an interrupted run resumes with its complete records and drops a torn tail.
+TEST_F(TileArchiveTest, TestResumeAfterCrash) {
+    {
+        auto writer = TileArchiveWriter::Open(path);
+        ASSERT_TRUE(writer);
+        ASSERT_TRUE(Add(*writer, {2, 1, 1}, 300));
+        ASSERT_TRUE(Add(*writer, {2, 1, 2}, 0));
+        ASSERT_TRUE(writer->Flush());
+    }
+    {
+        // Half a record header, as left by a crash mid-write.
+        std::ofstream os{path, std::ios::binary | std::ios::app};
+        os.write("\x02\x00\x00\x00\x02\x00", 6);
+    }
+    EXPECT_FALSE(TileArchive::Open(path));
+
+    auto writer = TileArchiveWriter::Open(path);
+    ASSERT_TRUE(writer);
+    EXPECT_EQ(writer->Size(), 2u);
+    EXPECT_TRUE(writer->Contains({2, 1, 1}));
+    EXPECT_TRUE(writer->Contains({2, 1, 2}));
+    EXPECT_FALSE(writer->Contains({2, 2, 1}));
+    ASSERT_TRUE(Add(*writer, {2, 2, 1}, 50));
+    ASSERT_TRUE(writer->Finish());
+
+    auto archive = TileArchive::Open(path);
+    ASSERT_TRUE(archive);
+    EXPECT_EQ(archive->Keys().size(), 3u);
+    EXPECT_EQ(*archive->Read({2, 1, 1}), Contents({2, 1, 1}, 300));
+    EXPECT_EQ(*archive->Read({2, 2, 1}), Contents({2, 2, 1}, 50));
+}
+
+// Test that a finished archive can be extended, with replaced tiles keeping the latest data.
+TEST_F(TileArchiveTest, TestExtendFinishedArchive) {
+    {
+        auto writer = TileArchiveWriter::Open(path);
+        ASSERT_TRUE(writer);
+        ASSERT_TRUE(Add(*writer, {1, 0, 0}, 20));
+        ASSERT_TRUE(writer->Finish());
+    }
+    {
+        auto writer = TileArchiveWriter::Open(path);
+        ASSERT_TRUE(writer);
+        EXPECT_TRUE(writer->Contains({1, 0, 0}));
+        ASSERT_TRUE(Add(*writer, {1, 0, 0}, 40));
+        ASSERT_TRUE(Add(*writer, {1, 1, 0}, 30));
+        ASSERT_TRUE(writer->Finish());
+    }
+    auto archive = TileArchive::Open(path);
+    ASSERT_TRUE(archive);
+    EXPECT_EQ(archive->Keys().size(), 2u);
+    EXPECT_EQ(*archive->Read({1, 0, 0}), Contents({1, 0, 0}, 40));
+}
+
+// Test that files of another format are rejected.
+TEST_F(TileArchiveTest, TestRejectsOtherFiles) {
+    {
+        std::ofstream os{path, std::ios::binary};
+        os << "not a tile archive at all";
+    }
+    EXPECT_FALSE(TileArchiveWriter::Open(path));
+    EXPECT_FALSE(TileArchive::Open(path));
+    EXPECT_FALSE(TileArchive::Open("missing_tile_archive.pack"));
+}
@@ -0,0 +1,111 @@
+/**
+ * @file route_diff.cpp
+ * @brief Command-line differential check of the accelerated planners
+ *
+ * Runs randomized queries on a map file or a synthetic map through
+ * ReferenceDijkstra and every accelerated mode (see route_verifier.h), and
+ * prints mismatches and latency ratios. Exits with status 1 on a mismatch.
+ *
+ * Usage: route_diff [-f map.osm | --synthetic-nodes N] [--queries N] [--seed SEED]
+ *                   [--reach | --no-reach]
+ *
+ * Reach preprocessing is quadratic in the number of nodes, so the reach mode
+ * runs by default only on graphs up to 20000 nodes.
+ */
+
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../src/model.h"
+#include "../src/reach.h"
+#include "../src/route_graph.h"
+#include "../src/route_verifier.h"
+#include "../src/segment_index.h"
+#include "../src/synthetic_map.h"
+
+static std::optional<std::vector<std::byte>> ReadFile(const std::string &path)
+{
+    std::ifstream is{path, std::ios::binary | std::ios::ate};
+    if( !is )
+        return std::nullopt;
+
+    auto size = is.tellg();
+    std::vector<std::byte> contents(size);
+
+    is.seekg(0);
+    is.read((char*)contents.data(), size);
+
+    if( contents.empty() )
+        return std::nullopt;
+    return std::move(contents);
+}
+
+int main(int argc, const char **argv)
+{
+    std::string osm_data_file = "../map.osm";
+    std::size_t synthetic_nodes = 0;
+    std::optional<bool> use_reach;
+    DifferentialOptions options;
+    try {
+        for( int i = 1; i < argc; ++i ) {
+            const std::string_view arg{argv[i]};
+            auto value = [&]() -> std::string {
+                if( i + 1 >= argc )
+                    throw std::invalid_argument{std::string{arg} + " needs a value"};
+                return argv[++i];
+            };
+            if( arg == "-f" )
+                osm_data_file = value();
+            else if( arg == "--synthetic-nodes" )
+                synthetic_nodes = std::stoull(value());
+            else if( arg == "--queries" )
+                options.queries = std::stoull(value());
+            else if( arg == "--seed" )
+                options.seed = std::stoull(value());
+            else if( arg == "--reach" || arg == "--no-reach" )
+                use_reach = arg == "--reach";
+            else
+                throw std::invalid_argument{"unknown option " + std::string{arg}};
+        }
+    }
+    catch( const std::exception &e ) {
+        std::cerr << "route_diff: " << e.what() << "\n"
+                  << "Usage: route_diff [-f map.osm | --synthetic-nodes N] [--queries N] [--seed SEED] [--reach | --no-reach]"
+                  << std::endl;
+        return 2;
+    }
+
+    std::vector<std::byte> osm_data;
+    if( synthetic_nodes > 0 ) {
+        SyntheticMapOptions synthetic;
+        synthetic.seed = options.seed;
+        synthetic.perturbation = 0.15;
+        synthetic.grid = SyntheticGridForNodes(synthetic, synthetic_nodes);
+        osm_data = GenerateSyntheticOsm(synthetic);
+    }
+    else if( auto data = ReadFile(osm_data_file) )
+        osm_data = std::move(*data);
+    else {
+        std::cerr << "Failed to read " << osm_data_file << std::endl;
+        return 1;
+    }
+
+    Model model{osm_data};
+    const auto graph = RouteGraph::Build(model);
+    const SegmentIndex index{graph};
+    options.index = &index;
+    std::optional<ReachBounds> reach;
+    if( use_reach.value_or(graph.NumNodes() <= 20000) ) {
+        reach = ReachBounds::Compute(graph);
+        options.reach = &*reach;
+    }
+    std::cout << graph.NumNodes() << " nodes, " << options.queries << " queries per mode" << std::endl;
+
+    const auto report = RunDifferential(graph, options);
+    report.Print(std::cout);
+    return report.Ok() ? 0 : 1;
+}
@@ -0,0 +1,245 @@
+/**
+ * @file tile_generator.cpp
+ * @brief Renders a z/x/y tile pyramid of a map into one tile archive
+ *
+ * Covers the map's features with standard Web Mercator (XYZ) tiles for a
+ * range of zoom levels, renders them with Render on worker threads,
+ * compresses them on an AsyncPngWriter and stores the PNGs in a tile
+ * archive (see tile_archive.h). Tiles without
+ * features are recorded as empty instead of rendered. Running again on the
+ * same archive skips the tiles it already holds, so an interrupted run
+ * resumes where it stopped.
+ *
+ * Usage: tile_generator [-f map.osm] -o tiles.pack [--zoom MIN MAX] [--threads N] [--compression 0-9]
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include <io2d.h>
+#include "../src/feature_index.h"
+#include "../src/png_writer.h"
+#include "../src/render.h"
+#include "../src/route_model.h"
+#include "../src/tile_archive.h"
+#include "../src/viewport.h"
+
+using namespace std::experimental;
+
+static std::optional<std::vector<std::byte>> ReadFile(const std::string &path)
+{
+    std::ifstream is{path, std::ios::binary | std::ios::ate};
+    if( !is )
+        return std::nullopt;
+
+    auto size = is.tellg();
+    std::vector<std::byte> contents(size);
+
+    is.seekg(0);
+    is.read((char*)contents.data(), size);
+
+    if( contents.empty() )
+        return std::nullopt;
+    return std::move(contents);
+}
+
+/**
+ * @class TileGrid
+ * @brief Maps XYZ tiles onto the model's normalized coordinates
+ *
+ * Model coordinates are linear in Web Mercator, so the mapping is fixed by
+ * the longitudes and latitudes of model coordinates 0 and 1.
+ */
+class TileGrid {
+  public:
+    TileGrid(const Model &model, int tile_size) : m_TileSize(tile_size) {
+        m_X0 = WorldX(model.Longitude(0.));
+        m_XScale = WorldX(model.Longitude(1.)) - m_X0;
+        m_Y0 = WorldY(model.Latitude(0.));
+        m_YScale = WorldY(model.Latitude(1.)) - m_Y0;
+    }
+
+    /**
+     * @brief Returns the viewport that renders a tile
+     */
+    Viewport TileViewport(const TileKey &key) const {
+        const double tiles = std::ldexp(1., key.z);
+        Viewport viewport;
+        viewport.width = viewport.height = m_TileSize;
+        viewport.zoom = tiles * m_XScale;
+        viewport.center_x = ((key.x + .5) / tiles - m_X0) / m_XScale;
+        viewport.center_y = ((key.y + .5) / tiles - m_Y0) / m_YScale;
+        return viewport;
+    }
+
+    /**
+     * @brief Returns the tile columns and rows covering a box of model coordinates
+     * @return {min x, min y, max x, max y}, inclusive
+     */
+    std::array<std::uint32_t, 4> TileRange(const BoundingBox &box, std::uint32_t z) const {
+        const double tiles = std::ldexp(1., z);
+        auto column = [&](double x) { return Clamp((m_X0 + x * m_XScale) * tiles, tiles); };
+        auto row = [&](double y) { return Clamp((m_Y0 + y * m_YScale) * tiles, tiles); };
+        return {column(box.min_x), row(box.max_y), column(box.max_x), row(box.min_y)};
+    }
+
+  private:
+    static double WorldX(double longitude) { return (longitude + 180.) / 360.; }
+    static double WorldY(double latitude) {
+        const double pi = 3.14159265358979323846;
+        const double phi = latitude * pi / 180.;
+        return (1. - std::log(std::tan(phi) + 1. / std::cos(phi)) / pi) / 2.;
+    }
+    static std::uint32_t Clamp(double tile, double tiles) {
+        return static_cast<std::uint32_t>(std::clamp(std::floor(tile), 0., tiles - 1.));
+    }
+
+    int m_TileSize;
+    double m_X0, m_XScale;  ///< World x of model x 0, and per model unit
+    double m_Y0, m_YScale;  ///< World y of model y 0, and per model unit (negative)
+};
+
+int main(int argc, const char **argv)
+{
+    std::string osm_data_file = "../map.osm";
+    std::string archive_file;
+    std::uint32_t min_zoom = 12, max_zoom = 16;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    int compression = 6;
+    try {
+        for( int i = 1; i < argc; ++i ) {
+            const std::string_view arg{argv[i]};
+            auto value = [&]() -> std::string {
+                if( i + 1 >= argc )
+                    throw std::invalid_argument{std::string{arg} + " needs a value"};
+                return argv[++i];
+            };
+            if( arg == "-f" )
+                osm_data_file = value();
+            else if( arg == "-o" )
+                archive_file = value();
+            else if( arg == "--zoom" ) {
+                min_zoom = std::stoul(value());
+                max_zoom = std::stoul(value());
+            }
+            else if( arg == "--threads" )
+                threads = std::max(1ul, std::stoul(value()));
+            else if( arg == "--compression" )
+                compression = std::stoi(value());
+            else
+                throw std::invalid_argument{"unknown option " + std::string{arg}};
+        }
+        if( archive_file.empty() )
+            throw std::invalid_argument{"missing -o"};
+        if( min_zoom > max_zoom || max_zoom > 24 )
+            throw std::invalid_argument{"zoom range must satisfy MIN <= MAX <= 24"};
+        if( compression < 0 || compression > 9 )
+            throw std::invalid_argument{"compression must be between 0 and 9"};
+    }
+    catch( const std::exception &e ) {
+        std::cerr << "tile_generator: " << e.what() << "\n"
+                  << "Usage: tile_generator [-f map.osm] -o tiles.pack [--zoom MIN MAX] [--threads N] [--compression 0-9]" << std::endl;
+        return 2;
+    }
+
+    auto osm_data = ReadFile(osm_data_file);
+    if( !osm_data ) {
+        std::cerr << "Failed to read " << osm_data_file << std::endl;
+        return 1;
+    }
+    auto writer = TileArchiveWriter::Open(archive_file);
+    if( !writer ) {
+        std::cerr << "Failed to open " << archive_file << " as a tile archive" << std::endl;
+        return 1;
+    }
+
+    constexpr int kTileSize = 256;
+    RouteModel model{*osm_data};
+    const Render render{model};
+    const TileGrid grid{model, kTileSize};
+    const auto extent = FeatureIndex{model}.Extent();
+
+    std::vector<TileKey> jobs;
+    std::size_t total = 0;
+    for( auto z = min_zoom; z <= max_zoom; ++z ) {
+        const auto [x0, y0, x1, y1] = grid.TileRange(extent, z);
+        for( auto y = y0; y <= y1; ++y )
+            for( auto x = x0; x <= x1; ++x, ++total )
+                if( !writer->Contains({z, x, y}) )
+                    jobs.push_back({z, x, y});
+    }
+    std::cout << total << " tiles in zoom " << min_zoom << "-" << max_zoom << ", " << total - jobs.size()
+              << " already in " << archive_file << std::endl;
+
+    // Render workers hand finished tiles to the encoder threads and move on; a full queue holds them back.
+    AsyncPngWriter encoder{threads, 2 * std::size_t{threads}, compression};
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::mutex writer_mutex;
+    std::size_t done = 0, empty = 0;
+    auto store = [&](const TileKey &key, const std::uint8_t *data, std::size_t size) {
+        std::lock_guard lock{writer_mutex};
+        if( failed || !writer->Add(key, data, size) ) {
+            failed = true;
+            return false;
+        }
+        empty += size == 0;
+        if( ++done % 1024 == 0 ) {
+            writer->Flush();
+            std::cout << done << "/" << jobs.size() << " tiles" << std::endl;
+        }
+        return true;
+    };
+    auto work = [&] {
+        for( std::size_t j; !failed && (j = next++) < jobs.size(); ) {
+            const auto key = jobs[j];
+            const auto viewport = grid.TileViewport(key);
+            if( render.IsEmpty(viewport) ) {
+                store(key, nullptr, 0);
+                continue;
+            }
+            io2d::image_surface surface{io2d::format::argb32, kTileSize, kTileSize};
+            render.DisplayUncached(surface, viewport);
+            encoder.Submit(Render::ReadPixels(surface), [&store, key](std::vector<std::uint8_t> &&png) {
+                return store(key, png.data(), png.size());
+            });
+        }
+    };
+    // If a thread can't be started, the tiles are shared among those that could;
+    // the started workers must be joined either way.
+    const auto render_threads = std::min<std::size_t>(threads, std::max<std::size_t>(jobs.size(), 1));
+    std::vector<std::thread> workers;
+    workers.reserve(render_threads);
+    for( std::size_t i = 1; i < render_threads; ++i ) {
+        try {
+            workers.emplace_back(work);
+        }
+        catch( const std::system_error & ) {
+            break;
+        }
+    }
+    work();
+    for( auto &worker: workers )
+        worker.join();
+    encoder.Close();
+
+    if( failed || encoder.Failed() || !writer->Finish() ) {
+        std::cerr << "Failed to write " << archive_file << "; run again to resume" << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << done << " tiles (" << empty << " empty) to " << archive_file << ", "
+              << writer->Size() << " in total" << std::endl;
+    return 0;
+}